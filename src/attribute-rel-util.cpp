@@ -32,8 +32,6 @@
 #include "attribute-rel-util.h"
 
 using Inkscape::XML::Node;
-using Inkscape::XML::AttributeRecord;
-using Inkscape::Util::List;
 
 /**
  * Get preferences
@@ -114,13 +112,11 @@ void sp_attribute_clean_element(Node *repr, unsigned int flags) {
   sp_attribute_clean_style(repr, flags );
 
   // Clean attributes
-  List<AttributeRecord const> attributes = repr->attributeList();
-
   std::set<Glib::ustring> attributesToDelete;
-  for ( List<AttributeRecord const> iter = attributes ; iter ; ++iter ) {
+  for ( auto const &attr : repr->attributes() ) {
 
-    Glib::ustring attribute = g_quark_to_string(iter->key);
-    //Glib::ustring value = (const char*)iter->value;
+    Glib::ustring attribute = g_quark_to_string(attr.key);
+    //Glib::ustring value = (const char*)attr.value;
 
     bool is_useful = sp_attribute_check_attribute( element, id, attribute, flags & SP_ATTR_CLEAN_ATTR_WARN );
     if( !is_useful && (flags & SP_ATTR_CLEAN_ATTR_REMOVE) ) {
@@ -128,7 +124,7 @@ void sp_attribute_clean_element(Node *repr, unsigned int flags) {
     }
   }
 
-  // Do actual deleting (done after so as not to perturb List iterator).
+  // Do actual deleting (done after so as not to invalidate the attribute range).
   for(const auto & iter_d : attributesToDelete) {
     repr->setAttribute( iter_d.c_str(), nullptr, false );
   }
@@ -205,10 +201,10 @@ void sp_attribute_clean_style(Node* repr, SPCSSAttr *css, unsigned int flags) {
 
   // Loop over all properties in "style" node, keeping track of which to delete.
   std::set<Glib::ustring> toDelete;
-  for ( List<AttributeRecord const> iter = css->attributeList() ; iter ; ++iter ) {
+  for ( auto const &attr : css->attributes() ) {
 
-    gchar const * property = g_quark_to_string(iter->key);
-    gchar const * value = iter->value;
+    gchar const * property = g_quark_to_string(attr.key);
+    gchar const * value = attr.value;
 
     // Check if a property is applicable to an element (i.e. is font-family useful for a <rect>?).
     if( !SPAttributeRelCSS::findIfValid( property, element ) ) {
@@ -225,12 +221,12 @@ void sp_attribute_clean_style(Node* repr, SPCSSAttr *css, unsigned int flags) {
     // Find parent value for same property (property)
     gchar const * value_p = nullptr;
     if( css_parent != nullptr ) {
-        for ( List<AttributeRecord const> iter_p = css_parent->attributeList() ; iter_p ; ++iter_p ) {
+        for ( auto const &attr_p : css_parent->attributes() ) {
 
-            gchar const * property_p = g_quark_to_string(iter_p->key);
+            gchar const * property_p = g_quark_to_string(attr_p.key);
 
             if( !g_strcmp0( property, property_p ) ) {
-                value_p = iter_p->value;
+                value_p = attr_p.value;
                 break;
             }
         }
@@ -266,7 +262,7 @@ void sp_attribute_clean_style(Node* repr, SPCSSAttr *css, unsigned int flags) {
 
   } // End loop over style properties
 
-  // Delete unneeded style properties. Do this at the end so as to not perturb List iterator.
+  // Delete unneeded style properties. Do this at the end so as to not invalidate the property range.
   for(const auto & iter_d : toDelete) {
     sp_repr_css_set_property( css, iter_d.c_str(), nullptr );
   }
@@ -282,10 +278,10 @@ void sp_attribute_purge_default_style(SPCSSAttr *css, unsigned int flags) {
 
   // Loop over all properties in "style" node, keeping track of which to delete.
   std::set<Glib::ustring> toDelete;
-  for ( List<AttributeRecord const> iter = css->attributeList() ; iter ; ++iter ) {
+  for ( auto const &attr : css->attributes() ) {
 
-    gchar const * property = g_quark_to_string(iter->key);
-    gchar const * value = iter->value;
+    gchar const * property = g_quark_to_string(attr.key);
+    gchar const * value = attr.value;
 
     // If property value is same as default mark for deletion.
     if ( SPAttributeRelCSS::findIfDefault( property, value ) ) {
@@ -302,7 +298,7 @@ void sp_attribute_purge_default_style(SPCSSAttr *css, unsigned int flags) {
 
   } // End loop over style properties
 
-  // Delete unneeded style properties. Do this at the end so as to not perturb List iterator.
+  // Delete unneeded style properties. Do this at the end so as to not invalidate the property range.
   for(const auto & iter_d : toDelete) {
     sp_repr_css_set_property( css, iter_d.c_str(), nullptr );
   }
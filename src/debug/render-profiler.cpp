@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::RenderProfiler - timing of drawing item and filter rendering
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "debug/render-profiler.h"
+
+namespace Inkscape {
+
+namespace Debug {
+
+namespace {
+
+struct Record {
+    char const *category;
+    void const *key;
+    std::string name;
+    int thread;
+    int64_t start;    ///< nanoseconds
+    int64_t duration; ///< nanoseconds
+    int64_t self;     ///< duration without nested scopes
+    uint64_t pixels;
+    RenderProfiler::CacheUse cache;
+};
+
+/// Stop recording after this many renderings, to bound memory use.
+size_t const MAX_RECORDS = 4000000;
+
+std::mutex records_mutex;
+std::vector<Record> records;
+size_t dropped = 0;
+std::string trace_filename;
+
+thread_local RenderProfiler::Scope *current_scope = nullptr;
+
+int64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int thread_number()
+{
+    static std::atomic<int> next(1);
+    thread_local int number = next++;
+    return number;
+}
+
+char const *cache_name(RenderProfiler::CacheUse cache)
+{
+    switch (cache) {
+        case RenderProfiler::CACHE_HIT:
+            return "hit";
+        case RenderProfiler::CACHE_PARTIAL:
+            return "partial";
+        case RenderProfiler::CACHE_MISS:
+            return "miss";
+        default:
+            return "none";
+    }
+}
+
+void write_json_string(std::ostream &os, std::string const &s)
+{
+    os << '"';
+    for (char c : s) {
+        switch (c) {
+            case '"':
+                os << "\\\"";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    os << escaped;
+                } else {
+                    os << c;
+                }
+        }
+    }
+    os << '"';
+}
+
+}
+
+bool RenderProfiler::_enabled = RenderProfiler::_init();
+
+bool RenderProfiler::_init()
+{
+    char const *filename = std::getenv("INKSCAPE_RENDER_PROFILE");
+    if (!filename || !*filename) {
+        return false;
+    }
+    trace_filename = filename;
+    std::atexit(&RenderProfiler::_shutdown);
+    return true;
+}
+
+void RenderProfiler::_shutdown()
+{
+    std::ofstream trace(trace_filename.c_str());
+    if (trace.is_open()) {
+        writeTrace(trace);
+    } else {
+        std::cerr << "Cannot write render profile to " << trace_filename << std::endl;
+    }
+    writeSummary(std::cerr, 20);
+}
+
+RenderProfiler::Scope::Scope(char const *category, void const *key)
+    : _active(_enabled)
+    , _category(category)
+    , _key(key)
+    , _pixels(0)
+    , _cache(CACHE_NONE)
+    , _start(0)
+    , _children(0)
+    , _parent(nullptr)
+{
+    if (!_active) return;
+    _parent = current_scope;
+    current_scope = this;
+    _start = now();
+}
+
+RenderProfiler::Scope::~Scope()
+{
+    if (!_active) return;
+    int64_t duration = now() - _start;
+    if (_parent) {
+        _parent->_children += duration;
+    }
+    current_scope = _parent;
+
+    Record record = { _category, _key, _name, thread_number(), _start, duration,
+                      duration - _children, _pixels, _cache };
+    std::lock_guard<std::mutex> lock(records_mutex);
+    if (records.size() < MAX_RECORDS) {
+        records.push_back(std::move(record));
+    } else {
+        ++dropped;
+    }
+}
+
+/// Write the recorded renderings as Chrome trace events.
+void RenderProfiler::writeTrace(std::ostream &os)
+{
+    std::lock_guard<std::mutex> lock(records_mutex);
+
+    int64_t origin = 0;
+    if (!records.empty()) {
+        origin = std::min_element(records.begin(), records.end(), [](Record const &a, Record const &b) {
+            return a.start < b.start;
+        })->start;
+    }
+
+    os << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (auto const &record : records) {
+        if (!first) {
+            os << ",\n";
+        }
+        first = false;
+        os << "{\"name\":";
+        write_json_string(os, record.name.empty() ? std::string(record.category) : record.name);
+        os << ",\"cat\":\"" << record.category << "\",\"ph\":\"X\",\"pid\":1"
+           << ",\"tid\":" << record.thread << std::fixed << std::setprecision(3)
+           << ",\"ts\":" << (record.start - origin) / 1000.0
+           << ",\"dur\":" << record.duration / 1000.0
+           << ",\"args\":{\"pixels\":" << record.pixels
+           << ",\"cache\":\"" << cache_name(record.cache) << "\""
+           << ",\"self_us\":" << record.self / 1000.0 << "}}";
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+/// Print the items and filter primitives with the highest total self time.
+void RenderProfiler::writeSummary(std::ostream &os, unsigned count)
+{
+    struct Total {
+        char const *category;
+        std::string name;
+        unsigned renders;
+        int64_t self;
+        int64_t duration;
+        uint64_t pixels;
+        unsigned hits;
+        unsigned misses;
+    };
+
+    std::map<std::pair<void const *, std::string>, Total> totals;
+    size_t recorded;
+    {
+        std::lock_guard<std::mutex> lock(records_mutex);
+        recorded = records.size();
+        for (auto const &record : records) {
+            auto key = std::make_pair(record.key, std::string(record.category));
+            auto inserted = totals.insert(std::make_pair(key, Total{record.category, record.name, 0, 0, 0, 0, 0, 0}));
+            Total &total = inserted.first->second;
+            total.renders++;
+            total.self += record.self;
+            total.duration += record.duration;
+            total.pixels += record.pixels;
+            if (record.cache == CACHE_HIT) total.hits++;
+            if (record.cache == CACHE_MISS || record.cache == CACHE_PARTIAL) total.misses++;
+        }
+    }
+
+    std::vector<Total> sorted;
+    sorted.reserve(totals.size());
+    for (auto const &total : totals) {
+        sorted.push_back(total.second);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](Total const &a, Total const &b) {
+        return a.self > b.self;
+    });
+    if (sorted.size() > count) {
+        sorted.resize(count);
+    }
+
+    os << "Slowest renderings (" << recorded << " recorded";
+    if (dropped) {
+        os << ", " << dropped << " dropped";
+    }
+    os << "):\n";
+    os << std::setw(12) << "self ms" << std::setw(12) << "total ms" << std::setw(9) << "renders"
+       << std::setw(14) << "pixels" << std::setw(11) << "hit/miss" << "  item\n";
+    for (auto const &total : sorted) {
+        os << std::fixed << std::setprecision(2)
+           << std::setw(12) << total.self / 1e6 << std::setw(12) << total.duration / 1e6
+           << std::setw(9) << total.renders << std::setw(14) << total.pixels
+           << std::setw(5) << total.hits << "/" << std::left << std::setw(5) << total.misses << std::right
+           << "  " << total.category << ": " << (total.name.empty() ? "(unnamed)" : total.name) << "\n";
+    }
+    os.flush();
+}
+
+/// Discard all recorded renderings.
+void RenderProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(records_mutex);
+    records.clear();
+    dropped = 0;
+}
+
+}
+
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Inkscape::Debug::RenderProfiler - timing of drawing item and filter rendering
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DEBUG_RENDER_PROFILER_H
+#define SEEN_INKSCAPE_DEBUG_RENDER_PROFILER_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace Inkscape {
+
+namespace Debug {
+
+/**
+ * Records how long the rendering of each drawing item and filter primitive takes.
+ *
+ * Profiling is enabled by setting INKSCAPE_RENDER_PROFILE to a file name. At exit,
+ * the recorded renderings are written there in the Chrome trace event format (load
+ * it in chrome://tracing or Perfetto), and a summary of the items with the highest
+ * self time is printed to stderr.
+ */
+class RenderProfiler {
+public:
+    /// Cache usage of a rendering.
+    enum CacheUse {
+        CACHE_NONE,
+        CACHE_HIT,
+        CACHE_PARTIAL,
+        CACHE_MISS
+    };
+
+    /**
+     * Measures the rendering that takes place during its lifetime.
+     * Does nothing unless profiling is enabled; check active() before computing
+     * anything that is only needed for the profile.
+     */
+    class Scope {
+    public:
+        Scope(char const *category, void const *key);
+        ~Scope();
+
+        bool active() const { return _active; }
+        void setName(std::string const &name) { _name = name; }
+        void setPixels(uint64_t pixels) { _pixels = pixels; }
+        void setCache(CacheUse cache) { _cache = cache; }
+
+    private:
+        Scope(Scope const &) = delete;
+        void operator=(Scope const &) = delete;
+
+        bool _active;
+        char const *_category;
+        void const *_key;
+        std::string _name;
+        uint64_t _pixels;
+        CacheUse _cache;
+        int64_t _start;
+        int64_t _children; ///< time spent in nested scopes
+        Scope *_parent;
+    };
+
+    static bool enabled() { return _enabled; }
+
+    static void writeTrace(std::ostream &os);
+    static void writeSummary(std::ostream &os, unsigned count);
+    static void clear();
+
+private:
+    static bool _init();
+    static void _shutdown();
+
+    static bool _enabled;
+};
+
+}
+
+}
+
+#endif
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -26,11 +26,15 @@
 static const int OPENMP_THRESHOLD = 2048;
 #endif
 
+// rows synthesized between two checkpoints of a background rendering job
+static const int SYNTHESIZE_CHECKPOINT_ROWS = 32;
+
 #include <algorithm>
 #include <cairo.h>
 #include <cmath>
 #include "display/nr-3dutils.h"
 #include "display/cairo-utils.h"
+#include "display/drawing-render-thread.h"
 
 /**
  * Blend two surfaces using the supplied functor.
@@ -330,35 +334,47 @@ void ink_cairo_surface_synthesize(cairo_surface_t *out, cairo_rectangle_t const
 
     unsigned char *out_data = cairo_image_surface_get_data(out);
 
+    // Synthesizing is expensive; in a background rendering job, produce the rows in blocks
+    // and let the main thread take over the drawing between them.
+    int block = Inkscape::DrawingRenderThread::current() ? SYNTHESIZE_CHECKPOINT_ROWS : h;
+
     #if HAVE_OPENMP
-    int limit = w * h;
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
     int numOfThreads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
     if (numOfThreads){} // inform compiler we are using it.
     #endif
 
-    if (bppout == 4) {
+    for (int start = out_area.y; start < h; start += block) {
+        Inkscape::DrawingRenderThread::checkpoint();
+        int end = std::min(start + block, h);
+
         #if HAVE_OPENMP
-        #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
+        int limit = w * (end - start);
         #endif
-        for (int i = out_area.y; i < h; ++i) {
-            guint32 *out_p = reinterpret_cast<guint32*>(out_data + i * strideout);
-            for (int j = out_area.x; j < w; ++j) {
-                *out_p = synth(j, i);
-                ++out_p;
+
+        if (bppout == 4) {
+            #if HAVE_OPENMP
+            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
+            #endif
+            for (int i = start; i < end; ++i) {
+                guint32 *out_p = reinterpret_cast<guint32*>(out_data + i * strideout);
+                for (int j = out_area.x; j < w; ++j) {
+                    *out_p = synth(j, i);
+                    ++out_p;
+                }
             }
-        }
-    } else {
-        // bppout == 1
-        #if HAVE_OPENMP
-        #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
-        #endif
-        for (int i = out_area.y; i < h; ++i) {
-            guint8 *out_p = out_data + i * strideout;
-            for (int j = out_area.x; j < w; ++j) {
-                guint32 out_px = synth(j, i);
-                *out_p = out_px >> 24;
-                ++out_p;
+        } else {
+            // bppout == 1
+            #if HAVE_OPENMP
+            #pragma omp parallel for if(limit > OPENMP_THRESHOLD) num_threads(numOfThreads)
+            #endif
+            for (int i = start; i < end; ++i) {
+                guint8 *out_p = out_data + i * strideout;
+                for (int j = out_area.x; j < w; ++j) {
+                    guint32 out_px = synth(j, i);
+                    *out_p = out_px >> 24;
+                    ++out_p;
+                }
             }
         }
     }
@@ -70,6 +70,25 @@ private:
     bool saved;
 };
 
+/**
+ * RAII idiom for surface references.
+ * Releases the reference at the end of the scope, also when a rendering job is cancelled
+ * while the surface is being filled.
+ */
+class CairoSurfaceRelease {
+public:
+    explicit CairoSurfaceRelease(cairo_surface_t *_surface)
+        : surface(_surface)
+    {}
+    CairoSurfaceRelease(CairoSurfaceRelease const &) = delete;
+    CairoSurfaceRelease &operator=(CairoSurfaceRelease const &) = delete;
+    ~CairoSurfaceRelease() {
+        cairo_surface_destroy(surface);
+    }
+private:
+    cairo_surface_t *surface;
+};
+
 /** Cairo context with Inkscape-specific operations. */
 class CairoContext : public Cairo::Context {
 public:
@@ -14,6 +14,7 @@
 
 #include <gtkmm.h>
 
+#include "debug/render-profiler.h"
 #include "display/sp-canvas-util.h"
 #include "helper/sp-marshal.h"
 #include "display/canvas-arena.h"
@@ -21,7 +22,10 @@
 #include "display/drawing-context.h"
 #include "display/drawing-item.h"
 #include "display/drawing-group.h"
+#include "display/drawing-render-thread.h"
 #include "display/drawing-surface.h"
+#include "display/drawing-tile-cache.h"
+#include "display/nr-filter-result-cache.h"
 #include "preferences.h"
 
 using namespace Inkscape;
@@ -36,6 +40,7 @@ static void sp_canvas_arena_destroy(SPCanvasItem *object);
 static void sp_canvas_arena_item_deleted(SPCanvasArena *arena, Inkscape::DrawingItem *item);
 static void sp_canvas_arena_update (SPCanvasItem *item, Geom::Affine const &affine, unsigned int flags);
 static void sp_canvas_arena_render (SPCanvasItem *item, SPCanvasBuf *buf);
+static bool sp_canvas_arena_prepare (SPCanvasItem *item, SPCanvasBuf *buf);
 static double sp_canvas_arena_point (SPCanvasItem *item, Geom::Point p, SPCanvasItem **actual_item);
 static void sp_canvas_arena_viewbox_changed (SPCanvasItem *item, Geom::IntRect const &new_area);
 static gint sp_canvas_arena_event (SPCanvasItem *item, GdkEvent *event);
@@ -44,6 +49,7 @@ static gint sp_canvas_arena_send_event (SPCanvasArena *arena, GdkEvent *event);
 
 static void sp_canvas_arena_request_update (SPCanvasArena *ca, DrawingItem *item);
 static void sp_canvas_arena_request_render (SPCanvasArena *ca, Geom::IntRect const &area);
+static void sp_canvas_arena_render_finished (SPCanvasArena *ca);
 
 static guint signals[LAST_SIGNAL] = {0};
 
@@ -63,6 +69,10 @@ struct CachePrefObserver : public Inkscape::Preferences::Observer {
         Glib::ustring name = v.getEntryName();
         if (name == "size") {
             _arena->drawing.setCacheBudget((1 << 20) * v.getIntLimited(64, 0, 4096));
+        } else if (name == "tiles") {
+            _arena->tiles->setBudget((size_t(1) << 20) * v.getIntLimited(0, 0, 16384));
+        } else if (name == "filters") {
+            Inkscape::Filters::FilterResultCache::get().setBudget((size_t(1) << 20) * v.getIntLimited(0, 0, 4096));
         }
     }
     SPCanvasArena *_arena;
@@ -86,6 +96,7 @@ sp_canvas_arena_class_init (SPCanvasArenaClass *klass)
     item_class->destroy = sp_canvas_arena_destroy;
     item_class->update = sp_canvas_arena_update;
     item_class->render = sp_canvas_arena_render;
+    item_class->prepare = sp_canvas_arena_prepare;
     item_class->point = sp_canvas_arena_point;
     item_class->event = sp_canvas_arena_event;
     item_class->viewbox_changed = sp_canvas_arena_viewbox_changed;
@@ -102,6 +113,9 @@ sp_canvas_arena_init (SPCanvasArena *arena)
     root->setPickChildren(true);
     arena->drawing.setRoot(root);
 
+    arena->tiles = new DrawingTileCache();
+    arena->render_thread = nullptr; // created on first use
+    arena->render_tiles = false;
     arena->observer = new CachePrefObserver(arena);
 
     arena->drawing.signal_request_update.connect(
@@ -125,6 +139,9 @@ static void sp_canvas_arena_destroy(SPCanvasItem *object)
     SPCanvasArena *arena = SP_CANVAS_ARENA(object);
 
     delete arena->observer;
+    // stop the background rendering before the drawing goes away
+    delete arena->render_thread;
+    delete arena->tiles;
     arena->drawing.~Drawing();
 
     if (SP_CANVAS_ITEM_CLASS(sp_canvas_arena_parent_class)->destroy)
@@ -185,6 +202,37 @@ sp_canvas_arena_item_deleted(SPCanvasArena *arena, Inkscape::DrawingItem *item)
     }
 }
 
+/// Select the tile cache level corresponding to the current rendering settings.
+static void
+sp_canvas_arena_set_tile_level (SPCanvasArena *arena, SPCanvasBuf *buf)
+{
+    arena->drawing.loadQualityPreferences();
+    DrawingTileCache::Settings settings = {
+        arena->drawing.renderMode(),
+        arena->drawing.filterQuality(),
+        arena->drawing.blurQuality(),
+        buf->device_scale
+    };
+    arena->tiles->setLevel(arena->ctx.ctm, settings, arena->drawing.revision());
+}
+
+/// Return the last background rendering if it is up to date and covers the buffer.
+static DrawingSurface *
+sp_canvas_arena_background_result (SPCanvasArena *arena, SPCanvasBuf *buf)
+{
+    DrawingRenderThread *thread = arena->render_thread;
+    if (!thread || thread->busy()) return nullptr;
+
+    DrawingSurface *result = thread->result();
+    if (!result || thread->resultGeneration() != arena->drawing.generation() ||
+        thread->resultPreview() != buf->preview || result->device_scale() != buf->device_scale ||
+        !result->area().roundOutwards().contains(buf->rect))
+    {
+        return nullptr;
+    }
+    return result;
+}
+
 static void
 sp_canvas_arena_render (SPCanvasItem *item, SPCanvasBuf *buf)
 {
@@ -196,8 +244,111 @@ sp_canvas_arena_render (SPCanvasItem *item, SPCanvasBuf *buf)
 
     Inkscape::DrawingContext dc(buf->ct, r->min());
 
+    Inkscape::Debug::RenderProfiler::Scope profile("canvas", arena);
+    if (profile.active()) {
+        profile.setName("canvas buffer");
+        profile.setPixels(uint64_t(r->width()) * r->height());
+    }
+
+    Drawing::PreviewScope preview(arena->drawing, buf->preview);
+    arena->drawing.update(Geom::IntRect::infinite(), arena->ctx);
+
+    // The grayscale filter is applied to the whole buffer, including the background,
+    // so its result cannot be stored in tiles.
+    DrawingTileCache *tiles = arena->tiles;
+    bool use_tiles = tiles->enabled() && arena->drawing.colorMode() == COLORMODE_NORMAL;
+    if (use_tiles) {
+        sp_canvas_arena_set_tile_level(arena, buf);
+        if (tiles->paint(dc, *r)) {
+            profile.setCache(Inkscape::Debug::RenderProfiler::CACHE_HIT);
+            return;
+        }
+    }
+
+    if (DrawingSurface *result = sp_canvas_arena_background_result(arena, buf)) {
+        dc.rectangle(*r);
+        dc.setSource(result);
+        dc.fill();
+        dc.setSource(0, 0, 0, 0);
+        return;
+    }
+
+    if (use_tiles && tiles->settled()) {
+        // render whole tiles, so that they can be reused after zooming back to this level
+        Geom::IntRect area = DrawingTileCache::tileBounds(*r);
+        DrawingSurface rendering(area, buf->device_scale);
+        {
+            DrawingContext rdc(rendering);
+            arena->drawing.renderThreaded(rdc, area, buf->render_threads);
+        }
+        tiles->store(rendering);
+
+        dc.rectangle(*r);
+        dc.setSource(&rendering);
+        dc.fill();
+        dc.setSource(0, 0, 0, 0);
+        return;
+    }
+
+    arena->drawing.renderThreaded(dc, *r, buf->render_threads);
+}
+
+/**
+ * Start rendering the buffer area in the background, unless it can already be painted.
+ * The canvas is notified by sp_canvas_arena_render_finished() when the rendering ends.
+ */
+static bool
+sp_canvas_arena_prepare (SPCanvasItem *item, SPCanvasBuf *buf)
+{
+    SPCanvasArena *arena = SP_CANVAS_ARENA (item);
+
+    Geom::OptIntRect r = buf->rect;
+    if (!r || r->hasZeroArea()) return true;
+
+    // outline rendering is fast, and modifies the drawing while rendering clips and masks;
+    // the grayscale filter must be applied to the background of the buffer too
+    if (arena->drawing.outline() || arena->drawing.colorMode() != COLORMODE_NORMAL) return true;
+
+    if (!arena->render_thread) {
+        arena->render_thread = new DrawingRenderThread(arena->drawing);
+        arena->render_thread->signal_finished.connect(
+            sigc::bind<0>(
+                sigc::ptr_fun(&sp_canvas_arena_render_finished),
+                arena));
+    }
+    if (arena->render_thread->busy()) return false;
+
+    Drawing::PreviewScope preview(arena->drawing, buf->preview);
     arena->drawing.update(Geom::IntRect::infinite(), arena->ctx);
-    arena->drawing.render(dc, *r);
+
+    if (sp_canvas_arena_background_result(arena, buf)) return true;
+
+    Geom::IntRect area = *r;
+    DrawingTileCache *tiles = arena->tiles;
+    arena->render_tiles = false;
+    if (tiles->enabled() && arena->drawing.colorMode() == COLORMODE_NORMAL) {
+        sp_canvas_arena_set_tile_level(arena, buf);
+        if (tiles->contains(area)) return true;
+        if (tiles->settled()) {
+            area = DrawingTileCache::tileBounds(area);
+            arena->render_tiles = true;
+        }
+    }
+
+    arena->render_thread->start(area, buf->device_scale, buf->render_threads, buf->preview);
+    return false;
+}
+
+static void
+sp_canvas_arena_render_finished (SPCanvasArena *arena)
+{
+    DrawingRenderThread *thread = arena->render_thread;
+    DrawingSurface *result = thread->result();
+
+    if (result && arena->render_tiles && thread->resultGeneration() == arena->drawing.generation()) {
+        arena->tiles->store(*result);
+    }
+    arena->item.canvas->backgroundRenderFinished(result != nullptr);
 }
 
 static double
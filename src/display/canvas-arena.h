@@ -36,6 +36,8 @@ namespace Inkscape {
 
 class Drawing;
 class DrawingItem;
+class DrawingRenderThread;
+class DrawingTileCache;
 
 } // namespace Inkscape
 
@@ -53,6 +55,9 @@ struct _SPCanvasArena {
     /* fixme: */
     Inkscape::DrawingItem *picked;
     CachePrefObserver *observer;
+    Inkscape::DrawingTileCache *tiles;
+    Inkscape::DrawingRenderThread *render_thread; ///< renders in the background, see sp_canvas_arena_prepare()
+    bool render_tiles; ///< whether the background rendering is meant for the tile cache
     double delta;
 };
 
@@ -14,6 +14,7 @@
 #include "display/cairo-utils.h"
 #include "display/drawing-context.h"
 #include "display/drawing-item.h"
+#include "display/drawing-item-index.h"
 #include "display/drawing-surface.h"
 #include "display/drawing-text.h"
 #include "display/drawing.h"
@@ -21,14 +22,20 @@
 
 namespace Inkscape {
 
+/// Groups with at least this many children keep a spatial index of them.
+static unsigned const INDEX_MIN_CHILDREN = 64;
+
 DrawingGroup::DrawingGroup(Drawing &drawing)
     : DrawingItem(drawing)
     , _child_transform(nullptr)
+    , _index(nullptr)
+    , _reindex(true)
 {}
 
 DrawingGroup::~DrawingGroup()
 {
     delete _child_transform; // delete NULL; is safe
+    delete _index;
 }
 
 /**
@@ -88,13 +95,72 @@ DrawingGroup::_updateItem(Geom::IntRect const &area, UpdateContext const &ctx, u
             }
         }
     }
+    _updateIndex();
     return beststate;
 }
 
+/**
+ * Bring the spatial index of the children up to date after they have been updated.
+ * Children are indexed by the union of the boxes that render() and pick() test,
+ * so that the index never misses a child either of them would accept.
+ */
+void
+DrawingGroup::_updateIndex()
+{
+    if (_children.size() < INDEX_MIN_CHILDREN) {
+        delete _index;
+        _index = nullptr;
+        _reindex = true;
+        return;
+    }
+    if (!_index) {
+        _index = new DrawingItemIndex();
+    }
+
+    unsigned order = 0;
+    if (_reindex) {
+        _index->clear();
+    }
+    for (auto & i : _children) {
+        Geom::OptIntRect bounds = i.geometricBounds();
+        bounds.unionWith(i.visualBounds());
+        if (DrawingGlyphs *glyphs = dynamic_cast<DrawingGlyphs *>(&i)) {
+            bounds.unionWith(glyphs->getPickBox());
+        }
+        if (_reindex) {
+            _index->add(&i, bounds);
+        } else {
+            _index->setBounds(order++, bounds);
+        }
+    }
+    if (_reindex) {
+        _index->build();
+        _reindex = false;
+    } else {
+        _index->refit();
+    }
+}
+
+/// The index refers to children by position, so it must be rebuilt on the next update.
+void
+DrawingGroup::_childrenChanged()
+{
+    _reindex = true;
+}
+
 unsigned
 DrawingGroup::_renderItem(DrawingContext &dc, Geom::IntRect const &area, unsigned flags, DrawingItem *stop_at)
 {
-    if (stop_at == nullptr) {
+    if (stop_at == nullptr && _index && !_reindex) {
+        // normal rendering of the children touching the area, in Z order
+        std::vector<unsigned> visible;
+        _index->query(area, visible);
+        for (unsigned order : visible) {
+            DrawingItem *i = _index->item(order);
+            i->setAntialiasing(_antialias);
+            i->render(dc, area, flags, stop_at);
+        }
+    } else if (stop_at == nullptr) {
         // normal rendering
         for (auto &i : _children) {
             i.setAntialiasing(_antialias);
@@ -130,6 +196,18 @@ DrawingGroup::_clipItem(DrawingContext &dc, Geom::IntRect const &area)
 DrawingItem *
 DrawingGroup::_pickItem(Geom::Point const &p, double delta, unsigned flags)
 {
+    if (_index && !_reindex) {
+        std::vector<unsigned> candidates;
+        _index->query(p, delta, candidates);
+        for (unsigned order : candidates) {
+            DrawingItem *picked = _index->item(order)->pick(p, delta, flags);
+            if (picked) {
+                return _pick_children ? picked : this;
+            }
+        }
+        return nullptr;
+    }
+
     for (auto & i : _children) {
         DrawingItem *picked = i.pick(p, delta, flags);
         if (picked) {
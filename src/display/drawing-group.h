@@ -17,6 +17,8 @@
 
 namespace Inkscape {
 
+class DrawingItemIndex;
+
 class DrawingGroup
     : public DrawingItem
 {
@@ -37,8 +39,13 @@ protected:
     void _clipItem(DrawingContext &dc, Geom::IntRect const &area) override;
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
     bool _canClip() override;
+    void _childrenChanged() override;
+
+    void _updateIndex();
 
     Geom::Affine *_child_transform;
+    DrawingItemIndex *_index; ///< Spatial index of the children, only kept for large groups
+    bool _reindex; ///< The children list changed since the index was built
 };
 
 bool is_drawing_group(DrawingItem *item);
@@ -84,6 +84,8 @@ DrawingImage::_updateItem(Geom::IntRect const &, UpdateContext const &, unsigned
 
     // Calculate bbox
     if (_pixbuf) {
+        // convert now, so that rendering does not modify the pixbuf
+        _pixbuf->ensurePixelFormat(Inkscape::Pixbuf::PF_CAIRO);
         Geom::Rect r = bounds() * _ctm;
         _bbox = r.roundOutwards();
     } else {
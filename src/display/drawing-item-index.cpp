@@ -0,0 +1,252 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Bounding volume hierarchy over the children of a drawing group.
+ *//*
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+
+#include "display/drawing-item-index.h"
+
+namespace Inkscape {
+
+/**
+ * @class DrawingItemIndex
+ * Spatial index of a list of drawing items, used by large groups to find the children
+ * that need to be rendered or picked without testing each of them.
+ *
+ * Items are identified by their order, i.e. their position in the list they were
+ * added from. Queries return the orders of all items whose bounds intersect the query
+ * region, sorted, so that callers can keep processing items in Z order. The returned
+ * set may contain items which do not actually touch the region; callers still have
+ * to test each item.
+ *
+ * When item bounds change, the tree is refitted by growing or shrinking the boxes
+ * of the affected nodes. Since this degrades the quality of the tree as items move
+ * around, it is rebuilt once as many changes as there are items have accumulated.
+ */
+
+DrawingItemIndex::DrawingItemIndex()
+    : _moved(0)
+    , _rebuild(false)
+{}
+
+void
+DrawingItemIndex::clear()
+{
+    _items.clear();
+    _order.clear();
+    _nodes.clear();
+    _dirty.clear();
+    _moved = 0;
+    _rebuild = false;
+}
+
+/// Append an item. build() must be called after all items are added.
+void
+DrawingItemIndex::add(DrawingItem *item, Geom::OptIntRect const &bounds)
+{
+    Item entry = { item, bounds, -1 };
+    _items.push_back(entry);
+}
+
+/// Build the tree from scratch.
+void
+DrawingItemIndex::build()
+{
+    _order.clear();
+    _nodes.clear();
+    _dirty.clear();
+    _moved = 0;
+    _rebuild = false;
+
+    for (unsigned i = 0; i < _items.size(); ++i) {
+        _items[i].leaf = -1;
+        if (_items[i].bounds) {
+            _order.push_back(i);
+        }
+    }
+    if (!_order.empty()) {
+        _nodes.reserve(2 * (_order.size() / LEAF_SIZE + 1));
+        _build(-1, 0, _order.size());
+    }
+}
+
+/// Change the bounds of an item. The tree is updated by the next call to refit().
+void
+DrawingItemIndex::setBounds(unsigned order, Geom::OptIntRect const &bounds)
+{
+    Item &entry = _items[order];
+    if (entry.bounds == bounds) return;
+
+    if (!entry.bounds || !bounds) {
+        _rebuild = true;
+    } else if (entry.leaf >= 0) {
+        _dirty.push_back(entry.leaf);
+    }
+    entry.bounds = bounds;
+    ++_moved;
+}
+
+/// Bring the tree up to date after bounds changes.
+void
+DrawingItemIndex::refit()
+{
+    if (_rebuild || _moved > _items.size()) {
+        build();
+        return;
+    }
+    for (int leaf : _dirty) {
+        _fit(leaf);
+    }
+    _dirty.clear();
+}
+
+/// Find the items whose bounds intersect the given area.
+void
+DrawingItemIndex::query(Geom::IntRect const &area, std::vector<unsigned> &result) const
+{
+    result.clear();
+    if (_nodes.empty()) return;
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        Node const &node = _nodes[stack[--top]];
+        if (!node.bounds.intersects(area)) continue;
+        if (node.count) {
+            for (unsigned i = node.first; i < node.first + node.count; ++i) {
+                if (_items[_order[i]].bounds->intersects(area)) {
+                    result.push_back(_order[i]);
+                }
+            }
+        } else {
+            stack[top++] = node.children[1];
+            stack[top++] = node.children[0];
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+static bool
+near_rect(Geom::IntRect const &r, Geom::Point const &p, double delta)
+{
+    return p[Geom::X] >= r.left() - delta && p[Geom::X] <= r.right() + delta &&
+           p[Geom::Y] >= r.top() - delta && p[Geom::Y] <= r.bottom() + delta;
+}
+
+/// Find the items whose bounds, expanded by @a delta, contain the given point.
+void
+DrawingItemIndex::query(Geom::Point const &p, double delta, std::vector<unsigned> &result) const
+{
+    result.clear();
+    if (_nodes.empty()) return;
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top) {
+        Node const &node = _nodes[stack[--top]];
+        if (!near_rect(node.bounds, p, delta)) continue;
+        if (node.count) {
+            for (unsigned i = node.first; i < node.first + node.count; ++i) {
+                if (near_rect(*_items[_order[i]].bounds, p, delta)) {
+                    result.push_back(_order[i]);
+                }
+            }
+        } else {
+            stack[top++] = node.children[1];
+            stack[top++] = node.children[0];
+        }
+    }
+    std::sort(result.begin(), result.end());
+}
+
+/**
+ * Build the subtree for the entries in [begin, end) of _order, splitting at the median
+ * of the item centers along the longer axis of their extent.
+ * Since the split is balanced, the depth stays well below the size of the query stacks.
+ */
+int
+DrawingItemIndex::_build(int parent, unsigned begin, unsigned end)
+{
+    int index = _nodes.size();
+    _nodes.push_back(Node());
+
+    // centers are doubled to stay in integers
+    Geom::IntRect bounds = *_items[_order[begin]].bounds;
+    Geom::IntPoint c = bounds.min() + bounds.max();
+    Geom::IntRect centers(c, c);
+    for (unsigned i = begin + 1; i < end; ++i) {
+        Geom::IntRect const &b = *_items[_order[i]].bounds;
+        bounds.unionWith(b);
+        centers.expandTo(b.min() + b.max());
+    }
+
+    _nodes[index].bounds = bounds;
+    _nodes[index].parent = parent;
+
+    if (end - begin <= LEAF_SIZE) {
+        _nodes[index].first = begin;
+        _nodes[index].count = end - begin;
+        for (unsigned i = begin; i < end; ++i) {
+            _items[_order[i]].leaf = index;
+        }
+        return index;
+    }
+
+    Geom::Dim2 axis = centers.width() >= centers.height() ? Geom::X : Geom::Y;
+    unsigned mid = begin + (end - begin) / 2;
+    std::nth_element(_order.begin() + begin, _order.begin() + mid, _order.begin() + end,
+        [this, axis](unsigned a, unsigned b) {
+            Geom::IntRect const &ra = *_items[a].bounds;
+            Geom::IntRect const &rb = *_items[b].bounds;
+            return ra.min()[axis] + ra.max()[axis] < rb.min()[axis] + rb.max()[axis];
+        });
+
+    _nodes[index].first = 0;
+    _nodes[index].count = 0;
+    int left = _build(index, begin, mid);
+    int right = _build(index, mid, end);
+    _nodes[index].children[0] = left;
+    _nodes[index].children[1] = right;
+    return index;
+}
+
+/// Recompute the bounds of a leaf and of its ancestors, as far as they change.
+void
+DrawingItemIndex::_fit(int node)
+{
+    Node &leaf = _nodes[node];
+    Geom::IntRect bounds = *_items[_order[leaf.first]].bounds;
+    for (unsigned i = leaf.first + 1; i < leaf.first + leaf.count; ++i) {
+        bounds.unionWith(*_items[_order[i]].bounds);
+    }
+    if (bounds == leaf.bounds) return;
+    leaf.bounds = bounds;
+
+    for (int i = leaf.parent; i >= 0; i = _nodes[i].parent) {
+        Node &inner = _nodes[i];
+        Geom::IntRect b = _nodes[inner.children[0]].bounds;
+        b.unionWith(_nodes[inner.children[1]].bounds);
+        if (b == inner.bounds) break;
+        inner.bounds = b;
+    }
+}
+
+} // end namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Bounding volume hierarchy over the children of a drawing group.
+ *//*
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DISPLAY_DRAWING_ITEM_INDEX_H
+#define SEEN_INKSCAPE_DISPLAY_DRAWING_ITEM_INDEX_H
+
+#include <2geom/int-rect.h>
+#include <2geom/point.h>
+#include <boost/utility.hpp>
+#include <vector>
+
+namespace Inkscape {
+
+class DrawingItem;
+
+class DrawingItemIndex
+    : boost::noncopyable
+{
+public:
+    DrawingItemIndex();
+
+    void clear();
+    void add(DrawingItem *item, Geom::OptIntRect const &bounds);
+    void build();
+    void setBounds(unsigned order, Geom::OptIntRect const &bounds);
+    void refit();
+
+    /// Number of items, including those without bounds.
+    unsigned size() const { return _items.size(); }
+    DrawingItem *item(unsigned order) const { return _items[order].item; }
+
+    void query(Geom::IntRect const &area, std::vector<unsigned> &result) const;
+    void query(Geom::Point const &p, double delta, std::vector<unsigned> &result) const;
+
+private:
+    struct Item {
+        DrawingItem *item;
+        Geom::OptIntRect bounds;
+        int leaf; ///< node containing the item, or -1 if it has no bounds
+    };
+    struct Node {
+        Geom::IntRect bounds;
+        int parent;
+        int children[2]; ///< only for inner nodes
+        unsigned first;  ///< for leaves, the first entry in _order
+        unsigned count;  ///< for leaves, the number of entries; 0 for inner nodes
+    };
+
+    static unsigned const LEAF_SIZE = 8;
+
+    int _build(int parent, unsigned begin, unsigned end);
+    void _fit(int node);
+
+    std::vector<Item> _items;    ///< in the order they were added
+    std::vector<unsigned> _order; ///< items with bounds, grouped by leaf
+    std::vector<Node> _nodes;    ///< the root is the first node
+    std::vector<int> _dirty;     ///< leaves whose items changed bounds since the last refit
+    unsigned _moved;             ///< number of bounds changes since the last build
+    bool _rebuild;               ///< an item gained or lost its bounds
+};
+
+} // end namespace Inkscape
+
+#endif // !SEEN_INKSCAPE_DISPLAY_DRAWING_ITEM_INDEX_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -10,12 +10,16 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+#include <chrono>
 #include <climits>
 
+#include "debug/render-profiler.h"
 #include "display/drawing-context.h"
 #include "display/drawing-group.h"
 #include "display/drawing-item.h"
 #include "display/drawing-pattern.h"
+#include "display/drawing-render-thread.h"
 #include "display/drawing-surface.h"
 #include "display/drawing-text.h"
 #include "display/drawing.h"
@@ -29,6 +33,14 @@
 #include "object/sp-item.h"
 
 namespace Inkscape {
+
+/// Monotonic time in nanoseconds, for measuring rendering costs.
+static int64_t render_clock()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
 /**
  * @class DrawingItem
  * SVG drawing item for display.
@@ -79,6 +91,8 @@ DrawingItem::DrawingItem(Drawing &drawing)
     , _pick_children(0)
     , _antialias(2)
     , _prev_nir(false)
+    , _render_cost(0)
+    , _scored_render_cost(0)
     , _isolation(SP_CSS_ISOLATION_AUTO)
     , _mix_blend_mode(SP_CSS_BLEND_NORMAL)
 {}
@@ -92,6 +106,10 @@ DrawingItem::~DrawingItem()
 
     // remove from the set of cached items and delete cache
     setCached(false, true);
+    // forget a pending update of the cache score
+    _drawing._rescored_items.erase(
+        std::remove(_drawing._rescored_items.begin(), _drawing._rescored_items.end(), this),
+        _drawing._rescored_items.end());
     // remove this item from parent's children list
     // due to the effect of clearChildren(), this only happens for the top-level deleted item
     if (_parent) {
@@ -101,6 +119,7 @@ DrawingItem::~DrawingItem()
     case CHILD_NORMAL: {
         ChildrenList::iterator ithis = _parent->_children.iterator_to(*this);
         _parent->_children.erase(ithis);
+        _parent->_childrenChanged();
         } break;
     case CHILD_CLIP:
         // we cannot call setClip(NULL) or setMask(NULL),
@@ -161,6 +180,7 @@ DrawingItem::appendChild(DrawingItem *item)
     assert(item->_child_type == CHILD_ORPHAN);
     item->_child_type = CHILD_NORMAL;
     _children.push_back(*item);
+    _childrenChanged();
 
     // This ensures that _markForUpdate() called on the child will recurse to this item
     item->_state = STATE_ALL;
@@ -178,6 +198,7 @@ DrawingItem::prependChild(DrawingItem *item)
     assert(item->_child_type == CHILD_ORPHAN);
     item->_child_type = CHILD_NORMAL;
     _children.push_front(*item);
+    _childrenChanged();
     // See appendChild for explanation
     item->_state = STATE_ALL;
     item->_markForUpdate(STATE_ALL, true);
@@ -198,6 +219,7 @@ DrawingItem::clearChildren()
         i._child_type = CHILD_ORPHAN;
     }
     _children.clear_and_dispose(DeleteDisposer());
+    _childrenChanged();
     _markForUpdate(STATE_ALL, false);
 }
 
@@ -288,6 +310,7 @@ DrawingItem::setCached(bool cached, bool persistent)
 
     _cached = cached;
     _cached_persistent = persistent ? cached : false;
+    ++_drawing._generation;
     if (cached) {
         _drawing._cached_items.insert(this);
     } else {
@@ -436,7 +459,10 @@ DrawingItem::setZOrder(unsigned z)
     ChildrenList::iterator i = _parent->_children.begin();
     std::advance(i, std::min(z, unsigned(_parent->_children.size())));
     _parent->_children.insert(i, *this);
+    _parent->_childrenChanged();
     _markForRendering();
+    // let the parent reindex its children
+    _parent->_markForUpdate(STATE_ALL, false);
 }
 
 void
@@ -649,6 +675,9 @@ struct MaskLuminanceToAlpha {
 unsigned
 DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags, DrawingItem *stop_at)
 {
+    // allow background rendering to be paused or cancelled before each item
+    DrawingRenderThread::checkpoint();
+
     bool outline = _drawing.outline();
     bool render_filters = _drawing.renderFilters();
     // stop_at is handled in DrawingGroup, but this check is required to handle the case
@@ -672,6 +701,13 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
         return RENDER_OK;
     }
 
+    // items rendered concurrently from several threads must not use or update their caches
+    bool thread_safe = flags & RENDER_THREAD_SAFE;
+    if (thread_safe) {
+        flags |= RENDER_BYPASS_CACHE;
+        flags &= ~RENDER_MEASURE_COST;
+    }
+
     // carea is the area to paint
     Geom::OptIntRect carea = Geom::intersect(area, _drawbox);
     // iarea is the bounding box for intermediate rendering
@@ -682,12 +718,27 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
     Geom::OptIntRect iarea = carea;
     // expand carea to contain the dependent area of filters.
     if (_filter && render_filters) {
-        iarea = _cacheRect();
-        setCached(_cached, true);
+        if (thread_safe) {
+            // Without a cache, only render the part of the item the filter needs for carea.
+            if (iarea) {
+                _filter->area_enlarge(*iarea, this);
+                iarea.intersectWith(_drawbox);
+            }
+        } else {
+            iarea = _cacheRect();
+            setCached(_cached, true);
+        }
     }
     if (!iarea) {
         return RENDER_OK;
     }
+
+    Debug::RenderProfiler::Scope profile("item", this);
+    if (profile.active()) {
+        profile.setName(name().raw());
+        profile.setPixels(uint64_t(iarea->width()) * iarea->height());
+    }
+
     // Device scale for HiDPI screens (typically 1 or 2)
     int device_scale = dc.surface()->device_scale();
 
@@ -716,14 +767,17 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
             dc.setOperator(ink_css_blend_to_cairo_operator(_mix_blend_mode));
             _cache->paintFromCache(dc, carea, _filter && render_filters);
             if (!carea) {
+                profile.setCache(Debug::RenderProfiler::CACHE_HIT);
                 dc.setSource(0, 0, 0, 0);
                 return RENDER_OK;
             }
+            profile.setCache(Debug::RenderProfiler::CACHE_PARTIAL);
         } else {
             // There is no cache. This could be because caching of this item
             // was just turned on after the last update phase, or because
             // we were previously outside of the canvas.
             _cache = new DrawingCache(*iarea, device_scale);
+            profile.setCache(Debug::RenderProfiler::CACHE_MISS);
         }
     } else {
         // if our caching was turned off after the last update, it was already
@@ -743,10 +797,12 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
     nir |= (_mix_blend_mode != SP_CSS_BLEND_NORMAL); // 5. it has blend mode           
     nir |= (_isolation == SP_CSS_ISOLATION_ISOLATE); // 6. it is isolated    
     nir |= !parent();                                // 7. is root, need isolation from background
-    if (_prev_nir && !needs_intermediate_rendering) {
-        setCached(false, true);
+    if (!thread_safe) {
+        if (_prev_nir && !needs_intermediate_rendering) {
+            setCached(false, true);
+        }
+        _prev_nir = needs_intermediate_rendering;
     }
-    _prev_nir = needs_intermediate_rendering;
     nir |= (_cache != nullptr);                      // 5. it is to be cached
 
     /* How the rendering is done.
@@ -766,9 +822,17 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
     // filters and opacity do not apply when rendering the ancestors of the filtered
     // element
 
+    // measure how long the item takes to render, to decide whether it is worth caching
+    bool measure = flags & RENDER_MEASURE_COST;
+    int64_t start = measure ? render_clock() : 0;
+
     if ((flags & RENDER_FILTER_BACKGROUND) || !needs_intermediate_rendering) {
         dc.setOperator(ink_css_blend_to_cairo_operator(SP_CSS_BLEND_NORMAL));
-        return _renderItem(dc, *iarea, flags & ~RENDER_FILTER_BACKGROUND, stop_at);
+        unsigned result = _renderItem(dc, *iarea, flags & ~RENDER_FILTER_BACKGROUND, stop_at);
+        if (measure && !(flags & RENDER_FILTER_BACKGROUND)) {
+            _measureRenderCost(start, *iarea);
+        }
+        return result;
     }
 
 
@@ -851,7 +915,7 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
     ict.paint();
 
     // 6. Paint the completed rendering onto the base context (or into cache)
-    if (_cached && _cache) {
+    if (_cached && _cache && !(flags & RENDER_BYPASS_CACHE)) {
         DrawingContext cachect(*_cache);
         cachect.rectangle(*iarea);
         cachect.setOperator(CAIRO_OPERATOR_SOURCE);
@@ -875,6 +939,9 @@ DrawingItem::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flag
 
     // the call above is to clear a ref on the intermediate surface held by dc
 
+    if (measure) {
+        _measureRenderCost(start, *iarea);
+    }
     return render_result;
 }
 
@@ -1048,6 +1115,13 @@ DrawingItem::_markForRendering()
     Geom::OptIntRect dirty = outline ? _bbox : _drawbox;
     if (!dirty) return;
 
+    // Rendering requested during an update is the result of a new update context
+    // or of changes already counted by _markForUpdate().
+    if (!_drawing._updating) {
+        ++_drawing._revision;
+    }
+    ++_drawing._generation;
+
     // dirty the caches of all parents
     DrawingItem *bkg_root = nullptr;
 
@@ -1105,6 +1179,11 @@ DrawingItem::_markForUpdate(unsigned flags, bool propagate)
         _propagate_state |= flags;
     }
 
+    if (!_drawing._updating && (flags & ~(STATE_CACHE | STATE_PICK))) {
+        ++_drawing._revision;
+    }
+    ++_drawing._generation;
+
     if (_state & flags) {
         unsigned oldstate = _state;
         _state &= ~flags;
@@ -1132,6 +1211,11 @@ DrawingItem::_cacheScore()
 {
     Geom::OptIntRect cache_rect = _cacheRect();
     if (!cache_rect) return -1.0;
+    if (_render_cost > 0) {
+        // once the item has been rendered, use the measured cost of rendering the cache area
+        _scored_render_cost = _render_cost;
+        return double(cache_rect->width()) * cache_rect->height() * _render_cost / _drawing._unit_render_cost;
+    }
     // a crude first approximation:
     // the basic score is the number of pixels in the drawbox
     double score = cache_rect->area();
@@ -1158,6 +1242,40 @@ DrawingItem::_cacheScore()
     return score;
 }
 
+/**
+ * Update the measured rendering cost from a rendering of @a area started at @a start.
+ * When the cost of a potential cache candidate changes considerably from the one
+ * its cache score was computed with, the score is recomputed in the next update.
+ */
+void
+DrawingItem::_measureRenderCost(int64_t start, Geom::IntRect const &area)
+{
+    double pixels = double(area.width()) * area.height();
+    if (pixels <= 0) return;
+
+    double cost = (render_clock() - start) / pixels;
+    _render_cost = _render_cost > 0 ? 0.75 * _render_cost + 0.25 * cost : cost;
+
+    // plain shapes measure the unit of the cache scores; on small areas the time is
+    // dominated by the overhead of rendering an item at all
+    if (pixels >= 1024 && _children.empty() && !_filter && !_clip && !_mask &&
+        !_fill_pattern && !_stroke_pattern)
+    {
+        _drawing._unit_render_cost = 0.95 * _drawing._unit_render_cost + 0.05 * cost;
+    }
+
+    bool candidate = _has_cache_iterator;
+    if (!candidate && _drawbox) {
+        double score = double(_drawbox->width()) * _drawbox->height() * _render_cost / _drawing._unit_render_cost;
+        candidate = score >= _drawing._cache_score_threshold;
+    }
+    if (candidate && (_render_cost > 2 * _scored_render_cost || _render_cost < 0.5 * _scored_render_cost)) {
+        // requesting an update may call into the canvas, so it is left to Drawing::render
+        // once the whole rendering is done
+        _drawing._rescored_items.push_back(this);
+    }
+}
+
 inline void expandByScale(Geom::IntRect &rect, double scale)
 {
     double fraction = (scale - 1) / 2;
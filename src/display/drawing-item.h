@@ -76,7 +76,9 @@ public:
         RENDER_DEFAULT = 0,
         RENDER_CACHE_ONLY = 1,
         RENDER_BYPASS_CACHE = 2,
-        RENDER_FILTER_BACKGROUND = 4
+        RENDER_FILTER_BACKGROUND = 4,
+        RENDER_THREAD_SAFE = 8, // do not touch caches or other shared state; implies RENDER_BYPASS_CACHE
+        RENDER_MEASURE_COST = 16 // measure rendering costs for the cache scores; set by Drawing::render only
     };
     enum StateFlags {
         STATE_NONE = 0,
@@ -164,6 +166,7 @@ protected:
     void _markForRendering();
     void _invalidateFilterBackground(Geom::IntRect const &area);
     double _cacheScore();
+    void _measureRenderCost(int64_t start, Geom::IntRect const &area);
     Geom::OptIntRect _cacheRect(bool cropped = false);
     virtual unsigned _updateItem(Geom::IntRect const &/*area*/, UpdateContext const &/*ctx*/,
                                  unsigned /*flags*/, unsigned /*reset*/) { return 0; }
@@ -172,6 +175,8 @@ protected:
     virtual void _clipItem(DrawingContext &/*dc*/, Geom::IntRect const &/*area*/) {}
     virtual DrawingItem *_pickItem(Geom::Point const &/*p*/, double /*delta*/, unsigned /*flags*/) { return nullptr; }
     virtual bool _canClip() { return false; }
+    /// Called when children are added, removed or reordered.
+    virtual void _childrenChanged() {}
 
     // member variables start here
 
@@ -210,6 +215,8 @@ protected:
     SPItem *_item; ///< Used to associate DrawingItems with SPItems that created them
     DrawingCache *_cache;
     bool _prev_nir;
+    double _render_cost; ///< Measured rendering time per pixel in nanoseconds, 0 if unknown
+    double _scored_render_cost; ///< Value of _render_cost when the cache score was last computed
 
     CacheList::iterator _cache_iterator;
 
@@ -63,7 +63,7 @@ DrawingPattern::setOverflow(Geom::Affine initial_transform, int steps, Geom::Aff
 }
 
 cairo_pattern_t *
-DrawingPattern::renderPattern(float opacity) {
+DrawingPattern::renderPattern(float opacity, unsigned flags) {
     bool needs_opacity = (1.0 - opacity) >= 1e-3;
     bool visible = opacity >= 1e-3;
 
@@ -101,9 +101,11 @@ DrawingPattern::renderPattern(float opacity) {
         dc.paint();
     }
 
-    //FIXME: What flags to choose?
+    // threaded renderings must not touch the caches of the pattern children either;
+    // rendering a tile says little about the cost of the children, so it is not measured
+    flags &= RENDER_BYPASS_CACHE | RENDER_THREAD_SAFE;
     if (_overflow_steps == 1) {
-        render(dc, one_tile, RENDER_DEFAULT);
+        render(dc, one_tile, flags);
     } else {
         //Overflow transforms need to be transformed to the new coordinate system
         //introduced by dc.transform( pattern_surface.drawingTransform().inverse() );
@@ -114,7 +116,7 @@ DrawingPattern::renderPattern(float opacity) {
         dc.transform(initial_transform);
         for (int i = 0; i < _overflow_steps; i++) {
             // render() fails to handle transforms applied here when using cache.
-            render(dc, one_tile, RENDER_BYPASS_CACHE);
+            render(dc, one_tile, flags | RENDER_BYPASS_CACHE);
             dc.transform(step_transform);
             // cairo_surface_t* raw = pattern_surface.raw();
             // std::string filename = "drawing-pattern" + std::to_string(i) + ".png";
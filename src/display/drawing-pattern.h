@@ -54,8 +54,10 @@ public:
      * Render the pattern.
      *
      * Returns caito_pattern_t structure that can be set as source surface.
+     * The cache flags of the rendering which needs the pattern (RENDER_BYPASS_CACHE,
+     * RENDER_THREAD_SAFE) are passed on to the children of the pattern.
      */
-    cairo_pattern_t *renderPattern(float opacity);
+    cairo_pattern_t *renderPattern(float opacity, unsigned flags = RENDER_DEFAULT);
 protected:
     unsigned _updateItem(Geom::IntRect const &area, UpdateContext const &ctx,
                                      unsigned flags, unsigned reset) override;
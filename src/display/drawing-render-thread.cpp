@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Background rendering of a drawing.
+ *//*
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <glib.h>
+
+#include "display/drawing-render-thread.h"
+#include "display/drawing.h"
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+
+namespace Inkscape {
+
+/**
+ * @class DrawingRenderThread
+ * Renders areas of a drawing on a separate thread, so that expensive renderings
+ * do not block the processing of user input.
+ *
+ * The drawing is not safe to use from several threads, so the rendering thread only
+ * runs while the main loop is waiting for events: the poll function of the default
+ * main context is replaced with one that lets the rendering threads run during the
+ * poll and pauses them at the next checkpoint before anything is dispatched.
+ * Checkpoints are placed at the start of rendering each drawing item, between
+ * filter primitives, and every few rows inside the expensive primitives (blur,
+ * lighting, turbulence, convolution and displacement), so that a single item
+ * does not hold up the main loop for long.
+ *
+ * If the drawing changed while a job was paused, the job is cancelled: the rendering
+ * threads throw Cancelled from their checkpoint and unwind without touching the drawing.
+ * Cancellation can also be requested explicitly with cancel().
+ *
+ * When a job ends, signal_finished is emitted from the main loop; result() then holds
+ * the rendering, or NULL if the job was cancelled.
+ */
+
+thread_local DrawingRenderThread *DrawingRenderThread::_current = nullptr;
+thread_local bool DrawingRenderThread::_active_thread = false;
+std::vector<DrawingRenderThread *> DrawingRenderThread::_instances;
+
+static GPollFunc original_poll = nullptr;
+
+DrawingRenderThread::DrawingRenderThread(Drawing &drawing)
+    : _drawing(drawing)
+    , _device_scale(1)
+    , _threads(1)
+    , _preview(false)
+    , _pending(false)
+    , _quit(false)
+    , _run(false)
+    , _cancel(false)
+    , _active(0)
+    , _paused_generation(0)
+    , _busy(false)
+    , _result(nullptr)
+    , _result_generation(0)
+    , _result_preview(false)
+    , _finished_source(0)
+{
+    if (!original_poll) {
+        original_poll = g_main_context_get_poll_func(nullptr);
+        g_main_context_set_poll_func(nullptr, &DrawingRenderThread::_poll);
+    }
+    _instances.push_back(this);
+    _thread = std::thread(&DrawingRenderThread::_main, this);
+}
+
+DrawingRenderThread::~DrawingRenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+        _cancel = true;
+        _run = true;
+    }
+    _cond.notify_all();
+    _thread.join();
+
+    _instances.erase(std::find(_instances.begin(), _instances.end(), this));
+    if (_finished_source) {
+        g_source_remove(_finished_source);
+    }
+    delete _result;
+}
+
+/**
+ * Start rendering the given area in the background.
+ * Any previous result is discarded.
+ * @param preview Render with the lowest quality, see Drawing::PreviewScope.
+ * @return False if a job is still running.
+ */
+bool
+DrawingRenderThread::start(Geom::IntRect const &area, int device_scale, int threads, bool preview)
+{
+    if (_busy) return false;
+
+    discardResult();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _area = area;
+        _device_scale = device_scale;
+        _threads = threads;
+        _preview = preview;
+        _pending = true;
+        _cancel = false;
+        // we are called from the main loop, so the drawing must not be used yet
+        _run = false;
+        _paused_generation = _drawing.generation();
+    }
+    _busy = true;
+    _cond.notify_all();
+    return true;
+}
+
+/// Abandon the running job, if any.
+void
+DrawingRenderThread::cancel()
+{
+    if (_busy) {
+        _cancel = true;
+    }
+}
+
+void
+DrawingRenderThread::discardResult()
+{
+    delete _result;
+    _result = nullptr;
+}
+
+/**
+ * Mark the calling thread as using the drawing, waiting until the main thread allows it.
+ * Threads of the job which do not use the drawing for a while, for instance because
+ * they wait for other threads, should call leave() so that they do not block the main thread.
+ * @throws Cancelled if the job has been cancelled.
+ */
+void
+DrawingRenderThread::enter()
+{
+    if (_active_thread) return;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _cond.wait(lock, [this] { return _run || _cancel; });
+    if (_cancel) {
+        throw Cancelled();
+    }
+    ++_active;
+    _active_thread = true;
+}
+
+void
+DrawingRenderThread::leave()
+{
+    if (!_active_thread) return;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        --_active;
+        _active_thread = false;
+    }
+    _cond.notify_all();
+}
+
+void
+DrawingRenderThread::_checkpoint()
+{
+    if (!_active_thread || (_run && !_cancel)) return;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_run && !_cancel) {
+        --_active;
+        _cond.notify_all();
+        _cond.wait(lock, [this] { return _run || _cancel; });
+        ++_active;
+    }
+    if (_cancel) {
+        throw Cancelled();
+    }
+}
+
+void
+DrawingRenderThread::_main()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _cond.wait(lock, [this] { return _quit || _pending; });
+        if (_quit) break;
+        _pending = false;
+        Geom::IntRect area = _area;
+        int device_scale = _device_scale;
+        int threads = _threads;
+        lock.unlock();
+
+        DrawingSurface *surface = new DrawingSurface(area, device_scale);
+        unsigned generation = 0;
+        try {
+            Activity activity(this);
+            {
+                DrawingContext dc(*surface);
+                _drawing.renderThreaded(dc, area, threads);
+            }
+            // the rendering corresponds to this state of the drawing
+            generation = _drawing.generation();
+        } catch (Cancelled const &) {
+            delete surface;
+            surface = nullptr;
+        }
+
+        lock.lock();
+        _result = surface;
+        _result_generation = generation;
+        _result_preview = _preview;
+        _finished_source = g_idle_add(&DrawingRenderThread::_finished, this);
+    }
+}
+
+int
+DrawingRenderThread::_finished(void *data)
+{
+    DrawingRenderThread *self = reinterpret_cast<DrawingRenderThread *>(data);
+    {
+        std::lock_guard<std::mutex> lock(self->_mutex);
+        self->_finished_source = 0;
+    }
+    self->_busy = false;
+    self->signal_finished.emit();
+    return FALSE;
+}
+
+/// Let the rendering threads run; called by the main thread before waiting for events.
+void
+DrawingRenderThread::_resume()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_drawing.generation() != _paused_generation) {
+            // the drawing has changed under the paused threads
+            _cancel = true;
+        }
+        _run = true;
+    }
+    _cond.notify_all();
+}
+
+/// Wait until the rendering threads no longer use the drawing; called by the main thread.
+void
+DrawingRenderThread::_pause()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _run = false;
+    _cond.wait(lock, [this] { return _active == 0; });
+    _paused_generation = _drawing.generation();
+}
+
+int
+DrawingRenderThread::_poll(GPollFD *fds, unsigned nfds, int timeout)
+{
+    for (auto thread : _instances) {
+        if (thread->_busy) thread->_resume();
+    }
+    int result = original_poll(fds, nfds, timeout);
+    for (auto thread : _instances) {
+        if (thread->_busy) thread->_pause();
+    }
+    return result;
+}
+
+DrawingRenderThread::Activity::Activity(DrawingRenderThread *thread)
+    : _thread(thread)
+    , _previous(_current)
+    , _was_active(_active_thread)
+{
+    if (!_thread) return;
+    _current = _thread;
+    try {
+        _thread->enter();
+    } catch (...) {
+        _current = _previous;
+        throw;
+    }
+}
+
+DrawingRenderThread::Activity::~Activity()
+{
+    if (!_thread) return;
+    if (!_was_active) {
+        _thread->leave();
+    }
+    _current = _previous;
+}
+
+} // end namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Background rendering of a drawing.
+ *//*
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DISPLAY_DRAWING_RENDER_THREAD_H
+#define SEEN_INKSCAPE_DISPLAY_DRAWING_RENDER_THREAD_H
+
+#include <2geom/int-rect.h>
+#include <atomic>
+#include <boost/utility.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <sigc++/sigc++.h>
+#include <thread>
+#include <vector>
+
+typedef struct _GPollFD GPollFD;
+
+namespace Inkscape {
+
+class Drawing;
+class DrawingSurface;
+
+class DrawingRenderThread
+    : boost::noncopyable
+{
+public:
+    /// Thrown at a checkpoint in the rendering threads when the job has been cancelled.
+    struct Cancelled {};
+
+    /**
+     * Marks the calling thread as rendering the drawing of @a thread during its lifetime.
+     * Does nothing if @a thread is NULL.
+     * @throws Cancelled if the job is cancelled while waiting for permission to run.
+     */
+    class Activity
+        : boost::noncopyable
+    {
+    public:
+        explicit Activity(DrawingRenderThread *thread);
+        ~Activity();
+    private:
+        DrawingRenderThread *_thread;
+        DrawingRenderThread *_previous;
+        bool _was_active;
+    };
+
+    explicit DrawingRenderThread(Drawing &drawing);
+    ~DrawingRenderThread();
+
+    bool start(Geom::IntRect const &area, int device_scale, int threads, bool preview = false);
+    void cancel();
+    bool busy() const { return _busy; }
+
+    DrawingSurface *result() { return _result; }
+    unsigned resultGeneration() const { return _result_generation; }
+    /// Whether the result was rendered as a fast preview.
+    bool resultPreview() const { return _result_preview; }
+    void discardResult();
+
+    /// Emitted in the main loop when a job has finished, whether it completed or not.
+    sigc::signal<void> signal_finished;
+
+    /// The job the calling thread is rendering for, or NULL.
+    static DrawingRenderThread *current() { return _current; }
+    /// Whether the running job renders as a fast preview; not changed while a job runs.
+    bool preview() const { return _preview; }
+    /// Pauses or abandons the rendering if requested by the main thread.
+    static void checkpoint() {
+        if (_current) _current->_checkpoint();
+    }
+
+    void enter();
+    void leave();
+
+private:
+    void _main();
+    void _checkpoint();
+    void _pause();
+    void _resume();
+
+    static int _finished(void *data);
+    static int _poll(GPollFD *fds, unsigned nfds, int timeout);
+
+    Drawing &_drawing;
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+
+    // job parameters, protected by _mutex
+    Geom::IntRect _area;
+    int _device_scale;
+    int _threads;
+    bool _preview;
+    bool _pending;
+    bool _quit;
+
+    // state of the rendering threads
+    std::atomic<bool> _run;    ///< false while the main thread may use the drawing
+    std::atomic<bool> _cancel;
+    int _active;               ///< number of threads currently using the drawing
+    unsigned _paused_generation;
+
+    // accessed by the main thread only, or under _mutex by the rendering thread
+    bool _busy;
+    DrawingSurface *_result;
+    unsigned _result_generation;
+    bool _result_preview;
+    unsigned _finished_source;
+
+    static thread_local DrawingRenderThread *_current;
+    static thread_local bool _active_thread;
+    static std::vector<DrawingRenderThread *> _instances;
+};
+
+} // end namespace Inkscape
+
+#endif // !SEEN_INKSCAPE_DISPLAY_DRAWING_RENDER_THREAD_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -154,12 +154,12 @@ DrawingShape::_updateItem(Geom::IntRect const &area, UpdateContext const &ctx, u
 }
 
 void
-DrawingShape::_renderFill(DrawingContext &dc)
+DrawingShape::_renderFill(DrawingContext &dc, unsigned flags)
 {
     Inkscape::DrawingContext::Save save(dc);
     dc.transform(_ctm);
 
-    bool has_fill =  _nrstyle.prepareFill(dc, _item_bbox, _fill_pattern);
+    bool has_fill =  _nrstyle.prepareFill(dc, _item_bbox, _fill_pattern, flags);
 
     if( has_fill ) {
         dc.path(_curve->get_pathvector());
@@ -170,12 +170,12 @@ DrawingShape::_renderFill(DrawingContext &dc)
 }
 
 void
-DrawingShape::_renderStroke(DrawingContext &dc)
+DrawingShape::_renderStroke(DrawingContext &dc, unsigned flags)
 {
     Inkscape::DrawingContext::Save save(dc);
     dc.transform(_ctm);
 
-    bool has_stroke = _nrstyle.prepareStroke(dc, _item_bbox, _stroke_pattern);
+    bool has_stroke = _nrstyle.prepareStroke(dc, _item_bbox, _stroke_pattern, flags);
     has_stroke &= (_nrstyle.stroke_width != 0);
 
     if( has_stroke ) {
@@ -251,8 +251,8 @@ DrawingShape::_renderItem(DrawingContext &dc, Geom::IntRect const &area, unsigne
             // update fill and stroke paints.
             // this cannot be done during nr_arena_shape_update, because we need a Cairo context
             // to render svg:pattern
-            bool has_fill   = _nrstyle.prepareFill(dc, _item_bbox, _fill_pattern);
-            bool has_stroke = _nrstyle.prepareStroke(dc, _item_bbox, _stroke_pattern);
+            bool has_fill   = _nrstyle.prepareFill(dc, _item_bbox, _fill_pattern, flags);
+            bool has_stroke = _nrstyle.prepareStroke(dc, _item_bbox, _stroke_pattern, flags);
             has_stroke &= (_nrstyle.stroke_width != 0);
             if (has_fill || has_stroke) {
                 dc.path(_curve->get_pathvector());
@@ -292,10 +292,10 @@ DrawingShape::_renderItem(DrawingContext &dc, Geom::IntRect const &area, unsigne
     for (auto & i : _nrstyle.paint_order_layer) {
         switch (i) {
             case NRStyle::PAINT_ORDER_FILL:
-                _renderFill(dc);
+                _renderFill(dc, flags);
                 break;
             case NRStyle::PAINT_ORDER_STROKE:
-                _renderStroke(dc);
+                _renderStroke(dc, flags);
                 break;
             case NRStyle::PAINT_ORDER_MARKER:
                 _renderMarkers(dc, area, flags, stop_at);
@@ -41,8 +41,8 @@ protected:
     DrawingItem *_pickItem(Geom::Point const &p, double delta, unsigned flags) override;
     bool _canClip() override;
 
-    void _renderFill(DrawingContext &dc);
-    void _renderStroke(DrawingContext &dc);
+    void _renderFill(DrawingContext &dc, unsigned flags);
+    void _renderStroke(DrawingContext &dc, unsigned flags);
     void _renderMarkers(DrawingContext &dc, Geom::IntRect const &area, unsigned flags,
                         DrawingItem *stop_at);
 
@@ -225,6 +225,7 @@ DrawingText::clear()
 {
     _markForRendering();
     _children.clear_and_dispose(DeleteDisposer());
+    _childrenChanged();
 }
 
 bool
@@ -450,7 +451,7 @@ void DrawingText::decorateItem(DrawingContext &dc, double phase_length, bool und
     }
 }
 
-unsigned DrawingText::_renderItem(DrawingContext &dc, Geom::IntRect const &/*area*/, unsigned /*flags*/, DrawingItem * /*stop_at*/)
+unsigned DrawingText::_renderItem(DrawingContext &dc, Geom::IntRect const &/*area*/, unsigned flags, DrawingItem * /*stop_at*/)
 {
     if (_drawing.outline()) {
         guint32 rgba = _drawing.outlinecolor;
@@ -492,13 +493,13 @@ unsigned DrawingText::_renderItem(DrawingContext &dc, Geom::IntRect const &/*are
         Inkscape::DrawingContext::Save save(dc);
         dc.transform(_ctm);
 
-        has_fill      = _nrstyle.prepareFill(                dc, _item_bbox, _fill_pattern);
-        has_stroke    = _nrstyle.prepareStroke(              dc, _item_bbox, _stroke_pattern);
+        has_fill      = _nrstyle.prepareFill(                dc, _item_bbox, _fill_pattern, flags);
+        has_stroke    = _nrstyle.prepareStroke(              dc, _item_bbox, _stroke_pattern, flags);
 
         // Avoid creating patterns if not needed
         if( decorate ) {
-            has_td_fill   = _nrstyle.prepareTextDecorationFill(  dc, _item_bbox, _fill_pattern);
-            has_td_stroke = _nrstyle.prepareTextDecorationStroke(dc, _item_bbox, _stroke_pattern);
+            has_td_fill   = _nrstyle.prepareTextDecorationFill(  dc, _item_bbox, _fill_pattern, flags);
+            has_td_stroke = _nrstyle.prepareTextDecorationStroke(dc, _item_bbox, _stroke_pattern, flags);
         }
     }
 
@@ -0,0 +1,269 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Cache of rendered canvas tiles kept across zoom levels.
+ *//*
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <glib.h>
+
+#include "display/drawing-tile-cache.h"
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+
+namespace Inkscape {
+
+/**
+ * @class DrawingTileCache
+ * Stores rendered pieces of a drawing, so that returning to a recently displayed
+ * zoom level does not require rendering it again.
+ *
+ * Tiles are square pieces of the rendering in world (screen) coordinates, aligned
+ * to multiples of TILE_SIZE. They are keyed by the zoom level, which is identified
+ * by the drawing transform and rendering settings, and by the tile coordinates.
+ * Since the desktop-to-window transform does not contain a translation, scrolling
+ * keeps the level and reuses its tiles as well.
+ *
+ * The cache is only valid for one revision of the drawing; when the revision
+ * changes, all tiles are dropped. When the memory budget is exceeded, the least
+ * recently used tiles are discarded first.
+ */
+
+DrawingTileCache::DrawingTileCache()
+    : _level(0)
+    , _next_level_id(0)
+    , _revision(0)
+    , _revision_time(0)
+    , _budget(0)
+    , _used(0)
+{}
+
+DrawingTileCache::~DrawingTileCache()
+{
+    clear();
+}
+
+void
+DrawingTileCache::setBudget(size_t bytes)
+{
+    _budget = bytes;
+    _evict();
+}
+
+/**
+ * Select the zoom level used by subsequent calls to paint() and store().
+ * If @a revision differs from the one seen previously, the drawing has changed
+ * and all cached tiles are discarded.
+ */
+void
+DrawingTileCache::setLevel(Geom::Affine const &ctm, Settings const &settings, unsigned revision)
+{
+    if (revision != _revision) {
+        clear();
+        _revision = revision;
+        _revision_time = g_get_monotonic_time();
+    }
+
+    for (auto i = _levels.begin(); i != _levels.end(); ++i) {
+        if (i->ctm == ctm && i->settings == settings) {
+            _level = i->id;
+            // keep the level list in order of use
+            std::rotate(i, i + 1, _levels.end());
+            return;
+        }
+    }
+
+    if (_levels.size() >= MAX_LEVELS) {
+        _dropLevel(_levels.front().id);
+        _levels.erase(_levels.begin());
+    }
+    Level level = { _next_level_id++, ctm, settings };
+    _levels.push_back(level);
+    _level = level.id;
+}
+
+/**
+ * Whether the drawing has not been modified for a while.
+ * While the drawing is being edited, rendering whole tiles instead of only the
+ * requested area would only slow down the redraw, since they would be discarded
+ * again on the next change.
+ */
+bool
+DrawingTileCache::settled() const
+{
+    int64_t const settle_time = 500000; // microseconds
+    return g_get_monotonic_time() - _revision_time >= settle_time;
+}
+
+/**
+ * Paint the given area of the current level from the cache.
+ * @return True if all tiles covering the area were available and have been painted,
+ *         false if at least one was missing, in which case nothing is painted.
+ */
+bool
+DrawingTileCache::paint(DrawingContext &dc, Geom::IntRect const &area)
+{
+    if (!enabled()) return false;
+
+    Geom::IntRect tiles = tileBounds(area);
+    std::vector<DrawingSurface *> found;
+    for (int y = tiles.top(); y < tiles.bottom(); y += TILE_SIZE) {
+        for (int x = tiles.left(); x < tiles.right(); x += TILE_SIZE) {
+            DrawingSurface *tile = _lookup(x, y);
+            if (!tile) return false;
+            found.push_back(tile);
+        }
+    }
+
+    for (auto tile : found) {
+        Geom::OptIntRect part = tile->area().roundOutwards() & area;
+        if (!part) continue;
+        dc.rectangle(*part);
+        dc.setSource(tile);
+        dc.fill();
+    }
+    dc.setSource(0, 0, 0, 0);
+    return true;
+}
+
+/// Whether all tiles covering the given area of the current level are in the cache.
+bool
+DrawingTileCache::contains(Geom::IntRect const &area) const
+{
+    if (!enabled()) return false;
+
+    Geom::IntRect tiles = tileBounds(area);
+    for (int y = tiles.top(); y < tiles.bottom(); y += TILE_SIZE) {
+        for (int x = tiles.left(); x < tiles.right(); x += TILE_SIZE) {
+            if (!_index.count(TileKey(_level, x, y))) return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Copy a rendering of the current level into the cache.
+ * Only tiles entirely covered by the rendering are stored.
+ */
+void
+DrawingTileCache::store(DrawingSurface &rendering)
+{
+    if (!enabled() || !rendering.raw()) return;
+
+    Geom::IntRect area = rendering.area().roundOutwards();
+    Geom::IntRect tiles = tileBounds(area);
+    int const device_scale = rendering.device_scale();
+
+    for (int y = tiles.top(); y < tiles.bottom(); y += TILE_SIZE) {
+        for (int x = tiles.left(); x < tiles.right(); x += TILE_SIZE) {
+            Geom::IntRect bounds = Geom::IntRect::from_xywh(x, y, TILE_SIZE, TILE_SIZE);
+            if (!area.contains(bounds)) continue;
+
+            TileKey key(_level, x, y);
+            auto existing = _index.find(key);
+            if (existing != _index.end()) {
+                _erase(existing->second);
+            }
+
+            DrawingSurface *tile = new DrawingSurface(bounds, device_scale);
+            DrawingContext tdc(*tile);
+            tdc.setOperator(CAIRO_OPERATOR_SOURCE);
+            tdc.setSource(&rendering);
+            tdc.paint();
+
+            Tile t = { _level, x, y, tile };
+            _tiles.push_front(t);
+            _index[key] = _tiles.begin();
+            _used += _tileBytes(device_scale);
+        }
+    }
+    _evict();
+}
+
+/// Discard all cached tiles.
+void
+DrawingTileCache::clear()
+{
+    for (auto &tile : _tiles) {
+        delete tile.surface;
+    }
+    _tiles.clear();
+    _index.clear();
+    _used = 0;
+}
+
+/// Compute the smallest tile-aligned rectangle containing the given area.
+Geom::IntRect
+DrawingTileCache::tileBounds(Geom::IntRect const &area)
+{
+    auto round_down = [](int v) { return v >= 0 ? v / TILE_SIZE * TILE_SIZE : -((-v + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE); };
+    auto round_up = [&](int v) { return -round_down(-v); };
+    return Geom::IntRect(round_down(area.left()), round_down(area.top()),
+                         round_up(area.right()), round_up(area.bottom()));
+}
+
+/// Find a tile of the current level and mark it as recently used.
+DrawingSurface *
+DrawingTileCache::_lookup(int x, int y)
+{
+    auto found = _index.find(TileKey(_level, x, y));
+    if (found == _index.end()) return nullptr;
+
+    _tiles.splice(_tiles.begin(), _tiles, found->second);
+    return found->second->surface;
+}
+
+void
+DrawingTileCache::_erase(TileList::iterator i)
+{
+    _used -= _tileBytes(i->surface->device_scale());
+    _index.erase(TileKey(i->level, i->x, i->y));
+    delete i->surface;
+    _tiles.erase(i);
+}
+
+void
+DrawingTileCache::_dropLevel(unsigned level)
+{
+    for (auto i = _tiles.begin(); i != _tiles.end();) {
+        auto next = i;
+        ++next;
+        if (i->level == level) {
+            _erase(i);
+        }
+        i = next;
+    }
+}
+
+void
+DrawingTileCache::_evict()
+{
+    while (_used > _budget && !_tiles.empty()) {
+        auto last = _tiles.end();
+        --last;
+        _erase(last);
+    }
+}
+
+size_t
+DrawingTileCache::_tileBytes(int device_scale)
+{
+    size_t side = TILE_SIZE * device_scale;
+    return side * side * 4;
+}
+
+} // end namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,110 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Cache of rendered canvas tiles kept across zoom levels.
+ *//*
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_INKSCAPE_DISPLAY_DRAWING_TILE_CACHE_H
+#define SEEN_INKSCAPE_DISPLAY_DRAWING_TILE_CACHE_H
+
+#include <2geom/affine.h>
+#include <2geom/int-rect.h>
+#include <boost/utility.hpp>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace Inkscape {
+
+class DrawingContext;
+class DrawingSurface;
+
+class DrawingTileCache
+    : boost::noncopyable
+{
+public:
+    /// Rendering parameters which, together with the transform, identify a zoom level.
+    struct Settings {
+        int render_mode;
+        int filter_quality;
+        int blur_quality;
+        int device_scale;
+
+        bool operator==(Settings const &other) const {
+            return render_mode == other.render_mode && filter_quality == other.filter_quality &&
+                   blur_quality == other.blur_quality && device_scale == other.device_scale;
+        }
+    };
+
+    static int const TILE_SIZE = 256;
+
+    DrawingTileCache();
+    ~DrawingTileCache();
+
+    size_t budget() const { return _budget; }
+    void setBudget(size_t bytes);
+    bool enabled() const { return _budget > 0; }
+
+    void setLevel(Geom::Affine const &ctm, Settings const &settings, unsigned revision);
+    bool settled() const;
+    bool contains(Geom::IntRect const &area) const;
+    bool paint(DrawingContext &dc, Geom::IntRect const &area);
+    void store(DrawingSurface &rendering);
+    void clear();
+
+    static Geom::IntRect tileBounds(Geom::IntRect const &area);
+
+private:
+    struct Tile {
+        unsigned level;
+        int x;
+        int y;
+        DrawingSurface *surface;
+    };
+    typedef std::list<Tile> TileList;
+    typedef std::tuple<unsigned, int, int> TileKey;
+
+    struct Level {
+        unsigned id;
+        Geom::Affine ctm;
+        Settings settings;
+    };
+
+    static unsigned const MAX_LEVELS = 8;
+
+    DrawingSurface *_lookup(int x, int y);
+    void _erase(TileList::iterator i);
+    void _dropLevel(unsigned level);
+    void _evict();
+    static size_t _tileBytes(int device_scale);
+
+    TileList _tiles; ///< most recently used first
+    std::map<TileKey, TileList::iterator> _index;
+    std::vector<Level> _levels; ///< least recently selected first
+    unsigned _level;
+    unsigned _next_level_id;
+    unsigned _revision;
+    int64_t _revision_time; ///< when the revision last changed, in monotonic microseconds
+    size_t _budget;
+    size_t _used;
+};
+
+} // end namespace Inkscape
+
+#endif // !SEEN_INKSCAPE_DISPLAY_DRAWING_TILE_CACHE_H
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -11,10 +11,18 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
+#endif
+
 #include <algorithm>
+#include <vector>
 #include "display/drawing.h"
+#include "display/drawing-render-thread.h"
+#include "display/drawing-surface.h"
 #include "nr-filter-gaussian.h"
 #include "nr-filter-types.h"
+#include "preferences.h"
 
 //grayscale colormode:
 #include "cairo-templates.h"
@@ -31,17 +39,28 @@ static const gdouble grayscale_value_matrix[20] = {
     0   , 0   , 0    , 1, 0
 };
 
+// Time to render one pixel of a plain shape until it is measured, in nanoseconds: the order
+// of magnitude of filling and compositing an antialiased path with cairo. With it, the
+// measured scores of unfiltered shapes roughly match their pixel counts, which are used as
+// scores before an item is first rendered.
+static const double DEFAULT_UNIT_RENDER_COST = 5.0;
+
 Drawing::Drawing(SPCanvasArena *arena)
     : _root(nullptr)
     , outlinecolor(0x000000ff)
     , delta(0)
     , _exact(false)
+    , _preview(false)
     , _outline_sensitive(true)
     , _rendermode(RENDERMODE_NORMAL)
     , _colormode(COLORMODE_NORMAL)
     , _blur_quality(BLUR_QUALITY_BEST)
     , _filter_quality(Filters::FILTER_QUALITY_BEST)
+    , _revision(0)
+    , _generation(0)
+    , _updating(false)
     , _cache_score_threshold(50000.0)
+    , _unit_render_cost(DEFAULT_UNIT_RENDER_COST)
     , _cache_budget(0)
     , _grayscale_colormatrix(std::vector<gdouble>(grayscale_value_matrix, grayscale_value_matrix + 20))
     , _canvasarena(arena)
@@ -59,6 +78,7 @@ Drawing::setRoot(DrawingItem *item)
 {
     delete _root;
     _root = item;
+    ++_generation;
     if (item) {
         assert(item->_child_type == DrawingItem::CHILD_ORPHAN);
         item->_child_type = DrawingItem::CHILD_ROOT;
@@ -113,26 +133,42 @@ void
 Drawing::setRenderMode(RenderMode mode)
 {
     _rendermode = mode;
+    ++_generation;
 }
 void
 Drawing::setColorMode(ColorMode mode)
 {
     _colormode = mode;
+    ++_generation;
 }
 void
 Drawing::setBlurQuality(int q)
 {
     _blur_quality = q;
+    ++_generation;
 }
 void
 Drawing::setFilterQuality(int q)
 {
     _filter_quality = q;
+    ++_generation;
 }
 void
 Drawing::setExact(bool e)
 {
     _exact = e;
+    ++_generation;
+}
+Drawing::PreviewScope::PreviewScope(Drawing &drawing, bool preview)
+    : _drawing(drawing)
+    , _previous(drawing._preview)
+{
+    _drawing._preview = preview;
+}
+
+Drawing::PreviewScope::~PreviewScope()
+{
+    _drawing._preview = _previous;
 }
 
 void Drawing::setOutlineSensitive(bool e) { _outline_sensitive = e; };
@@ -146,6 +182,7 @@ void
 Drawing::setCacheLimit(Geom::OptIntRect const &r)
 {
     _cache_limit = r;
+    ++_generation;
     for (auto _cached_item : _cached_items)
     {
         _cached_item->_markForUpdate(DrawingItem::STATE_CACHE, false);
@@ -155,6 +192,7 @@ void
 Drawing::setCacheBudget(size_t bytes)
 {
     _cache_budget = bytes;
+    ++_generation;
     _pickItemsForCaching();
 }
 
@@ -162,14 +200,21 @@ void
 Drawing::setGrayscaleMatrix(gdouble value_matrix[20]) {
     _grayscale_colormatrix = Filters::FilterColorMatrix::ColorMatrixMatrix( 
         std::vector<gdouble> (value_matrix, value_matrix + 20) );
+    ++_revision;
+    ++_generation;
 }
 
 void
 Drawing::update(Geom::IntRect const &area, UpdateContext const &ctx, unsigned flags, unsigned reset)
 {
+    if (reset) {
+        ++_generation;
+    }
+    _updating = true;
     if (_root) {
         _root->update(area, ctx, flags, reset);
     }
+    _updating = false;
     if ((flags & DrawingItem::STATE_CACHE) || (flags & DrawingItem::STATE_ALL)) {
         // process the updated cache scores
         _pickItemsForCaching();
@@ -179,6 +224,20 @@ Drawing::update(Geom::IntRect const &area, UpdateContext const &ctx, unsigned fl
 void
 Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags, int antialiasing)
 {
+    loadQualityPreferences();
+    // rendering updates the item caches
+    ++_generation;
+    if (_preview) {
+        flags |= DrawingItem::RENDER_BYPASS_CACHE;
+    }
+    // Rendering costs are shared state of the drawing, so they are only measured here, on the
+    // thread which owns the drawing; renderings which bypass the cache may not be representative
+    // (previews, exports).
+    flags &= ~DrawingItem::RENDER_MEASURE_COST;
+    if (!(flags & DrawingItem::RENDER_BYPASS_CACHE) && !DrawingRenderThread::current()) {
+        flags |= DrawingItem::RENDER_MEASURE_COST;
+    }
+
     if (_root) {
         int prev_a = _root->_antialias;
         if(antialiasing >= 0)
@@ -187,6 +246,155 @@ Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags, i
         _root->setAntialiasing(prev_a);
     }
 
+    // the items were collected by the measurements of this rendering
+    for (auto item : _rescored_items) {
+        item->_markForUpdate(DrawingItem::STATE_CACHE, false);
+    }
+    _rescored_items.clear();
+
+    _renderGrayscale(dc);
+}
+
+/**
+ * Render the drawing using several threads.
+ * The area is split into horizontal bands, which are rendered concurrently, each into
+ * its own surface, and then composited onto @a dc by the calling thread.
+ * Item caches are neither used nor updated while rendering this way.
+ */
+void
+Drawing::renderThreaded(DrawingContext &dc, Geom::IntRect const &area, int threads, unsigned flags,
+                        int antialiasing)
+{
+    // When called from a background rendering job, the main thread may update the drawing
+    // whenever the job reaches a checkpoint, so even a single thread must render the way the
+    // bands are rendered, without touching the item caches.
+    DrawingRenderThread *job = DrawingRenderThread::current();
+
+    // outline rendering modifies outlinecolor while rendering clips and masks
+    if (!job && (!_root || threads < 2 || outline())) {
+        render(dc, area, flags, antialiasing);
+        return;
+    }
+    if (!_root) {
+        return;
+    }
+    if (outline()) {
+        // jobs are not started in outline mode, and switching to it cancels them
+        throw DrawingRenderThread::Cancelled();
+    }
+    threads = std::max(threads, 1);
+
+    // a background job keeps the preview mode it was started in
+    _loadQualityPreferences(job ? job->preview() : _preview);
+
+    // Use more bands than threads, so that threads which got cheap bands can pick up
+    // more work, but keep them large enough that filter margins do not dominate.
+    int const band_align = 16;
+    int band_height = area.height() / (2 * threads);
+    band_height = std::max(4 * band_align, (band_height + band_align - 1) / band_align * band_align);
+
+    std::vector<Geom::IntRect> bands;
+    for (int y = area.top(); y < area.bottom(); y += band_height) {
+        bands.emplace_back(area.left(), y, area.right(), std::min(y + band_height, area.bottom()));
+    }
+
+    int const device_scale = dc.surface()->device_scale();
+    int const count = bands.size();
+    std::vector<DrawingSurface *> results(count, nullptr);
+
+    // When called from a background rendering job, the bands are rendered as part of
+    // the job, and this thread does not use the drawing while it waits for them.
+    std::atomic<bool> cancelled(false);
+    if (job) {
+        job->leave();
+    }
+
+    int const prev_a = _root->_antialias;
+    if (antialiasing >= 0) {
+        _root->setAntialiasing(antialiasing);
+    }
+
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+    for (int i = 0; i < count; ++i) {
+        results[i] = new DrawingSurface(bands[i], device_scale);
+        if (cancelled) continue;
+        // exceptions must not leave the parallel region
+        try {
+            DrawingRenderThread::Activity activity(job);
+            DrawingContext bdc(*results[i]);
+            _root->render(bdc, bands[i], (flags & ~DrawingItem::RENDER_MEASURE_COST) | DrawingItem::RENDER_THREAD_SAFE);
+        } catch (DrawingRenderThread::Cancelled const &) {
+            cancelled = true;
+        }
+    }
+
+    _root->setAntialiasing(prev_a);
+
+    if (job && !cancelled) {
+        try {
+            job->enter();
+        } catch (DrawingRenderThread::Cancelled const &) {
+            cancelled = true;
+        }
+    }
+
+    if (!cancelled) {
+        for (int i = 0; i < count; ++i) {
+            dc.rectangle(bands[i]);
+            dc.setSource(results[i]);
+            dc.fill();
+        }
+        dc.setSource(0, 0, 0, 0);
+    }
+    for (int i = 0; i < count; ++i) {
+        delete results[i];
+    }
+    if (cancelled) {
+        throw DrawingRenderThread::Cancelled();
+    }
+
+    _renderGrayscale(dc);
+}
+
+DrawingItem *
+Drawing::pick(Geom::Point const &p, double delta, unsigned flags)
+{
+    if (_root) {
+        return _root->pick(p, delta, flags);
+    }
+    return nullptr;
+}
+
+void
+Drawing::loadQualityPreferences()
+{
+    _loadQualityPreferences(_preview);
+}
+
+void
+Drawing::_loadQualityPreferences(bool preview)
+{
+    // Done here rather than in Filter::render, so that filters can be rendered from several threads.
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    int filter_quality = prefs->getInt("/options/filterquality/value", 0);
+    int blur_quality = prefs->getInt("/options/blurquality/value", 0);
+    if (preview) {
+        filter_quality = Filters::FILTER_QUALITY_WORST;
+        blur_quality = BLUR_QUALITY_WORST;
+    }
+    if (filter_quality != _filter_quality || blur_quality != _blur_quality) {
+        // a paused background job must not continue with another quality
+        _filter_quality = filter_quality;
+        _blur_quality = blur_quality;
+        ++_generation;
+    }
+}
+
+void
+Drawing::_renderGrayscale(DrawingContext &dc)
+{
     if (colorMode() == COLORMODE_GRAYSCALE) {
         // apply grayscale filter on top of everything
         cairo_surface_t *input = dc.rawTarget();
@@ -197,36 +405,35 @@ Drawing::render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags, i
         dc.setOperator(CAIRO_OPERATOR_SOURCE);
         dc.paint();
         dc.setOperator(CAIRO_OPERATOR_OVER);
-    
-        cairo_surface_destroy(out);
-    }
-}
 
-DrawingItem *
-Drawing::pick(Geom::Point const &p, double delta, unsigned flags)
-{
-    if (_root) {
-        return _root->pick(p, delta, flags);
+        cairo_surface_destroy(out);
     }
-    return nullptr;
 }
 
 void
 Drawing::_pickItemsForCaching()
 {
-    // we cache the objects with the highest score until the budget is exhausted
-    _candidate_items.sort(std::greater<CacheRecord>());
-    size_t used = 0;
-    CandidateList::iterator i;
-    for (i = _candidate_items.begin(); i != _candidate_items.end(); ++i) {
-        if (used + i->cache_size > _cache_budget) break;
-        used += i->cache_size;
-    }
+    // We cache the objects that save the most rendering time per byte of cache until the
+    // budget is exhausted. Objects which are already cached get a bonus, so that they are
+    // not swapped for slightly better candidates, which would throw away their contents.
+    auto density = [](CacheRecord const &r) {
+        double d = r.score / std::max<size_t>(r.cache_size, 1);
+        return r.item->cached() ? d * 1.25 : d;
+    };
+    _candidate_items.sort([&](CacheRecord const &a, CacheRecord const &b) {
+        return density(a) > density(b);
+    });
 
+    size_t used = 0;
     std::set<DrawingItem*> to_cache;
-    for (CandidateList::iterator j = _candidate_items.begin(); j != i; ++j) {
-        j->item->setCached(true);
-        to_cache.insert(j->item);
+    for (auto &candidate : _candidate_items) {
+        // a candidate that does not fit may still leave room for smaller ones
+        if (used + candidate.cache_size > _cache_budget) continue;
+        used += candidate.cache_size;
+        to_cache.insert(candidate.item);
+    }
+    for (auto item : to_cache) {
+        item->setCached(true);
     }
     // Everything which is now in _cached_items but not in to_cache must be uncached
     // Note that calling setCached on an item modifies _cached_items
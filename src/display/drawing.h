@@ -14,10 +14,12 @@
 #define SEEN_INKSCAPE_DISPLAY_DRAWING_H
 
 #include <2geom/rect.h>
+#include <atomic>
 #include <boost/operators.hpp>
 #include <boost/utility.hpp>
 #include <set>
 #include <sigc++/sigc++.h>
+#include <vector>
 
 #include "display/drawing-item.h"
 #include "display/rendermode.h"
@@ -61,6 +63,8 @@ public:
     void setFilterQuality(int q);
     void setExact(bool e);
     bool getExact() const { return _exact; };
+    /// Whether the drawing is rendered as a fast preview, see PreviewScope.
+    bool preview() const { return _preview; }
     void setOutlineSensitive(bool e);
     bool getOutlineSensitive() const { return _outline_sensitive; };
 
@@ -72,16 +76,43 @@ public:
 
     void setGrayscaleMatrix(double value_matrix[20]);
 
+    /// Incremented whenever the appearance of the drawing may have changed,
+    /// except for changes caused by a different update context (e.g. zooming).
+    unsigned revision() const { return _revision; }
+    /// Incremented on every change of the drawing state, including the changes made
+    /// while updating and the creation or removal of caches.
+    unsigned generation() const { return _generation; }
+    void loadQualityPreferences();
+
     void update(Geom::IntRect const &area = Geom::IntRect::infinite(), UpdateContext const &ctx = UpdateContext(), unsigned flags = DrawingItem::STATE_ALL, unsigned reset = 0);
     void render(DrawingContext &dc, Geom::IntRect const &area, unsigned flags = 0, int antialiasing = -1);
+    void renderThreaded(DrawingContext &dc, Geom::IntRect const &area, int threads, unsigned flags = 0,
+                        int antialiasing = -1);
     DrawingItem *pick(Geom::Point const &p, double delta, unsigned flags);
 
+    /**
+     * Renders the drawing as a fast preview, or not, during its lifetime.
+     * Preview renderings use the lowest filter and blur quality and bypass the item caches.
+     */
+    class PreviewScope
+        : boost::noncopyable
+    {
+    public:
+        PreviewScope(Drawing &drawing, bool preview);
+        ~PreviewScope();
+    private:
+        Drawing &_drawing;
+        bool _previous;
+    };
+
     sigc::signal<void, DrawingItem *> signal_request_update;
     sigc::signal<void, Geom::IntRect const &> signal_request_render;
     sigc::signal<void, DrawingItem *> signal_item_deleted;
 
 private:
     void _pickItemsForCaching();
+    void _renderGrayscale(DrawingContext &dc);
+    void _loadQualityPreferences(bool preview);
 
     typedef std::list<CacheRecord> CandidateList;
     bool _outline_sensitive;
@@ -94,13 +125,22 @@ public:
     double delta;
 private:
     bool _exact;  // if true then rendering must be exact
+    bool _preview;
     RenderMode _rendermode;
     ColorMode _colormode;
     int _blur_quality;
     int _filter_quality;
+    unsigned _revision;
+    std::atomic<unsigned> _generation;
+    bool _updating; ///< true while update() is running
     Geom::OptIntRect _cache_limit;
 
     double _cache_score_threshold; ///< do not consider objects for caching below this score
+    /// Cache scores are in units of the time needed to render one pixel of a plain shape,
+    /// which is measured while rendering such shapes (nanoseconds).
+    double _unit_render_cost;
+    /// Items whose measured rendering cost changed a lot since their cache score was computed
+    std::vector<DrawingItem *> _rescored_items;
     size_t _cache_budget; ///< maximum allowed size of cache
 
     OutlineColors _colors;
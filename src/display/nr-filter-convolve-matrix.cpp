@@ -120,6 +120,7 @@ void FilterConvolveMatrix::render_cairo(FilterSlot &slot)
 
     cairo_surface_t *input = slot.getcairo(_input);
     cairo_surface_t *out = ink_cairo_surface_create_identical(input);
+    CairoSurfaceRelease release_out(out);
 
     // We may need to transform input surface to correct color interpolation space. The input surface
     // might be used as input to another primitive but it is likely that all the primitives in a given
@@ -173,7 +174,6 @@ void FilterConvolveMatrix::render_cairo(FilterSlot &slot)
     }
 
     slot.set(_output, out);
-    cairo_surface_destroy(out);
 }
 
 void FilterConvolveMatrix::set_targetX(int coord) {
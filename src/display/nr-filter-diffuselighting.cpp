@@ -134,6 +134,7 @@ void FilterDiffuseLighting::render_cairo(FilterSlot &slot)
 {
     cairo_surface_t *input = slot.getcairo(_input);
     cairo_surface_t *out = ink_cairo_surface_create_same_size(input, CAIRO_CONTENT_COLOR_ALPHA);
+    CairoSurfaceRelease release_out(out);
 
     double r = SP_RGBA32_R_F(lighting_color);
     double g = SP_RGBA32_G_F(lighting_color);
@@ -203,7 +204,6 @@ void FilterDiffuseLighting::render_cairo(FilterSlot &slot)
     }
 
     slot.set(_output, out);
-    cairo_surface_destroy(out);
 }
 
 void FilterDiffuseLighting::set_icc(SVGICCColor *icc_color) {
@@ -75,6 +75,7 @@ void FilterDisplacementMap::render_cairo(FilterSlot &slot)
     cairo_surface_t *texture = slot.getcairo(_input);
     cairo_surface_t *map = slot.getcairo(_input2);
     cairo_surface_t *out = ink_cairo_surface_create_identical(texture);
+    CairoSurfaceRelease release_out(out);
     // color_interpolation_filters for out same as texture. See spec.
     copy_cairo_surface_ci( texture, out );
 
@@ -96,7 +97,6 @@ void FilterDisplacementMap::render_cairo(FilterSlot &slot)
     ink_cairo_surface_synthesize(out, Displace(texture, map, Xchannel, Ychannel, scalex, scaley));
 
     slot.set(_output, out);
-    cairo_surface_destroy(out);
 }
 
 void FilterDisplacementMap::set_input(int slot) {
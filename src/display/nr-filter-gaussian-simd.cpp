@@ -0,0 +1,447 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Vectorized inner loops of the Gaussian blur renderer
+ *
+ * The kernels are compiled for their instruction set using function attributes,
+ * so that no special compiler flags are needed; the best set supported by the
+ * processor is picked at runtime. The arithmetic is the same as in the scalar
+ * code, so the results are identical.
+ *
+ * Copyright (C) 2020 authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstring>
+
+#include "display/nr-filter-gaussian-simd.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define INK_GAUSSIAN_SIMD 1
+#include <immintrin.h>
+#define INK_TARGET_SSE2 __attribute__((target("sse2")))
+#define INK_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define INK_GAUSSIAN_SIMD 0
+#endif
+
+namespace Inkscape {
+namespace Filters {
+
+#if INK_GAUSSIAN_SIMD
+
+namespace {
+
+int const FIR_WINDOW_MAX = 2 * GaussianKernels::FIR_MAX_RADIUS + 1;
+
+// The FIR kernels process several lines at once. Their pixels at a given position
+// along the line are only adjacent in memory for vertical passes.
+inline void gather(unsigned char *buf, unsigned char const *p, int str2, int lines, int pc)
+{
+    for (int k = 0; k < lines; ++k) {
+        std::memcpy(buf + k * pc, p + k * str2, pc);
+    }
+}
+
+inline void scatter(unsigned char *p, unsigned char const *buf, int str2, int lines, int pc)
+{
+    for (int k = 0; k < lines; ++k) {
+        std::memcpy(p + k * str2, buf + k * pc, pc);
+    }
+}
+
+/* SSE2 */
+
+INK_TARGET_SSE2 inline __m128i sse2_load(unsigned char const *p, int str2, int lines, int pc)
+{
+    __m128i bytes;
+    if (str2 == pc) {
+        bytes = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(p));
+    } else {
+        unsigned char buf[8];
+        gather(buf, p, str2, lines, pc);
+        bytes = _mm_loadl_epi64(reinterpret_cast<__m128i const *>(buf));
+    }
+    return _mm_unpacklo_epi8(bytes, _mm_setzero_si128());
+}
+
+INK_TARGET_SSE2 inline void sse2_store(unsigned char *p, int str2, int lines, int pc, __m128i v)
+{
+    __m128i bytes = _mm_packus_epi16(v, v);
+    if (str2 == pc) {
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(p), bytes);
+    } else {
+        unsigned char buf[8];
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(buf), bytes);
+        scatter(p, buf, str2, lines, pc);
+    }
+}
+
+INK_TARGET_SSE2 inline bool sse2_equal(__m128i a, __m128i b)
+{
+    return _mm_movemask_epi8(_mm_cmpeq_epi16(a, b)) == 0xFFFF;
+}
+
+INK_TARGET_SSE2 void fir_sse2(unsigned char *dst, int dstr1, int dstr2,
+                              unsigned char const *src, int sstr1, int sstr2,
+                              int n1, int pc, uint16_t const *kernel, int scr_len)
+{
+    int const lines = 8 / pc;
+    int const size = 2 * scr_len + 1;
+
+    // Source samples around the current position, oldest first. Every sample is stored
+    // twice, so that the window is contiguous. Values are 16 bits per channel.
+    __m128i window[2 * FIR_WINDOW_MAX];
+    __m128i weights[GaussianKernels::FIR_MAX_RADIUS + 1];
+    for (int i = 0; i <= scr_len; ++i) {
+        weights[i] = _mm_set1_epi16(static_cast<short>(kernel[i]));
+    }
+
+    // Position of the last sample which differs from the one before it;
+    // the window is flat when it is not after the oldest sample.
+    int last_change = -scr_len;
+    __m128i newest = sse2_load(src, sstr2, lines, pc);
+    int pos = 0;
+    for (int i = -scr_len; i <= scr_len; ++i) {
+        if (i > 0 && i < n1) {
+            __m128i s = sse2_load(src + i * sstr1, sstr2, lines, pc);
+            if (!sse2_equal(s, newest)) last_change = i;
+            newest = s;
+        }
+        window[pos] = window[pos + size] = newest;
+        pos = pos + 1 == size ? 0 : pos + 1;
+    }
+
+    __m128i const rounding = _mm_set1_epi32(1 << 15);
+    for (int c1 = 0; c1 < n1; ++c1) {
+        __m128i const *w = window + pos + scr_len;
+        __m128i result;
+        if (last_change <= c1 - scr_len) {
+            // blurring flat color does not change it
+            result = w[0];
+        } else {
+            __m128i acc_lo = rounding;
+            __m128i acc_hi = rounding;
+            for (int i = 0; i <= scr_len; ++i) {
+                // the kernel is symmetric, and sums of two samples still fit in 16 bits
+                __m128i x = i ? _mm_add_epi16(w[-i], w[i]) : w[0];
+                __m128i lo = _mm_mullo_epi16(x, weights[i]);
+                __m128i hi = _mm_mulhi_epu16(x, weights[i]);
+                acc_lo = _mm_add_epi32(acc_lo, _mm_unpacklo_epi16(lo, hi));
+                acc_hi = _mm_add_epi32(acc_hi, _mm_unpackhi_epi16(lo, hi));
+            }
+            result = _mm_packs_epi32(_mm_srli_epi32(acc_lo, 16), _mm_srli_epi32(acc_hi, 16));
+        }
+        sse2_store(dst + c1 * dstr1, dstr2, lines, pc, result);
+
+        // Advance the window. The sample read is ahead of the output, which makes
+        // in-place operation possible.
+        int next = c1 + scr_len + 1;
+        if (next < n1) {
+            __m128i s = sse2_load(src + next * sstr1, sstr2, lines, pc);
+            if (!sse2_equal(s, newest)) last_change = next;
+            newest = s;
+        }
+        window[pos] = window[pos + size] = newest;
+        pos = pos + 1 == size ? 0 : pos + 1;
+    }
+}
+
+INK_TARGET_SSE2 inline void sse2_load_pixel(unsigned char const *p, __m128d &lo, __m128d &hi)
+{
+    int32_t px;
+    std::memcpy(&px, p, 4);
+    __m128i const zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(px), zero), zero);
+    lo = _mm_cvtepi32_pd(v);
+    hi = _mm_cvtepi32_pd(_mm_srli_si128(v, 8));
+}
+
+// Same rounding and clamping as clip_round_cast() for alpha and
+// clip_round_cast_varmax() for the color channels.
+INK_TARGET_SSE2 inline void sse2_store_pixel(unsigned char *p, __m128d lo, __m128d hi)
+{
+    __m128d const zero = _mm_setzero_pd();
+    __m128d const half = _mm_set1_pd(0.5);
+    __m128d alpha = _mm_unpackhi_pd(hi, hi);
+    alpha = _mm_min_pd(_mm_max_pd(alpha, zero), _mm_set1_pd(255.0));
+    alpha = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_add_pd(alpha, half)));
+    lo = _mm_min_pd(_mm_max_pd(lo, zero), alpha);
+    hi = _mm_min_pd(_mm_max_pd(hi, zero), alpha);
+    __m128i v = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_add_pd(lo, half)),
+                                   _mm_cvttpd_epi32(_mm_add_pd(hi, half)));
+    v = _mm_packs_epi32(v, v);
+    v = _mm_packus_epi16(v, v);
+    int32_t px = _mm_cvtsi128_si32(v);
+    std::memcpy(p, &px, 4);
+}
+
+INK_TARGET_SSE2 void iir_forward_sse2(unsigned char const *src, int sstr1, int n1,
+                                      double const b[4], double *u, double *tmp)
+{
+    __m128d const b0 = _mm_set1_pd(b[0]);
+    __m128d const b1 = _mm_set1_pd(b[1]);
+    __m128d const b2 = _mm_set1_pd(b[2]);
+    __m128d const b3 = _mm_set1_pd(b[3]);
+    __m128d u1_lo = _mm_loadu_pd(u + 0), u1_hi = _mm_loadu_pd(u + 2);
+    __m128d u2_lo = _mm_loadu_pd(u + 4), u2_hi = _mm_loadu_pd(u + 6);
+    __m128d u3_lo = _mm_loadu_pd(u + 8), u3_hi = _mm_loadu_pd(u + 10);
+
+    for (int c1 = 0; c1 < n1; ++c1) {
+        __m128d x_lo, x_hi;
+        sse2_load_pixel(src + c1 * sstr1, x_lo, x_hi);
+        __m128d u0_lo = _mm_mul_pd(x_lo, b0);
+        __m128d u0_hi = _mm_mul_pd(x_hi, b0);
+        u0_lo = _mm_add_pd(u0_lo, _mm_mul_pd(u1_lo, b1));
+        u0_hi = _mm_add_pd(u0_hi, _mm_mul_pd(u1_hi, b1));
+        u0_lo = _mm_add_pd(u0_lo, _mm_mul_pd(u2_lo, b2));
+        u0_hi = _mm_add_pd(u0_hi, _mm_mul_pd(u2_hi, b2));
+        u0_lo = _mm_add_pd(u0_lo, _mm_mul_pd(u3_lo, b3));
+        u0_hi = _mm_add_pd(u0_hi, _mm_mul_pd(u3_hi, b3));
+        _mm_storeu_pd(tmp + c1 * 4, u0_lo);
+        _mm_storeu_pd(tmp + c1 * 4 + 2, u0_hi);
+        u3_lo = u2_lo; u3_hi = u2_hi;
+        u2_lo = u1_lo; u2_hi = u1_hi;
+        u1_lo = u0_lo; u1_hi = u0_hi;
+    }
+
+    _mm_storeu_pd(u + 0, u1_lo); _mm_storeu_pd(u + 2, u1_hi);
+    _mm_storeu_pd(u + 4, u2_lo); _mm_storeu_pd(u + 6, u2_hi);
+    _mm_storeu_pd(u + 8, u3_lo); _mm_storeu_pd(u + 10, u3_hi);
+}
+
+INK_TARGET_SSE2 void iir_backward_sse2(unsigned char *dst, int dstr1, int n1,
+                                       double const b[4], double *v, double const *tmp)
+{
+    __m128d const b0 = _mm_set1_pd(b[0]);
+    __m128d const b1 = _mm_set1_pd(b[1]);
+    __m128d const b2 = _mm_set1_pd(b[2]);
+    __m128d const b3 = _mm_set1_pd(b[3]);
+    __m128d v1_lo = _mm_loadu_pd(v + 0), v1_hi = _mm_loadu_pd(v + 2);
+    __m128d v2_lo = _mm_loadu_pd(v + 4), v2_hi = _mm_loadu_pd(v + 6);
+    __m128d v3_lo = _mm_loadu_pd(v + 8), v3_hi = _mm_loadu_pd(v + 10);
+
+    sse2_store_pixel(dst + (n1 - 1) * dstr1, v1_lo, v1_hi);
+    for (int c1 = n1 - 2; c1 >= 0; --c1) {
+        __m128d v0_lo = _mm_mul_pd(_mm_loadu_pd(tmp + c1 * 4), b0);
+        __m128d v0_hi = _mm_mul_pd(_mm_loadu_pd(tmp + c1 * 4 + 2), b0);
+        v0_lo = _mm_add_pd(v0_lo, _mm_mul_pd(v1_lo, b1));
+        v0_hi = _mm_add_pd(v0_hi, _mm_mul_pd(v1_hi, b1));
+        v0_lo = _mm_add_pd(v0_lo, _mm_mul_pd(v2_lo, b2));
+        v0_hi = _mm_add_pd(v0_hi, _mm_mul_pd(v2_hi, b2));
+        v0_lo = _mm_add_pd(v0_lo, _mm_mul_pd(v3_lo, b3));
+        v0_hi = _mm_add_pd(v0_hi, _mm_mul_pd(v3_hi, b3));
+        sse2_store_pixel(dst + c1 * dstr1, v0_lo, v0_hi);
+        v3_lo = v2_lo; v3_hi = v2_hi;
+        v2_lo = v1_lo; v2_hi = v1_hi;
+        v1_lo = v0_lo; v1_hi = v0_hi;
+    }
+}
+
+/* AVX2 */
+
+INK_TARGET_AVX2 inline __m256i avx2_load(unsigned char const *p, int str2, int lines, int pc)
+{
+    __m128i bytes;
+    if (str2 == pc) {
+        bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(p));
+    } else {
+        unsigned char buf[16];
+        gather(buf, p, str2, lines, pc);
+        bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(buf));
+    }
+    return _mm256_cvtepu8_epi16(bytes);
+}
+
+INK_TARGET_AVX2 inline void avx2_store(unsigned char *p, int str2, int lines, int pc, __m256i v)
+{
+    __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    if (str2 == pc) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(p), bytes);
+    } else {
+        unsigned char buf[16];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(buf), bytes);
+        scatter(p, buf, str2, lines, pc);
+    }
+}
+
+INK_TARGET_AVX2 inline bool avx2_equal(__m256i a, __m256i b)
+{
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi16(a, b)) == -1;
+}
+
+INK_TARGET_AVX2 void fir_avx2(unsigned char *dst, int dstr1, int dstr2,
+                              unsigned char const *src, int sstr1, int sstr2,
+                              int n1, int pc, uint16_t const *kernel, int scr_len)
+{
+    int const lines = 16 / pc;
+    int const size = 2 * scr_len + 1;
+
+    // see fir_sse2()
+    __m256i window[2 * FIR_WINDOW_MAX];
+    __m256i weights[GaussianKernels::FIR_MAX_RADIUS + 1];
+    for (int i = 0; i <= scr_len; ++i) {
+        weights[i] = _mm256_set1_epi16(static_cast<short>(kernel[i]));
+    }
+
+    int last_change = -scr_len;
+    __m256i newest = avx2_load(src, sstr2, lines, pc);
+    int pos = 0;
+    for (int i = -scr_len; i <= scr_len; ++i) {
+        if (i > 0 && i < n1) {
+            __m256i s = avx2_load(src + i * sstr1, sstr2, lines, pc);
+            if (!avx2_equal(s, newest)) last_change = i;
+            newest = s;
+        }
+        window[pos] = window[pos + size] = newest;
+        pos = pos + 1 == size ? 0 : pos + 1;
+    }
+
+    __m256i const rounding = _mm256_set1_epi32(1 << 15);
+    for (int c1 = 0; c1 < n1; ++c1) {
+        __m256i const *w = window + pos + scr_len;
+        __m256i result;
+        if (last_change <= c1 - scr_len) {
+            result = w[0];
+        } else {
+            __m256i acc_lo = rounding;
+            __m256i acc_hi = rounding;
+            for (int i = 0; i <= scr_len; ++i) {
+                __m256i x = i ? _mm256_add_epi16(w[-i], w[i]) : w[0];
+                __m256i lo = _mm256_mullo_epi16(x, weights[i]);
+                __m256i hi = _mm256_mulhi_epu16(x, weights[i]);
+                acc_lo = _mm256_add_epi32(acc_lo, _mm256_unpacklo_epi16(lo, hi));
+                acc_hi = _mm256_add_epi32(acc_hi, _mm256_unpackhi_epi16(lo, hi));
+            }
+            // unpacking and packing both work within 128-bit lanes, so the order is restored
+            result = _mm256_packs_epi32(_mm256_srli_epi32(acc_lo, 16), _mm256_srli_epi32(acc_hi, 16));
+        }
+        avx2_store(dst + c1 * dstr1, dstr2, lines, pc, result);
+
+        int next = c1 + scr_len + 1;
+        if (next < n1) {
+            __m256i s = avx2_load(src + next * sstr1, sstr2, lines, pc);
+            if (!avx2_equal(s, newest)) last_change = next;
+            newest = s;
+        }
+        window[pos] = window[pos + size] = newest;
+        pos = pos + 1 == size ? 0 : pos + 1;
+    }
+}
+
+INK_TARGET_AVX2 inline __m256d avx2_load_pixel(unsigned char const *p)
+{
+    int32_t px;
+    std::memcpy(&px, p, 4);
+    return _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(px)));
+}
+
+// see sse2_store_pixel()
+INK_TARGET_AVX2 inline void avx2_store_pixel(unsigned char *p, __m256d v)
+{
+    __m256d const zero = _mm256_setzero_pd();
+    __m256d const half = _mm256_set1_pd(0.5);
+    __m256d alpha = _mm256_permute4x64_pd(v, 0xFF);
+    alpha = _mm256_min_pd(_mm256_max_pd(alpha, zero), _mm256_set1_pd(255.0));
+    alpha = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_add_pd(alpha, half)));
+    v = _mm256_min_pd(_mm256_max_pd(v, zero), alpha);
+    __m128i i = _mm256_cvttpd_epi32(_mm256_add_pd(v, half));
+    i = _mm_packs_epi32(i, i);
+    i = _mm_packus_epi16(i, i);
+    int32_t px = _mm_cvtsi128_si32(i);
+    std::memcpy(p, &px, 4);
+}
+
+INK_TARGET_AVX2 void iir_forward_avx2(unsigned char const *src, int sstr1, int n1,
+                                      double const b[4], double *u, double *tmp)
+{
+    __m256d const b0 = _mm256_set1_pd(b[0]);
+    __m256d const b1 = _mm256_set1_pd(b[1]);
+    __m256d const b2 = _mm256_set1_pd(b[2]);
+    __m256d const b3 = _mm256_set1_pd(b[3]);
+    __m256d u1 = _mm256_loadu_pd(u + 0);
+    __m256d u2 = _mm256_loadu_pd(u + 4);
+    __m256d u3 = _mm256_loadu_pd(u + 8);
+
+    for (int c1 = 0; c1 < n1; ++c1) {
+        __m256d u0 = _mm256_mul_pd(avx2_load_pixel(src + c1 * sstr1), b0);
+        u0 = _mm256_add_pd(u0, _mm256_mul_pd(u1, b1));
+        u0 = _mm256_add_pd(u0, _mm256_mul_pd(u2, b2));
+        u0 = _mm256_add_pd(u0, _mm256_mul_pd(u3, b3));
+        _mm256_storeu_pd(tmp + c1 * 4, u0);
+        u3 = u2;
+        u2 = u1;
+        u1 = u0;
+    }
+
+    _mm256_storeu_pd(u + 0, u1);
+    _mm256_storeu_pd(u + 4, u2);
+    _mm256_storeu_pd(u + 8, u3);
+}
+
+INK_TARGET_AVX2 void iir_backward_avx2(unsigned char *dst, int dstr1, int n1,
+                                       double const b[4], double *v, double const *tmp)
+{
+    __m256d const b0 = _mm256_set1_pd(b[0]);
+    __m256d const b1 = _mm256_set1_pd(b[1]);
+    __m256d const b2 = _mm256_set1_pd(b[2]);
+    __m256d const b3 = _mm256_set1_pd(b[3]);
+    __m256d v1 = _mm256_loadu_pd(v + 0);
+    __m256d v2 = _mm256_loadu_pd(v + 4);
+    __m256d v3 = _mm256_loadu_pd(v + 8);
+
+    avx2_store_pixel(dst + (n1 - 1) * dstr1, v1);
+    for (int c1 = n1 - 2; c1 >= 0; --c1) {
+        __m256d v0 = _mm256_mul_pd(_mm256_loadu_pd(tmp + c1 * 4), b0);
+        v0 = _mm256_add_pd(v0, _mm256_mul_pd(v1, b1));
+        v0 = _mm256_add_pd(v0, _mm256_mul_pd(v2, b2));
+        v0 = _mm256_add_pd(v0, _mm256_mul_pd(v3, b3));
+        avx2_store_pixel(dst + c1 * dstr1, v0);
+        v3 = v2;
+        v2 = v1;
+        v1 = v0;
+    }
+}
+
+GaussianKernels const sse2_kernels = { "SSE2", 8, fir_sse2, iir_forward_sse2, iir_backward_sse2 };
+GaussianKernels const avx2_kernels = { "AVX2", 16, fir_avx2, iir_forward_avx2, iir_backward_avx2 };
+
+GaussianKernels const *detect_kernels()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return &avx2_kernels;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return &sse2_kernels;
+    }
+    return nullptr;
+}
+
+} // anonymous namespace
+
+#endif // INK_GAUSSIAN_SIMD
+
+GaussianKernels const *gaussian_simd_kernels()
+{
+#if INK_GAUSSIAN_SIMD
+    static GaussianKernels const *const kernels = detect_kernels();
+    return kernels;
+#else
+    return nullptr;
+#endif
+}
+
+} /* namespace Filters */
+} /* namespace Inkscape */
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
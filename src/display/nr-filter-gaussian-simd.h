@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_NR_FILTER_GAUSSIAN_SIMD_H
+#define SEEN_NR_FILTER_GAUSSIAN_SIMD_H
+
+/*
+ * Vectorized inner loops of the Gaussian blur renderer
+ *
+ * Copyright (C) 2020 authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+
+namespace Inkscape {
+namespace Filters {
+
+/**
+ * Set of vectorized kernels for one instruction set.
+ * All kernels produce exactly the same output as the scalar code in nr-filter-gaussian.cpp.
+ */
+struct GaussianKernels {
+    /// Largest FIR kernel radius supported by fir().
+    static int const FIR_MAX_RADIUS = 31;
+
+    char const *name;
+
+    /// Number of 8-bit channels processed at once by fir(); it processes fir_width / pc lines.
+    int fir_width;
+
+    /**
+     * FIR pass over a block of fir_width / pc adjacent lines of 8-bit data with pc channels.
+     * The kernel is symmetric, has scr_len + 1 elements and is in 0.16 fixed point.
+     * Can operate in place.
+     */
+    void (*fir)(unsigned char *dst, int dstr1, int dstr2,
+                unsigned char const *src, int sstr1, int sstr2,
+                int n1, int pc, uint16_t const *kernel, int scr_len);
+
+    /**
+     * Forward IIR pass over one line of premultiplied ARGB32 pixels.
+     * @param u Filter state, laid out as double[4][4]; its first 3 rows are read on entry
+     *          and replaced by the final state on exit.
+     * @param tmp Receives the n1 * 4 intermediate values.
+     */
+    void (*iir_forward)(unsigned char const *src, int sstr1, int n1,
+                        double const b[4], double *u, double *tmp);
+
+    /**
+     * Backward IIR pass over one line of premultiplied ARGB32 pixels, writing the result.
+     * @param v Filter state, laid out as double[4][4]; the first 3 rows must be initialized.
+     */
+    void (*iir_backward)(unsigned char *dst, int dstr1, int n1,
+                         double const b[4], double *v, double const *tmp);
+};
+
+/**
+ * Returns the kernels for the best instruction set supported by the processor,
+ * or NULL if no vectorized implementation is available.
+ */
+GaussianKernels const *gaussian_simd_kernels();
+
+} /* namespace Filters */
+} /* namespace Inkscape */
+
+#endif /* SEEN_NR_FILTER_GAUSSIAN_SIMD_H */
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
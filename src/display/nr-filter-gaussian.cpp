@@ -22,13 +22,16 @@
 #include <cstdlib>
 #include <glib.h>
 #include <limits>
+#include <vector>
 #if HAVE_OPENMP
 #include <omp.h>
 #endif //HAVE_OPENMP
 
 #include "display/cairo-utils.h"
+#include "display/drawing-render-thread.h"
 #include "display/nr-filter-primitive.h"
 #include "display/nr-filter-gaussian.h"
+#include "display/nr-filter-gaussian-simd.h"
 #include "display/nr-filter-types.h"
 #include "display/nr-filter-units.h"
 #include "display/nr-filter-slot.h"
@@ -307,6 +310,12 @@ filter2D_IIR(PT *const dest, int const dstr1, int const dstr2,
     #define PREMUL_ALPHA_LOOP for(unsigned int c=1; c<PC; ++c)
 #endif
 
+    // The vectorized kernels only handle premultiplied 8-bit ARGB
+    GaussianKernels const *simd = nullptr;
+    if (PC == 4 && PREMULTIPLIED_ALPHA && sizeof(PT) == 1 && sizeof(IIRValue) == sizeof(double) && N == 3) {
+        simd = gaussian_simd_kernels();
+    }
+
 INK_UNUSED(num_threads); // to suppress unused argument compiler warning
 #if HAVE_OPENMP
 #pragma omp parallel for num_threads(num_threads)
@@ -326,6 +335,13 @@ INK_UNUSED(num_threads); // to suppress unused argument compiler warning
         // Forward pass
         IIRValue u[N+1][PC];
         for(unsigned int i=0; i<N; i++) copy_n(imin, PC, u[i]);
+        if (simd) {
+            simd->iir_forward(reinterpret_cast<unsigned char const *>(srcimg), sstr1, n1, b, &u[0][0], tmpdata[tid]);
+            IIRValue v[N+1][PC];
+            calcTriggsSdikaInitialization<PC>(M, u, iplus, iplus, b[0], v);
+            simd->iir_backward(reinterpret_cast<unsigned char *>(dest + c2*dstr2), dstr1, n1, b, &v[0][0], tmpdata[tid]);
+            continue;
+        }
         for ( int c1 = 0 ; c1 < n1 ; c1++ ) {
             for(unsigned int i=N; i>0; i--) copy_n(u[i-1], PC, u[i]);
             copy_n(srcimg, PC, u[0]);
@@ -471,6 +487,49 @@ INK_UNUSED(num_threads); // suppresses unused argument compiler warning
     }
 }
 
+// Applies the vectorized FIR kernel to as many lines as possible
+// and returns their number; the remaining lines are left to filter2D_FIR.
+static int
+filter2D_FIR_simd(unsigned char *const dst, int const dstr1, int const dstr2,
+                  unsigned char const *const src, int const sstr1, int const sstr2,
+                  int const n1, int const n2, int const pc, FIRValue const *const kernel, int const scr_len,
+                  int const num_threads)
+{
+    GaussianKernels const *simd = gaussian_simd_kernels();
+    if (!simd || scr_len > GaussianKernels::FIR_MAX_RADIUS) return 0;
+
+    // the vector code multiplies 16-bit values, so it cannot use a coefficient of exactly 1
+    std::vector<uint16_t> kernel16(scr_len + 1);
+    for (int i = 0; i <= scr_len; ++i) {
+        double raw = std::ldexp(static_cast<double>(kernel[i]), 16);
+        if (raw > 0xFFFF) return 0;
+        kernel16[i] = static_cast<uint16_t>(raw);
+    }
+
+    int const lines = simd->fir_width / pc;
+    int const blocks = n2 / lines;
+
+INK_UNUSED(num_threads); // suppresses unused argument compiler warning
+#if HAVE_OPENMP
+#pragma omp parallel for num_threads(num_threads)
+#endif // HAVE_OPENMP
+    for (int i = 0; i < blocks; ++i) {
+        simd->fir(dst + i * lines * dstr2, dstr1, dstr2, src + i * lines * sstr2, sstr1, sstr2,
+                  n1, pc, &kernel16[0], scr_len);
+    }
+    return blocks * lines;
+}
+
+// Lines filtered between two checkpoints of a background rendering job.
+static int const CHECKPOINT_LINES = 64;
+
+// Number of lines to filter at once, out of @a n lines.
+static int
+checkpoint_lines(int n)
+{
+    return Inkscape::DrawingRenderThread::current() ? CHECKPOINT_LINES : std::max(n, 1);
+}
+
 static void
 gaussian_pass_IIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_surface_t *dest,
     IIRValue **tmpdata, int num_threads)
@@ -497,20 +556,36 @@ gaussian_pass_IIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_su
     int h = cairo_image_surface_get_height(src);
     if (d != Geom::X) std::swap(w, h);
 
+    unsigned char *dest_data = cairo_image_surface_get_data(dest);
+    unsigned char *src_data = cairo_image_surface_get_data(src);
+    int const block = checkpoint_lines(h);
+
     // Filter
     switch (cairo_image_surface_get_format(src)) {
-    case CAIRO_FORMAT_A8:        ///< Grayscale
-        filter2D_IIR<unsigned char,1,false>(
-            cairo_image_surface_get_data(dest), d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
-            cairo_image_surface_get_data(src),  d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
-            w, h, b, M, tmpdata, num_threads);
+    case CAIRO_FORMAT_A8: {      ///< Grayscale
+        int const str1 = d == Geom::X ? 1 : stride;
+        int const str2 = d == Geom::X ? stride : 1;
+        for (int start = 0; start < h; start += block) {
+            Inkscape::DrawingRenderThread::checkpoint();
+            filter2D_IIR<unsigned char,1,false>(
+                dest_data + start * str2, str1, str2,
+                src_data + start * str2, str1, str2,
+                w, std::min(block, h - start), b, M, tmpdata, num_threads);
+        }
         break;
-    case CAIRO_FORMAT_ARGB32: ///< Premultiplied 8 bit RGBA
-        filter2D_IIR<unsigned char,4,true>(
-            cairo_image_surface_get_data(dest), d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
-            cairo_image_surface_get_data(src),  d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
-            w, h, b, M, tmpdata, num_threads);
+    }
+    case CAIRO_FORMAT_ARGB32: {  ///< Premultiplied 8 bit RGBA
+        int const str1 = d == Geom::X ? 4 : stride;
+        int const str2 = d == Geom::X ? stride : 4;
+        for (int start = 0; start < h; start += block) {
+            Inkscape::DrawingRenderThread::checkpoint();
+            filter2D_IIR<unsigned char,4,true>(
+                dest_data + start * str2, str1, str2,
+                src_data + start * str2, str1, str2,
+                w, std::min(block, h - start), b, M, tmpdata, num_threads);
+        }
         break;
+    }
     default:
         g_warning("gaussian_pass_IIR: unsupported image format");
     };
@@ -530,20 +605,47 @@ gaussian_pass_FIR(Geom::Dim2 d, double deviation, cairo_surface_t *src, cairo_su
     int h = cairo_image_surface_get_height(src);
     if (d != Geom::X) std::swap(w, h);
 
+    unsigned char *dest_data = cairo_image_surface_get_data(dest);
+    unsigned char *src_data = cairo_image_surface_get_data(src);
+
+    int const block = checkpoint_lines(h);
+
     // Filter (x)
     switch (cairo_image_surface_get_format(src)) {
-    case CAIRO_FORMAT_A8:        ///< Grayscale
-        filter2D_FIR<unsigned char,1>(
-            cairo_image_surface_get_data(dest), d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
-            cairo_image_surface_get_data(src),  d == Geom::X ? 1 : stride, d == Geom::X ? stride : 1,
-            w, h, &kernel[0], scr_len, num_threads);
+    case CAIRO_FORMAT_A8: {      ///< Grayscale
+        int const str1 = d == Geom::X ? 1 : stride;
+        int const str2 = d == Geom::X ? stride : 1;
+        for (int start = 0; start < h; start += block) {
+            Inkscape::DrawingRenderThread::checkpoint();
+            unsigned char *dest_block = dest_data + start * str2;
+            unsigned char *src_block = src_data + start * str2;
+            int const lines = std::min(block, h - start);
+            int done = filter2D_FIR_simd(dest_block, str1, str2, src_block, str1, str2,
+                                         w, lines, 1, &kernel[0], scr_len, num_threads);
+            filter2D_FIR<unsigned char,1>(
+                dest_block + done * str2, str1, str2,
+                src_block + done * str2, str1, str2,
+                w, lines - done, &kernel[0], scr_len, num_threads);
+        }
         break;
-    case CAIRO_FORMAT_ARGB32: ///< Premultiplied 8 bit RGBA
-        filter2D_FIR<unsigned char,4>(
-            cairo_image_surface_get_data(dest), d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
-            cairo_image_surface_get_data(src),  d == Geom::X ? 4 : stride, d == Geom::X ? stride : 4,
-            w, h, &kernel[0], scr_len, num_threads);
+    }
+    case CAIRO_FORMAT_ARGB32: {  ///< Premultiplied 8 bit RGBA
+        int const str1 = d == Geom::X ? 4 : stride;
+        int const str2 = d == Geom::X ? stride : 4;
+        for (int start = 0; start < h; start += block) {
+            Inkscape::DrawingRenderThread::checkpoint();
+            unsigned char *dest_block = dest_data + start * str2;
+            unsigned char *src_block = src_data + start * str2;
+            int const lines = std::min(block, h - start);
+            int done = filter2D_FIR_simd(dest_block, str1, str2, src_block, str1, str2,
+                                         w, lines, 4, &kernel[0], scr_len, num_threads);
+            filter2D_FIR<unsigned char,4>(
+                dest_block + done * str2, str1, str2,
+                src_block + done * str2, str1, str2,
+                w, lines - done, &kernel[0], scr_len, num_threads);
+        }
         break;
+    }
     default:
         g_warning("gaussian_pass_FIR: unsupported image format");
     };
@@ -632,11 +734,15 @@ void FilterGaussian::render_cairo(FilterSlot &slot)
 
     // Temporary storage for IIR filter
     // NOTE: This can be eliminated, but it reduces the precision a bit
+    // (held in vectors, so that it is freed when a background rendering job is cancelled)
+    std::vector<std::vector<IIRValue>> tmpstorage;
     IIRValue * tmpdata[threads];
     std::fill_n(tmpdata, threads, (IIRValue*)0);
     if ( use_IIR_x || use_IIR_y ) {
+        tmpstorage.resize(threads);
         for(int i = 0; i < threads; ++i) {
-            tmpdata[i] = new IIRValue[std::max(w_downsampled,h_downsampled)*bytes_per_pixel];
+            tmpstorage[i].resize(std::max(w_downsampled,h_downsampled)*bytes_per_pixel);
+            tmpdata[i] = &tmpstorage[i][0];
         }
     }
 
@@ -654,6 +760,7 @@ void FilterGaussian::render_cairo(FilterSlot &slot)
     } else {
         downsampled = ink_cairo_surface_copy(in);
     }
+    CairoSurfaceRelease release_downsampled(downsampled);
     cairo_surface_flush(downsampled);
 
     if (scr_len_x > 0) {
@@ -672,13 +779,6 @@ void FilterGaussian::render_cairo(FilterSlot &slot)
         }
     }
 
-    // free the temporary data
-    if ( use_IIR_x || use_IIR_y ) {
-        for(int i = 0; i < threads; ++i) {
-            delete[] tmpdata[i];
-        }
-    }
-
     cairo_surface_mark_dirty(downsampled);
     if (resampling) {
         cairo_surface_t *upsampled = cairo_surface_create_similar(downsampled, cairo_surface_get_content(downsampled),
@@ -693,12 +793,10 @@ void FilterGaussian::render_cairo(FilterSlot &slot)
 
         slot.set(_output, upsampled);
         cairo_surface_destroy(upsampled);
-        cairo_surface_destroy(downsampled);
     } else {
         set_cairo_surface_ci( downsampled, ci_fp );
 
         slot.set(_output, downsampled);
-        cairo_surface_destroy(downsampled);
     }
 }
 
@@ -11,6 +11,8 @@
  *
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
+#include <mutex>
+
 #include "display/nr-filter-image.h"
 #include "document.h"
 #include "object/sp-item.h"
@@ -52,6 +54,11 @@ void FilterImage::render_cairo(FilterSlot &slot)
     if (!feImageHref)
         return;
 
+    // Loads the image and shows referenced items on first use; filters can be
+    // rendered from several threads at once (see Drawing::renderThreaded).
+    static std::mutex image_mutex;
+    std::lock_guard<std::mutex> lock(image_mutex);
+
     //cairo_surface_t *input = slot.getcairo(_input);
 
     // Viewport is filter primitive area (in user coordinates).
@@ -33,6 +33,7 @@ public:
     void render_cairo(FilterSlot &slot) override;
     bool can_handle_affine(Geom::Affine const &) override;
     double complexity(Geom::Affine const &ctm) override;
+    bool can_cache() override { return false; } // depends on other document content
 
     void set_document( SPDocument *document );
     void set_href(char const *href);
@@ -182,6 +182,7 @@ void FilterMorphology::render_cairo(FilterSlot &slot)
     int bpp = cairo_image_surface_get_format(input) == CAIRO_FORMAT_A8 ? 1 : 4;
 
     cairo_surface_t *interm = ink_cairo_surface_create_identical(input);
+    CairoSurfaceRelease release_interm(interm);
 
     if (Operator == MORPHOLOGY_OPERATOR_DILATE) {
         if (bpp == 1) {
@@ -197,7 +198,10 @@ void FilterMorphology::render_cairo(FilterSlot &slot)
         }
     }
 
+    DrawingRenderThread::checkpoint();
+
     cairo_surface_t *out = ink_cairo_surface_create_identical(interm);
+    CairoSurfaceRelease release_out(out);
 
     // color_interpolation_filters for out same as input. See spec (DisplacementMap).
     copy_cairo_surface_ci(input, out);
@@ -216,10 +220,7 @@ void FilterMorphology::render_cairo(FilterSlot &slot)
         }
     }
 
-    cairo_surface_destroy(interm);
-
     slot.set(_output, out);
-    cairo_surface_destroy(out);
 }
 
 void FilterMorphology::area_enlarge(Geom::IntRect &area, Geom::Affine const &trans)
@@ -73,6 +73,10 @@ public:
     // this should return how many times slower this primitive is that normal rendering
     virtual double complexity(Geom::Affine const &/*ctm*/) { return 1.0; }
 
+    // says whether the result depends only on the input slots, the primitive parameters,
+    // the filter units and the rendering quality, so that it can be reused from the cache
+    virtual bool can_cache() { return true; }
+
     virtual bool uses_background() {
         if (_input == NR_FILTER_BACKGROUNDIMAGE || _input == NR_FILTER_BACKGROUNDALPHA) {
             return true;
@@ -0,0 +1,214 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Cache of filter primitive results
+ *
+ * Copyright (C) 2020 authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <atomic>
+#include <cstring>
+#include <cairo.h>
+
+#include "display/cairo-utils.h"
+#include "display/nr-filter-result-cache.h"
+
+namespace Inkscape {
+namespace Filters {
+
+FilterResultCache &FilterResultCache::get()
+{
+    static FilterResultCache instance;
+    return instance;
+}
+
+FilterResultCache::FilterResultCache()
+    : _budget(0)
+    , _used(0)
+{}
+
+FilterResultCache::~FilterResultCache()
+{
+    for (auto &entry : _entries) {
+        cairo_surface_destroy(entry.surface);
+    }
+}
+
+void FilterResultCache::setBudget(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _budget = bytes;
+    _evict();
+}
+
+/**
+ * Returns a new copy of the stored image, or NULL if there is no entry for the key.
+ * The caller owns the returned surface.
+ */
+cairo_surface_t *FilterResultCache::lookup(Filter const *filter, Key const &key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto found = _index.find(IndexKey(filter, key.hash));
+    if (found == _index.end() || found->second->key != key) return nullptr;
+
+    _entries.splice(_entries.begin(), _entries, found->second);
+    return ink_cairo_surface_copy(found->second->surface);
+}
+
+/**
+ * Stores a copy of the given image. The surface is not referenced, so the caller
+ * may continue to modify it.
+ */
+void FilterResultCache::store(Filter const *filter, Key const &key, cairo_surface_t *surface)
+{
+    if (cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) return;
+
+    size_t size = size_t(cairo_image_surface_get_stride(surface)) * cairo_image_surface_get_height(surface);
+    if (size > _budget) return;
+
+    cairo_surface_t *copy = ink_cairo_surface_copy(surface);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (size > _budget) {
+        // the budget was lowered while copying
+        cairo_surface_destroy(copy);
+        return;
+    }
+
+    IndexKey k(filter, key.hash);
+    auto existing = _index.find(k);
+    if (existing != _index.end()) {
+        // the same key, or another one with the same hash
+        _erase(existing->second);
+    }
+
+    Entry entry = { k, key, copy, size };
+    _entries.push_front(entry);
+    _index[k] = _entries.begin();
+    _used += size;
+    _evict();
+}
+
+/// Discard all results of the given filter.
+void FilterResultCache::drop(Filter const *filter)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    auto i = _index.lower_bound(IndexKey(filter, 0));
+    while (i != _index.end() && i->first.first == filter) {
+        auto next = i;
+        ++next;
+        _erase(i->second);
+        i = next;
+    }
+}
+
+void FilterResultCache::Key::add(uint64_t value)
+{
+    values.push_back(value);
+    hash = FilterResultCache::hash(hash, value);
+}
+
+void FilterResultCache::Key::add_double(double value)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add(bits);
+}
+
+/// Mix a value into a hash.
+uint64_t FilterResultCache::hash(uint64_t seed, uint64_t value)
+{
+    // finalizer of the SplitMix64 generator
+    uint64_t z = value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return seed ^ z ^ (z >> 31);
+}
+
+/**
+ * Compute a hash of the pixel data, dimensions, format and color interpolation
+ * of a surface. Surfaces whose data cannot be accessed get a unique value.
+ */
+uint64_t FilterResultCache::hash_surface(cairo_surface_t *surface)
+{
+    static std::atomic<uint64_t> unique(0);
+
+    if (cairo_surface_get_type(surface) != CAIRO_SURFACE_TYPE_IMAGE) {
+        return hash(0x5ca1ab1eULL, unique++);
+    }
+
+    cairo_surface_flush(surface);
+    unsigned char const *data = cairo_image_surface_get_data(surface);
+    int w = cairo_image_surface_get_width(surface);
+    int h = cairo_image_surface_get_height(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    cairo_format_t format = cairo_image_surface_get_format(surface);
+    if (!data) {
+        return hash(0x5ca1ab1eULL, unique++);
+    }
+
+    uint64_t result = hash(hash(hash(w, h), format), get_cairo_surface_ci(surface));
+    size_t row_bytes = format == CAIRO_FORMAT_A8 ? w : size_t(w) * 4;
+
+    for (int y = 0; y < h; ++y) {
+        unsigned char const *row = data + size_t(y) * stride;
+        size_t i = 0;
+        // hash four words at a time into independent lanes, so that the multiplications overlap
+        uint64_t lane[4] = { result, ~result, result + 1, result - 1 };
+        for (; i + 32 <= row_bytes; i += 32) {
+            for (int k = 0; k < 4; ++k) {
+                uint64_t word;
+                std::memcpy(&word, row + i + 8 * k, sizeof(word));
+                lane[k] = (lane[k] ^ word) * 0x100000001b3ULL;
+                lane[k] ^= lane[k] >> 29;
+            }
+        }
+        for (int k = 0; k < 4; ++k) {
+            result = hash(result, lane[k]);
+        }
+        uint64_t tail = 0;
+        for (; i < row_bytes; ++i) {
+            tail = (tail << 8) | row[i];
+            if ((i & 7) == 7) {
+                result = hash(result, tail);
+                tail = 0;
+            }
+        }
+        result = hash(result, tail);
+    }
+    return result;
+}
+
+void FilterResultCache::_erase(EntryList::iterator i)
+{
+    _used -= i->size;
+    _index.erase(i->index_key);
+    cairo_surface_destroy(i->surface);
+    _entries.erase(i);
+}
+
+void FilterResultCache::_evict()
+{
+    while (_used > _budget && !_entries.empty()) {
+        auto last = _entries.end();
+        --last;
+        _erase(last);
+    }
+}
+
+} /* namespace Filters */
+} /* namespace Inkscape */
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
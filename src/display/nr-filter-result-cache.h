@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_NR_FILTER_RESULT_CACHE_H
+#define SEEN_NR_FILTER_RESULT_CACHE_H
+
+/*
+ * Cache of filter primitive results
+ *
+ * Copyright (C) 2020 authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+extern "C" {
+typedef struct _cairo_surface cairo_surface_t;
+}
+
+namespace Inkscape {
+namespace Filters {
+
+class Filter;
+
+/**
+ * Process-wide store of the images produced by individual filter primitives.
+ *
+ * Entries belong to a filter and are identified by a key made by the filter from
+ * everything the primitive output depends on. Entries are found through the hash of the key,
+ * and the whole key is compared on lookups, so that a collision of the hashes is a cache miss
+ * rather than the result of another primitive. Surfaces are copied on the way in and out,
+ * since filter primitives modify their inputs in place. When the memory budget is exceeded,
+ * the least recently used entries are discarded first. The budget is zero, which disables
+ * the cache, until it is set.
+ *
+ * All methods can be called from several rendering threads at once.
+ */
+class FilterResultCache {
+public:
+    /// The values a result depends on, in the order they were added, and their hash.
+    struct Key {
+        Key() : hash(0) {}
+        void add(uint64_t value);
+        void add_double(double value);
+        bool operator==(Key const &other) const { return hash == other.hash && values == other.values; }
+        bool operator!=(Key const &other) const { return !(*this == other); }
+
+        uint64_t hash;
+        std::vector<uint64_t> values;
+    };
+
+    static FilterResultCache &get();
+
+    size_t budget() const { return _budget; }
+    void setBudget(size_t bytes);
+    /// Whether results are stored at all; filters do not compute keys otherwise.
+    bool enabled() const { return _budget > 0; }
+
+    cairo_surface_t *lookup(Filter const *filter, Key const &key);
+    void store(Filter const *filter, Key const &key, cairo_surface_t *surface);
+    void drop(Filter const *filter);
+
+    static uint64_t hash(uint64_t seed, uint64_t value);
+    static uint64_t hash_surface(cairo_surface_t *surface);
+
+private:
+    FilterResultCache();
+    ~FilterResultCache();
+    FilterResultCache(FilterResultCache const &) = delete;
+    FilterResultCache &operator=(FilterResultCache const &) = delete;
+
+    typedef std::pair<Filter const *, uint64_t> IndexKey;
+    struct Entry {
+        IndexKey index_key;
+        Key key;
+        cairo_surface_t *surface;
+        size_t size;
+    };
+    typedef std::list<Entry> EntryList;
+
+    void _erase(EntryList::iterator i);
+    void _evict();
+
+    std::mutex _mutex;
+    EntryList _entries; ///< most recently used first
+    std::map<IndexKey, EntryList::iterator> _index;
+    std::atomic<size_t> _budget; ///< changed under _mutex, but read without it to skip work
+    size_t _used;
+};
+
+} /* namespace Filters */
+} /* namespace Inkscape */
+
+#endif /* SEEN_NR_FILTER_RESULT_CACHE_H */
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -20,6 +20,7 @@
 #include "display/drawing-context.h"
 #include "display/nr-filter-types.h"
 #include "display/nr-filter-gaussian.h"
+#include "display/nr-filter-result-cache.h"
 #include "display/nr-filter-slot.h"
 #include "display/nr-filter-units.h"
 
@@ -28,7 +29,8 @@ namespace Filters {
 
 FilterSlot::FilterSlot(DrawingItem *item, DrawingContext *bgdc,
         DrawingContext &graphic, FilterUnits const &u)
-    : _item(item)
+    : _recording(false)
+    , _item(item)
     , _source_graphic(graphic.rawTarget())
     , _background_ct(bgdc ? bgdc->raw() : nullptr)
     , _source_graphic_area(graphic.targetLogicalBounds().roundOutwards()) // fixme
@@ -69,6 +71,26 @@ cairo_surface_t *FilterSlot::getcairo(int slot_nr)
     if (slot_nr == NR_FILTER_SLOT_NOT_SET)
         slot_nr = _last_out;
 
+    cairo_surface_t *surface = _get_internal(slot_nr);
+
+    if (_recording) {
+        bool seen = false;
+        for (auto &input : _record.inputs) {
+            if (input.slot == slot_nr) seen = true;
+        }
+        if (!seen) {
+            Record::Input input = { slot_nr, content_key(slot_nr), 0 };
+            _record.inputs.push_back(input);
+            // keep the input alive in case the primitive replaces it
+            cairo_surface_reference(surface);
+            _record_surfaces.push_back(surface);
+        }
+    }
+    return surface;
+}
+
+cairo_surface_t *FilterSlot::_get_internal(int slot_nr)
+{
     SlotMap::iterator s = _slots.find(slot_nr);
 
     /* If we didn't have the specified image, but we could create it
@@ -97,13 +119,13 @@ cairo_surface_t *FilterSlot::getcairo(int slot_nr)
                 cairo_surface_destroy(bg);
             } break;
             case NR_FILTER_SOURCEALPHA: {
-                cairo_surface_t *src = getcairo(NR_FILTER_SOURCEGRAPHIC);
+                cairo_surface_t *src = _get_internal(NR_FILTER_SOURCEGRAPHIC);
                 cairo_surface_t *alpha = ink_cairo_extract_alpha(src);
                 _set_internal(NR_FILTER_SOURCEALPHA, alpha);
                 cairo_surface_destroy(alpha);
             } break;
             case NR_FILTER_BACKGROUNDALPHA: {
-                cairo_surface_t *src = getcairo(NR_FILTER_BACKGROUNDIMAGE);
+                cairo_surface_t *src = _get_internal(NR_FILTER_BACKGROUNDIMAGE);
                 cairo_surface_t *ba = ink_cairo_extract_alpha(src);
                 _set_internal(NR_FILTER_BACKGROUNDALPHA, ba);
                 cairo_surface_destroy(ba);
@@ -220,6 +242,7 @@ void FilterSlot::_set_internal(int slot_nr, cairo_surface_t *surface)
     }
 
     _slots[slot_nr] = surface;
+    _content_keys.erase(slot_nr);
 }
 
 void FilterSlot::set(int slot_nr, cairo_surface_t *surface)
@@ -231,6 +254,10 @@ void FilterSlot::set(int slot_nr, cairo_surface_t *surface)
 
     _set_internal(slot_nr, surface);
     _last_out = slot_nr;
+
+    if (_recording) {
+        _record.output = slot_nr;
+    }
 }
 
 void FilterSlot::set_primitive_area(int slot_nr, Geom::Rect &area)
@@ -239,6 +266,10 @@ void FilterSlot::set_primitive_area(int slot_nr, Geom::Rect &area)
         slot_nr = NR_FILTER_UNNAMED_SLOT;
 
     _primitiveAreas[slot_nr] = area;
+
+    if (_recording) {
+        _record.areas.emplace_back(slot_nr, area);
+    }
 }
 
 Geom::Rect FilterSlot::get_primitive_area(int slot_nr)
@@ -286,6 +317,68 @@ Geom::Rect FilterSlot::get_slot_area() const {
     return r;
 }
 
+void FilterSlot::begin_record()
+{
+    _record = Record();
+    _recording = true;
+}
+
+FilterSlot::Record FilterSlot::end_record()
+{
+    _recording = false;
+
+    // Primitives convert the color interpolation of their inputs in place;
+    // remember the final state so that replay() can do the same.
+    cairo_surface_t *output = nullptr;
+    if (_record.output != NR_FILTER_SLOT_NOT_SET) {
+        output = _slots[_record.output];
+    }
+    for (size_t i = 0; i < _record.inputs.size(); ++i) {
+        _record.inputs[i].ci = get_cairo_surface_ci(_record_surfaces[i]);
+        if (_record_surfaces[i] == output) {
+            _record.reuses_input = true;
+        }
+        cairo_surface_destroy(_record_surfaces[i]);
+    }
+    _record_surfaces.clear();
+
+    Record result;
+    std::swap(result, _record);
+    return result;
+}
+
+void FilterSlot::replay(Record const &record, cairo_surface_t *result)
+{
+    for (auto &input : record.inputs) {
+        set_cairo_surface_ci(_get_internal(input.slot), (SPColorInterpolation) input.ci);
+    }
+    for (auto &area : record.areas) {
+        _primitiveAreas[area.first] = area.second;
+    }
+    _set_internal(record.output, result);
+    _last_out = record.output;
+}
+
+uint64_t FilterSlot::content_key(int slot_nr)
+{
+    if (slot_nr == NR_FILTER_SLOT_NOT_SET)
+        slot_nr = _last_out;
+
+    auto found = _content_keys.find(slot_nr);
+    if (found != _content_keys.end()) {
+        return found->second;
+    }
+
+    uint64_t key = FilterResultCache::hash_surface(_get_internal(slot_nr));
+    _content_keys[slot_nr] = key;
+    return key;
+}
+
+void FilterSlot::set_content_key(int slot_nr, uint64_t key)
+{
+    _content_keys[slot_nr] = key;
+}
+
 } /* namespace Filters */
 } /* namespace Inkscape */
 
@@ -15,7 +15,9 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <cstdint>
 #include <map>
+#include <vector>
 #include "display/nr-filter-types.h"
 #include "display/nr-filter-units.h"
 
@@ -82,6 +84,34 @@ public:
     FilterUnits const &get_units() const { return _units; }
     Geom::Rect get_slot_area() const;
 
+    /** Slots read and written by one filter primitive, collected while recording. */
+    struct Record {
+        struct Input {
+            int slot;
+            uint64_t key; ///< content key of the slot at the time it was read
+            int ci;       ///< color interpolation left on the input by the primitive
+        };
+        std::vector<Input> inputs;
+        std::vector<std::pair<int, Geom::Rect> > areas;
+        int output;
+        bool reuses_input; ///< the output is one of the input images
+
+        Record() : output(NR_FILTER_SLOT_NOT_SET), reuses_input(false) {}
+        bool valid() const { return output != NR_FILTER_SLOT_NOT_SET && !reuses_input; }
+    };
+
+    /** Starts collecting the slot accesses of a filter primitive. */
+    void begin_record();
+    /** Stops collecting and returns the accesses made since begin_record(). */
+    Record end_record();
+    /** Reproduces the effects of the recorded primitive, with @a result as its output. */
+    void replay(Record const &record, cairo_surface_t *result);
+
+    /** Returns a value identifying the contents of the given slot.
+     * Unless one was assigned with set_content_key(), it is computed from the pixel data. */
+    uint64_t content_key(int slot);
+    void set_content_key(int slot, uint64_t key);
+
 private:
     typedef std::map<int, cairo_surface_t *> SlotMap;
     SlotMap _slots;
@@ -90,6 +120,11 @@ private:
     typedef std::map<int, Geom::Rect> PrimitiveAreaMap;
     PrimitiveAreaMap _primitiveAreas;
 
+    std::map<int, uint64_t> _content_keys;
+    bool _recording;
+    Record _record;
+    std::vector<cairo_surface_t *> _record_surfaces;
+
     DrawingItem *_item;
 
     //Geom::Rect _source_bbox; ///< bounding box of source graphic surface
@@ -112,6 +147,7 @@ private:
     cairo_surface_t *_get_fill_paint();
     cairo_surface_t *_get_stroke_paint();
 
+    cairo_surface_t *_get_internal(int slot);
     void _set_internal(int slot, cairo_surface_t *s);
 };
 
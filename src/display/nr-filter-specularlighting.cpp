@@ -145,6 +145,7 @@ void FilterSpecularLighting::render_cairo(FilterSlot &slot)
 {
     cairo_surface_t *input = slot.getcairo(_input);
     cairo_surface_t *out = ink_cairo_surface_create_same_size(input, CAIRO_CONTENT_COLOR_ALPHA);
+    CairoSurfaceRelease release_out(out);
 
     double r = SP_RGBA32_R_F(lighting_color);
     double g = SP_RGBA32_G_F(lighting_color);
@@ -215,7 +216,6 @@ void FilterSpecularLighting::render_cairo(FilterSlot &slot)
     }
 
     slot.set(_output, out);
-    cairo_surface_destroy(out);
 }
 
 void FilterSpecularLighting::set_icc(SVGICCColor *icc_color) {
@@ -378,6 +378,7 @@ void FilterTurbulence::render_cairo(FilterSlot &slot)
 {
     cairo_surface_t *input = slot.getcairo(_input);
     cairo_surface_t *out = ink_cairo_surface_create_same_size(input, CAIRO_CONTENT_COLOR_ALPHA);
+    CairoSurfaceRelease release_out(out);
 
     // It is probably possible to render at a device scale greater than one
     // but for the moment rendering at a device scale of one is the easiest.
@@ -390,6 +391,7 @@ void FilterTurbulence::render_cairo(FilterSlot &slot)
     int width  = ceil(cairo_image_surface_get_width( input)/x_scale/x_scale);
     int height = ceil(cairo_image_surface_get_height(input)/y_scale/y_scale);
     cairo_surface_t *temp = cairo_surface_create_similar (input, CAIRO_CONTENT_COLOR_ALPHA, width, height);
+    CairoSurfaceRelease release_temp(temp);
     cairo_surface_set_device_scale( temp, 1, 1 );
 
     // color_interpolation_filter is determined by CSS value (see spec. Turbulence).
@@ -418,12 +420,9 @@ void FilterTurbulence::render_cairo(FilterSlot &slot)
     cairo_paint(ct);
     cairo_destroy(ct);
 
-    cairo_surface_destroy(temp);
-
     cairo_surface_mark_dirty(out);
 
     slot.set(_output, out);
-    cairo_surface_destroy(out);
 }
 
 double FilterTurbulence::complexity(Geom::Affine const &)
@@ -16,8 +16,11 @@
 #include <string>
 #include <cairo.h>
 
+#include "debug/render-profiler.h"
+
 #include "display/nr-filter.h"
 #include "display/nr-filter-primitive.h"
+#include "display/nr-filter-result-cache.h"
 #include "display/nr-filter-slot.h"
 #include "display/nr-filter-types.h"
 #include "display/nr-filter-units.h"
@@ -43,9 +46,11 @@
 #include "display/drawing.h"
 #include "display/drawing-item.h"
 #include "display/drawing-context.h"
+#include "display/drawing-render-thread.h"
 #include "display/drawing-surface.h"
 #include <2geom/affine.h>
 #include <2geom/rect.h>
+#include <2geom/transforms.h>
 #include "svg/svg-length.h"
 //#include "sp-filter-units.h"
 #include "preferences.h"
@@ -95,6 +100,14 @@ Filter::~Filter()
 }
 
 
+/// Describe a filter primitive rendering for the render profiler.
+static void profile_primitive(Debug::RenderProfiler::Scope &profile, FilterPrimitive *primitive, FilterSlot &slot)
+{
+    profile.setName(primitive->name().raw());
+    Geom::Rect area = slot.get_slot_area();
+    profile.setPixels(uint64_t(area.width()) * uint64_t(area.height()));
+}
+
 int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, DrawingContext *bgdc)
 {
     // std::cout << "Filter::render() for: " << const_cast<Inkscape::DrawingItem *>(item)->name() << std::endl;
@@ -108,9 +121,6 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
         graphic.setOperator(CAIRO_OPERATOR_OVER);
         return 1;
     }
-    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
-    item->drawing().setFilterQuality(prefs->getInt("/options/filterquality/value", 0));
-    item->drawing().setBlurQuality(prefs->getInt("/options/blurquality/value", 0));
     FilterQuality const filterquality = (FilterQuality)item->drawing().filterQuality();
     int const blurquality = item->drawing().blurQuality();
 
@@ -143,11 +153,13 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
         units.set_automatic_resolution(true);
     }
 
+    bool paraller = false;
     units.set_paraller(false);
     Geom::Affine pbtrans = units.get_matrix_display2pb();
     for (auto & i : _primitive) {
         if (!i->can_handle_affine(pbtrans)) {
             units.set_paraller(true);
+            paraller = true;
             break;
         }
     }
@@ -157,8 +169,56 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
     slot.set_blurquality(blurquality);
     slot.set_device_scale(graphic.surface()->device_scale());
 
-    for (auto & i : _primitive) {
-        i->render_cairo(slot);
+    if (FilterResultCache::get().enabled()) {
+        // Everything except the slot contents which affects the primitive results.
+        // The transform is taken relative to the rendered area, so that results
+        // can be reused when the item is only moved by whole pixels.
+        Geom::IntRect area = graphic.targetLogicalBounds().roundOutwards();
+        Geom::Affine rel = trans * Geom::Translate(-Geom::Point(area.min()));
+        FilterResultCache::Key context;
+        context.add(area.width());
+        context.add(area.height());
+        for (int i = 0; i < 6; ++i) {
+            context.add_double(rel[i]);
+        }
+        Geom::OptRect bbox = item->itemBounds();
+        context.add(bool(bbox));
+        if (bbox) {
+            for (int i = 0; i < 2; ++i) {
+                context.add_double(bbox->min()[i]);
+                context.add_double(bbox->max()[i]);
+            }
+        }
+        for (int i = 0; i < 2; ++i) {
+            context.add_double(filter_area->min()[i]);
+            context.add_double(filter_area->max()[i]);
+        }
+        context.add_double(resolution.first);
+        context.add_double(resolution.second);
+        context.add(_x_pixels > 0);
+        context.add(paraller);
+        context.add(_filter_units);
+        context.add(_primitive_units);
+        context.add(filterquality);
+        context.add(blurquality);
+        context.add(graphic.surface()->device_scale());
+        if (bgdc) {
+            Geom::IntRect bgarea = bgdc->targetLogicalBounds().roundOutwards();
+            context.add(bgarea.left() - area.left());
+            context.add(bgarea.top() - area.top());
+            context.add(bgarea.width());
+            context.add(bgarea.height());
+        }
+        _render_primitives(slot, context);
+    } else {
+        for (auto & i : _primitive) {
+            DrawingRenderThread::checkpoint();
+            Debug::RenderProfiler::Scope profile("filter", i);
+            if (profile.active()) {
+                profile_primitive(profile, i, slot);
+            }
+            i->render_cairo(slot);
+        }
     }
 
     Geom::Point origin = graphic.targetLogicalBounds().min();
@@ -176,6 +236,89 @@ int Filter::render(Inkscape::DrawingItem const *item, DrawingContext &graphic, D
     return 0;
 }
 
+/**
+ * Render the primitives, reusing their results from FilterResultCache where possible.
+ *
+ * The result of a primitive is identified by the context, its position in the filter and
+ * the contents of its inputs. The inputs of a primitive are only known after it has been
+ * rendered once, so the slot accesses are recorded and used for the lookups in subsequent
+ * renderings. Primitive parameters are not part of the key; instead, the cached results
+ * are discarded whenever the primitives are rebuilt.
+ */
+void Filter::_render_primitives(FilterSlot &slot, FilterResultCache::Key const &context)
+{
+    FilterResultCache &cache = FilterResultCache::get();
+
+    std::vector<FilterSlot::Record> records;
+    {
+        std::lock_guard<std::mutex> lock(_records_mutex);
+        records = _records;
+    }
+    records.resize(_primitive.size());
+
+    for (size_t i = 0; i < _primitive.size(); ++i) {
+        DrawingRenderThread::checkpoint();
+        FilterPrimitive *primitive = _primitive[i];
+        FilterSlot::Record &record = records[i];
+        bool cacheable = primitive->can_cache();
+
+        Debug::RenderProfiler::Scope profile("filter", primitive);
+        if (profile.active()) {
+            profile_primitive(profile, primitive, slot);
+            profile.setCache(cacheable ? Debug::RenderProfiler::CACHE_MISS : Debug::RenderProfiler::CACHE_NONE);
+        }
+
+        if (cacheable && record.valid()) {
+            FilterResultCache::Key key = _primitive_key(context, i);
+            for (auto &input : record.inputs) {
+                key.add(input.slot);
+                key.add(slot.content_key(input.slot));
+            }
+            cairo_surface_t *cached = cache.lookup(this, key);
+            if (cached) {
+                slot.replay(record, cached);
+                slot.set_content_key(record.output, key.hash);
+                cairo_surface_destroy(cached);
+                profile.setCache(Debug::RenderProfiler::CACHE_HIT);
+                continue;
+            }
+        }
+
+        slot.begin_record();
+        primitive->render_cairo(slot);
+        record = slot.end_record();
+
+        if (cacheable && record.valid()) {
+            FilterResultCache::Key key = _primitive_key(context, i);
+            for (auto &input : record.inputs) {
+                key.add(input.slot);
+                key.add(input.key);
+            }
+            cache.store(this, key, slot.getcairo(record.output));
+            slot.set_content_key(record.output, key.hash);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(_records_mutex);
+    _records = records;
+}
+
+/// The key of the result of primitive @a i, before its inputs are added.
+FilterResultCache::Key Filter::_primitive_key(FilterResultCache::Key const &context, size_t i) const
+{
+    FilterResultCache::Key key = context;
+    key.add(i);
+    key.add(reinterpret_cast<uintptr_t>(_primitive[i]));
+    return key;
+}
+
+void Filter::_invalidate_results()
+{
+    FilterResultCache::get().drop(this);
+    std::lock_guard<std::mutex> lock(_records_mutex);
+    _records.clear();
+}
+
 void Filter::set_filter_units(SPFilterUnits unit) {
     _filter_units = unit;
 }
@@ -345,6 +488,7 @@ int Filter::add_primitive(FilterPrimitiveType type)
 
     int handle = _primitive.size();
     _primitive.push_back(created);
+    _invalidate_results();
     return handle;
 }
 
@@ -364,6 +508,7 @@ int Filter::replace_primitive(int target, FilterPrimitiveType type)
 
     delete _primitive[target];
     _primitive[target] = created;
+    _invalidate_results();
     return target;
 }
 
@@ -378,6 +523,7 @@ void Filter::clear_primitives()
         delete i;
     }
     _primitive.clear();
+    _invalidate_results();
 }
 
 void Filter::set_x(SVGLength const &length)
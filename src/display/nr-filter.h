@@ -15,7 +15,10 @@
 
 //#include "display/nr-arena-item.h"
 #include <cairo.h>
+#include <mutex>
 #include "display/nr-filter-primitive.h"
+#include "display/nr-filter-result-cache.h"
+#include "display/nr-filter-slot.h"
 #include "display/nr-filter-types.h"
 #include "svg/svg-length.h"
 #include "object/sp-filter-units.h"
@@ -198,8 +201,16 @@ private:
     SPFilterUnits _filter_units;
     SPFilterUnits _primitive_units;
 
+    /* Slot accesses of each primitive in the last rendering, used to look up
+     * primitive results in FilterResultCache before rendering them. */
+    std::vector<FilterSlot::Record> _records;
+    std::mutex _records_mutex;
+
     void _create_constructor_table();
     void _common_init();
+    void _render_primitives(FilterSlot &slot, FilterResultCache::Key const &context);
+    FilterResultCache::Key _primitive_key(FilterResultCache::Key const &context, size_t i) const;
+    void _invalidate_results();
     int _resolution_limit(FilterQuality const quality) const;
     std::pair<double,double> _filter_resolution(Geom::Rect const &area,
                                                 Geom::Affine const &trans,
@@ -10,6 +10,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <mutex>
+
 #include "display/nr-style.h"
 #include "style.h"
 #include "object/sp-paint-server.h"
@@ -321,14 +323,14 @@ void NRStyle::set(SPStyle *style, SPStyle *context_style)
     update();
 }
 
-cairo_pattern_t* NRStyle::preparePaint(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern, Paint& paint)
+cairo_pattern_t* NRStyle::preparePaint(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern, Paint& paint, unsigned flags)
 {
     cairo_pattern_t* cpattern = nullptr;
 
     switch (paint.type) {
         case PAINT_SERVER:
             if (pattern) {
-                cpattern = pattern->renderPattern(paint.opacity);
+                cpattern = pattern->renderPattern(paint.opacity, flags);
             } else {
                 cpattern = paint.server->pattern_new(dc.raw(), paintbox, paint.opacity);
             }
@@ -350,27 +352,36 @@ cairo_pattern_t* NRStyle::preparePaint(Inkscape::DrawingContext &dc, Geom::OptRe
     return cpattern;
 }
 
-bool NRStyle::prepareFill(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern)
+// Patterns are created lazily during rendering, which can happen on several threads at once
+// (see Drawing::renderThreaded), so their creation is serialized. Rendering a pattern tile
+// prepares the styles of the pattern's children, hence the recursive mutex.
+static std::recursive_mutex prepare_mutex;
+
+bool NRStyle::prepareFill(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern, unsigned flags)
 {
-    if (!fill_pattern) fill_pattern = preparePaint(dc, paintbox, pattern, fill);
+    std::lock_guard<std::recursive_mutex> lock(prepare_mutex);
+    if (!fill_pattern) fill_pattern = preparePaint(dc, paintbox, pattern, fill, flags);
     return fill_pattern != nullptr;
 }
 
-bool NRStyle::prepareStroke(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern)
+bool NRStyle::prepareStroke(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern, unsigned flags)
 {
-    if (!stroke_pattern) stroke_pattern = preparePaint(dc, paintbox, pattern, stroke);
+    std::lock_guard<std::recursive_mutex> lock(prepare_mutex);
+    if (!stroke_pattern) stroke_pattern = preparePaint(dc, paintbox, pattern, stroke, flags);
     return stroke_pattern != nullptr;
 }
 
-bool NRStyle::prepareTextDecorationFill(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern)
+bool NRStyle::prepareTextDecorationFill(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern, unsigned flags)
 {
-    if (!text_decoration_fill_pattern) text_decoration_fill_pattern = preparePaint(dc, paintbox, pattern, text_decoration_fill);
+    std::lock_guard<std::recursive_mutex> lock(prepare_mutex);
+    if (!text_decoration_fill_pattern) text_decoration_fill_pattern = preparePaint(dc, paintbox, pattern, text_decoration_fill, flags);
     return text_decoration_fill_pattern != nullptr;
 }
 
-bool NRStyle::prepareTextDecorationStroke(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern)
+bool NRStyle::prepareTextDecorationStroke(Inkscape::DrawingContext &dc, Geom::OptRect const &paintbox, Inkscape::DrawingPattern *pattern, unsigned flags)
 {
-    if (!text_decoration_stroke_pattern) text_decoration_stroke_pattern = preparePaint(dc, paintbox, pattern, text_decoration_stroke);
+    std::lock_guard<std::recursive_mutex> lock(prepare_mutex);
+    if (!text_decoration_stroke_pattern) text_decoration_stroke_pattern = preparePaint(dc, paintbox, pattern, text_decoration_stroke, flags);
     return text_decoration_stroke_pattern != nullptr;
 }
 
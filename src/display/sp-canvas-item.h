@@ -97,6 +97,9 @@ struct _SPCanvasItemClass {
     void (* update) (SPCanvasItem *item, Geom::Affine const &affine, unsigned int flags);
 
     void (* render) (SPCanvasItem *item, SPCanvasBuf *buf);
+    /* Prepares rendering of the buffer area in the background. Returns false if the item
+     * cannot be rendered into the buffer yet; the canvas is notified when it can. */
+    bool (* prepare) (SPCanvasItem *item, SPCanvasBuf *buf);
     double (* point) (SPCanvasItem *item, Geom::Point p, SPCanvasItem **actual_item);
 
     int (* event) (SPCanvasItem *item, GdkEvent *event);
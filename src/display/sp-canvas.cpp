@@ -22,6 +22,10 @@
 # include "config.h"  // only include where actually required!
 #endif
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #include <gdkmm/devicemanager.h>
 #include <gdkmm/display.h>
 #include <gdkmm/rectangle.h>
@@ -125,6 +129,11 @@ struct SPCanvasGroup {
      */
     static void render(SPCanvasItem *item, SPCanvasBuf *buf);
 
+    /**
+     * Prepares all visible canvas group items in buf rectangle.
+     */
+    static bool prepare(SPCanvasItem *item, SPCanvasBuf *buf);
+
     static void viewboxChanged(SPCanvasItem *item, Geom::IntRect const &new_area);
 
 
@@ -146,6 +155,13 @@ namespace {
 
 gint const UPDATE_PRIORITY = G_PRIORITY_DEFAULT_IDLE;
 
+/// Time after the last scroll, zoom or drag event during which the user is considered
+/// to be interacting with the canvas, in milliseconds.
+guint const INTERACTION_TIMEOUT = 250;
+
+/// Background renderings of a buffer that may be abandoned before it is painted synchronously.
+int const MAX_ABANDONED_RENDERS = 2;
+
 GdkWindow *getWindow(SPCanvas *canvas)
 {
     return gtk_widget_get_window(reinterpret_cast<GtkWidget *>(canvas));
@@ -774,6 +790,7 @@ static void sp_canvas_group_class_init(SPCanvasGroupClass *klass)
     item_class->destroy = SPCanvasGroup::destroy;
     item_class->update = SPCanvasGroup::update;
     item_class->render = SPCanvasGroup::render;
+    item_class->prepare = SPCanvasGroup::prepare;
     item_class->point = SPCanvasGroup::point;
     item_class->viewbox_changed = SPCanvasGroup::viewboxChanged;
 }
@@ -894,6 +911,28 @@ void SPCanvasGroup::render(SPCanvasItem *item, SPCanvasBuf *buf)
     }
 }
 
+bool SPCanvasGroup::prepare(SPCanvasItem *item, SPCanvasBuf *buf)
+{
+    SPCanvasGroup *group = SP_CANVAS_GROUP(item);
+    bool ready = true;
+
+    // prepare all children, so that their background renderings can run at the same time
+    for (auto & item : group->items) {
+        SPCanvasItem *child = &item;
+        if (child->visible) {
+            if ((child->x1 < buf->rect.right()) &&
+                (child->y1 < buf->rect.bottom()) &&
+                (child->x2 > buf->rect.left()) &&
+                (child->y2 > buf->rect.top())) {
+                if (SP_CANVAS_ITEM_GET_CLASS(child)->prepare) {
+                    ready = SP_CANVAS_ITEM_GET_CLASS(child)->prepare(child, buf) && ready;
+                }
+            }
+        }
+    }
+    return ready;
+}
+
 void SPCanvasGroup::viewboxChanged(SPCanvasItem *item, Geom::IntRect const &new_area)
 {
     SPCanvasGroup *group = SP_CANVAS_GROUP(item);
@@ -992,6 +1031,15 @@ static void sp_canvas_init(SPCanvas *canvas)
 
     canvas->_forced_redraw_count = 0;
     canvas->_forced_redraw_limit = -1;
+    canvas->_render_threads = 1;
+    canvas->_background_rendering = false;
+    canvas->_waiting_for_render = false;
+    canvas->_abandoned_renders = 0;
+    canvas->_progressive = false;
+    canvas->_preview = false;
+    canvas->_interaction_time = 0;
+    canvas->_preview_region = cairo_region_create();
+    canvas->_refine_id = 0;
 
     // Split view controls
     canvas->_spliter = Geom::OptIntRect();
@@ -1065,6 +1113,14 @@ void SPCanvas::dispose(GObject *object)
         cairo_region_destroy(canvas->_clean_region);
         canvas->_clean_region = nullptr;
     }
+    if (canvas->_refine_id) {
+        g_source_remove(canvas->_refine_id);
+        canvas->_refine_id = 0;
+    }
+    if (canvas->_preview_region) {
+        cairo_region_destroy(canvas->_preview_region);
+        canvas->_preview_region = nullptr;
+    }
     if (canvas->_background) {
         cairo_pattern_destroy(canvas->_background);
         canvas->_background = nullptr;
@@ -1632,6 +1688,7 @@ gint SPCanvas::handle_button(GtkWidget *widget, GdkEventButton *event)
 
 gint SPCanvas::handle_scroll(GtkWidget *widget, GdkEventScroll *event)
 {
+    SP_CANVAS(widget)->noteInteraction();
     return SP_CANVAS(widget)->emitEvent(reinterpret_cast<GdkEvent *>(event));
 }
 
@@ -1702,6 +1759,10 @@ int SPCanvas::handle_motion(GtkWidget *widget, GdkEventMotion *event)
 
     if (canvas->_root == nullptr) // canvas being deleted
         return FALSE;
+
+    if (event->state & (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK)) {
+        canvas->noteInteraction();
+    }
     
     Geom::IntPoint cursor_pos = Geom::IntPoint(event->x, event->y);
     Inkscape::Preferences *prefs = Inkscape::Preferences::get();
@@ -1814,6 +1875,8 @@ void SPCanvas::paintSingleBuffer(Geom::IntRect const &paint_rect, Geom::IntRect
     buf.rect = paint_rect;
     buf.canvas_rect = canvas_rect;
     buf.device_scale = _device_scale;
+    buf.render_threads = _render_threads;
+    buf.preview = _preview;
     buf.is_empty = true;
 
     // Make sure the following code does not go outside of _backing_store's data
@@ -1896,6 +1959,15 @@ void SPCanvas::paintSingleBuffer(Geom::IntRect const &paint_rect, Geom::IntRect
     // Mark the painted rectangle clean
     markRect(paint_rect, 0);
 
+    if (_preview) {
+        // paint it again in full quality once the interaction has ended
+        cairo_rectangle_int_t crect = { paint_rect.left(), paint_rect.top(), paint_rect.width(), paint_rect.height() };
+        cairo_region_union_rectangle(_preview_region, &crect);
+        if (!_refine_id) {
+            _refine_id = g_timeout_add(INTERACTION_TIMEOUT, &SPCanvas::refine_handler, this);
+        }
+    }
+
     cairo_surface_destroy(imgs);
 
     gtk_widget_queue_draw_area(GTK_WIDGET(this), paint_rect.left() -_x0, paint_rect.top() - _y0,
@@ -1919,6 +1991,8 @@ void SPCanvas::paintXRayBuffer(Geom::IntRect const &paint_rect, Geom::IntRect co
     buf.rect = paint_rect;
     buf.canvas_rect = canvas_rect;
     buf.device_scale = _device_scale;
+    buf.render_threads = 1;
+    buf.preview = false;
     buf.is_empty = true;
     // Make sure the following code does not go outside of _backing_store's data
     // FIXME for device_scale.
@@ -2098,6 +2172,12 @@ int SPCanvas::paintRectInternal(PaintRectSetup const *setup, Geom::IntRect const
     // to render and if the render area go across diferent rendering tiles it render splited
     if (elapsed > 1000 && !_forcefull) {
 
+        // With background rendering, buffers are only composited here, so interrupting
+        // never keeps the screen stale; see backgroundRenderFinished() for the renderings.
+        if (_background_rendering) {
+            return false;
+        }
+
         // Interrupting redraw isn't always good.
         // For example, when you drag one node of a big path, only the buffer containing
         // the mouse cursor will be redrawn again and again, and the rest of the path
@@ -2125,6 +2205,29 @@ int SPCanvas::paintRectInternal(PaintRectSetup const *setup, Geom::IntRect const
 
     if (bw * bh < setup->max_pixels) {
         // We are small enough
+
+        // With background rendering, the buffer is painted once the canvas items have
+        // rendered it on their own threads. While waiting, we return to the main loop.
+        // A rendering is abandoned when the drawing changes under it; the next one is then
+        // a preview, and if that is abandoned too, the preview is painted synchronously,
+        // so that continuous changes cannot keep the buffer stale.
+        if (_background_rendering && !_forcefull && _abandoned_renders < MAX_ABANDONED_RENDERS) {
+            SPCanvasBuf buf;
+            buf.buf = nullptr;
+            buf.buf_rowstride = 0;
+            buf.ct = nullptr;
+            buf.rect = this_rect;
+            buf.canvas_rect = setup->canvas_rect;
+            buf.device_scale = _device_scale;
+            buf.render_threads = _render_threads;
+            buf.preview = _preview;
+            buf.is_empty = true;
+            if (_root->visible && !SP_CANVAS_ITEM_GET_CLASS(_root)->prepare(_root, &buf)) {
+                _waiting_for_render = true;
+                return false;
+            }
+        }
+
         /*
         GdkRectangle r;
         r.x = this_rect.x0 - setup->canvas->x0;
@@ -2137,6 +2240,7 @@ int SPCanvas::paintRectInternal(PaintRectSetup const *setup, Geom::IntRect const
         */
 
         paintSingleBuffer(this_rect, setup->canvas_rect, bw);
+        _abandoned_renders = 0;
         _splits++;
         //gdk_window_end_paint(window);
         return 1;
@@ -2243,6 +2347,27 @@ bool SPCanvas::paintRect(int xx0, int yy0, int xx1, int yy1)
         setup.max_pixels = 262144;
     }
 
+    // In threaded mode, each buffer is split into bands that are rendered concurrently,
+    // so hand larger buffers to the workers in each step of the idle loop.
+    _render_threads = 1;
+#if HAVE_OPENMP
+    if (_rendermode != Inkscape::RENDERMODE_OUTLINE && prefs->getBool("/options/rendering/threaded", false)) {
+        _render_threads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
+        setup.max_pixels *= _render_threads;
+    }
+#endif
+    _background_rendering = _rendermode != Inkscape::RENDERMODE_OUTLINE &&
+                            prefs->getBool("/options/rendering/background", false);
+
+    // While the user interacts, render previews with the lowest filter and blur quality
+    _progressive = _rendermode != Inkscape::RENDERMODE_OUTLINE &&
+                   prefs->getBool("/options/rendering/progressive", false);
+    _preview = _progressive && g_get_monotonic_time() - _interaction_time < INTERACTION_TIMEOUT * 1000;
+    // After an abandoned background rendering, render previews until a buffer gets painted
+    if (_background_rendering && _abandoned_renders > 0) {
+        _preview = true;
+    }
+
     // Start the clock
     setup.start_time = g_get_monotonic_time();
     // Go
@@ -2260,6 +2385,36 @@ void SPCanvas::endForcedFullRedraws()
     _forced_redraw_limit = -1;
 }
 
+void SPCanvas::noteInteraction()
+{
+    _interaction_time = g_get_monotonic_time();
+}
+
+gint SPCanvas::refine_handler(gpointer data)
+{
+    SPCanvas *canvas = SP_CANVAS(data);
+    if (g_get_monotonic_time() - canvas->_interaction_time < INTERACTION_TIMEOUT * 1000) {
+        return TRUE; // still interacting, check again later
+    }
+    canvas->_refine_id = 0;
+    if (!cairo_region_is_empty(canvas->_preview_region)) {
+        cairo_region_subtract(canvas->_clean_region, canvas->_preview_region);
+        cairo_region_destroy(canvas->_preview_region);
+        canvas->_preview_region = cairo_region_create();
+        canvas->addIdle();
+    }
+    return FALSE;
+}
+
+void SPCanvas::backgroundRenderFinished(bool completed)
+{
+    if (!completed) {
+        _abandoned_renders++;
+    }
+    _waiting_for_render = false;
+    addIdle();
+}
+
 gboolean SPCanvas::handle_draw(GtkWidget *widget, cairo_t *cr) {
 
     SPCanvas *canvas = SP_CANVAS(widget);
@@ -2560,7 +2715,13 @@ gint SPCanvas::idle_handler(gpointer data)
     g_message("[%i] start loop %i in split %i at %f", canvas->_idle_id, totaloops, canvas->_splits,
                 canvas->_totalelapsed / (double)1000000 + elapsed / (double)1000000);
 #endif
+    canvas->_waiting_for_render = false;
     int ret = canvas->doUpdate();
+    if (canvas->_waiting_for_render) {
+        // resumed by backgroundRenderFinished()
+        canvas->_idle_id = 0;
+        return FALSE;
+    }
     int n_rects = cairo_region_num_rectangles(canvas->_clean_region);
     if (n_rects > 1) { // not fully painted, maybe clean region is updated in middle of idle, reload again
         ret = 0;
@@ -2647,6 +2808,8 @@ void SPCanvas::scrollTo( Geom::Point const &c, unsigned int clear, bool is_scrol
 {
     // To do: extract out common code with SPCanvas::handle_size_allocate()
 
+    noteInteraction();
+
     // For HiDPI monitors
     int device_scale = gtk_widget_get_scale_factor(GTK_WIDGET(this));
     assert( device_scale == _device_scale);
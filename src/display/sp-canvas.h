@@ -58,6 +58,8 @@ struct SPCanvasBuf {
     unsigned char *buf;
     int buf_rowstride;
     int device_scale; // For high DPI monitors.
+    int render_threads; // Number of threads the drawing may be rendered with; 1 means serial rendering.
+    bool preview; // Render quickly at reduced quality; the area is rendered again once the user stops interacting.
     bool is_empty;
 };
 
@@ -87,6 +89,12 @@ struct SPCanvas {
     void forceFullRedrawAfterInterruptions(unsigned int count);
     void endForcedFullRedraws();
 
+    /// Called by canvas items when a rendering started by their prepare() method has ended.
+    void backgroundRenderFinished(bool completed);
+
+    /// Records that the user is scrolling, zooming or dragging, see _progressive.
+    void noteInteraction();
+
     Geom::Rect getViewbox() const;
     Geom::IntRect getViewboxIntegers() const;
     SPCanvasGroup *getRoot();
@@ -142,6 +150,7 @@ private:
 
     /// Idle handler for the canvas that deals with pending updates and redraws.
     static gint idle_handler(gpointer data);
+    static gint refine_handler(gpointer data);
 
     /// Convenience function to add an idle handler to a canvas.
     void addIdle();
@@ -210,6 +219,15 @@ public:
     bool _forcefull;
     bool _scrooling;
     int _device_scale; ///< Scale for high DPI montiors
+    int _render_threads; ///< Threads used to render the drawing in each buffer, see Drawing::renderThreaded()
+    bool _background_rendering; ///< Whether buffers are prepared in the background before painting
+    bool _waiting_for_render; ///< Painting is suspended until a background rendering finishes
+    int _abandoned_renders; ///< Background renderings abandoned since a buffer was last painted
+    bool _progressive; ///< Whether buffers are previewed at low quality while the user interacts
+    bool _preview; ///< Whether the buffers being painted are previews
+    gint64 _interaction_time; ///< When the user last scrolled, zoomed or dragged
+    cairo_region_t *_preview_region; ///< Area painted as a preview, to be painted again in full quality
+    guint _refine_id; ///< Timeout which refines the previews once the interaction has ended
     gint64 _idle_time;
     int _splits;
     gint64 _totalelapsed;
@@ -10,15 +10,238 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
+#endif
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #include <algorithm>
 #include "helper/geom.h"
 #include "helper/geom-curves.h"
+#include "preferences.h"
 #include <2geom/curves.h>
+#include <2geom/pathvector.h>
 #include <2geom/sbasis-to-bezier.h>
+#include <2geom/sweeper.h>
+#include <boost/intrusive/list.hpp>
 
 using Geom::X;
 using Geom::Y;
 
+//#################################################################################
+// NEAREST POINTS
+
+std::vector<Geom::PathVectorTime>
+pathv_nearest_times(Geom::PathVector const &pathv, Geom::Point const &pt, Geom::Coord max_dist,
+                    std::size_t max_count, std::vector<Geom::Coord> *dists)
+{
+    // A curve lies within its fast bounds, so it cannot come closer than they do
+    std::vector<Geom::PathVectorTime> candidates;
+    for (std::size_t i = 0; i < pathv.size(); ++i) {
+        Geom::Path const &path = pathv[i];
+        for (std::size_t j = 0; j < path.size_default(); ++j) {
+            if (Geom::distance(pt, path[j].boundsFast()) >= max_dist) continue;
+            candidates.emplace_back(i, j, 0);
+        }
+    }
+
+    int const count = candidates.size();
+    int threads = 1;
+#if HAVE_OPENMP
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    threads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
+#endif
+
+    std::vector<Geom::Coord> cdist(count);
+    // Below this many curves, threads cost more than they save
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic, 8) num_threads(threads) if(count > 64)
+#endif
+    for (int c = 0; c < count; ++c) {
+        Geom::Curve const &curve = pathv[candidates[c].path_index][candidates[c].curve_index];
+        candidates[c].t = curve.nearestTime(pt);
+        cdist[c] = Geom::distance(curve.pointAt(candidates[c].t), pt);
+    }
+
+    std::vector<int> order;
+    for (int c = 0; c < count; ++c) {
+        if (cdist[c] < max_dist) {
+            order.push_back(c);
+        }
+    }
+    // ties are broken by position, so that the result does not depend on the sort
+    auto closer = [&](int a, int b) {
+        return cdist[a] < cdist[b] || (cdist[a] == cdist[b] && candidates[a] < candidates[b]);
+    };
+    if (max_count && order.size() > max_count) {
+        std::partial_sort(order.begin(), order.begin() + max_count, order.end(), closer);
+        order.resize(max_count);
+    } else {
+        std::sort(order.begin(), order.end(), closer);
+    }
+
+    std::vector<Geom::PathVectorTime> result;
+    result.reserve(order.size());
+    if (dists) {
+        dists->clear();
+        dists->reserve(order.size());
+    }
+    for (int c : order) {
+        result.push_back(candidates[c]);
+        if (dists) {
+            dists->push_back(cdist[c]);
+        }
+    }
+    return result;
+}
+
+//#################################################################################
+// INTERSECTIONS
+
+namespace {
+
+/**
+ * Sweepline over the curves of two path vectors.
+ * Geom::PathVector::intersect() sweeps the paths, and then sweeps the curves of every pair of
+ * paths whose bounds overlap, so a long path is swept again for every path near it. Here the
+ * curves of all paths are swept at once, and the sweep only collects the pairs of curves whose
+ * fast bounds overlap; they are intersected afterwards.
+ */
+class CurveIntersectionSweepSet {
+public:
+    struct CurveRecord {
+        boost::intrusive::list_member_hook<> _hook;
+        Geom::Curve const *curve;
+        Geom::Rect bounds;
+        std::size_t path_index;
+        std::size_t path_size;
+        std::size_t index;
+        unsigned which;
+
+        CurveRecord(Geom::Curve const *pc, std::size_t pidx, std::size_t psz, std::size_t idx, unsigned w)
+            : curve(pc)
+            , bounds(curve->boundsFast())
+            , path_index(pidx)
+            , path_size(psz)
+            , index(idx)
+            , which(w)
+        {}
+    };
+
+    typedef std::vector<CurveRecord>::const_iterator ItemIterator;
+
+    CurveIntersectionSweepSet(Geom::PathVector const &a, Geom::PathVector const &b)
+        : _sweep_dir(X)
+    {
+        _records.reserve(a.curveCount() + b.curveCount());
+        _addCurves(a, 0);
+        _addCurves(b, 1);
+
+        Geom::OptRect abb = a.boundsFast() | b.boundsFast();
+        if (abb && abb->height() > abb->width()) {
+            _sweep_dir = Y;
+        }
+    }
+
+    std::vector<CurveRecord> const &items() { return _records; }
+    Geom::Interval itemBounds(ItemIterator ii) { return ii->bounds[_sweep_dir]; }
+
+    void addActiveItem(ItemIterator ii)
+    {
+        unsigned w = ii->which;
+        unsigned ow = (w + 1) % 2;
+        std::size_t n = ii - _records.begin();
+
+        _active[w].push_back(const_cast<CurveRecord &>(*ii));
+
+        for (auto i = _active[ow].begin(); i != _active[ow].end(); ++i) {
+            if (!ii->bounds.intersects(i->bounds)) continue;
+            std::size_t on = &*i - &_records.front();
+            _pairs.push_back(w == 0 ? std::make_pair(n, on) : std::make_pair(on, n));
+        }
+    }
+
+    void removeActiveItem(ItemIterator ii)
+    {
+        ActiveCurveList &acl = _active[ii->which];
+        acl.erase(acl.iterator_to(*ii));
+    }
+
+    /// Intersect the pairs of curves found by the sweep.
+    std::vector<Geom::PVIntersection> intersections(Geom::Coord precision) const
+    {
+        // The fast bounds of Bezier curves include their control points, so they are often much
+        // larger than the curves. Check the exact bounds before the costly intersection.
+        std::vector<char> used(_records.size(), 0);
+        for (auto const &pair : _pairs) {
+            used[pair.first] = used[pair.second] = 1;
+        }
+        std::vector<Geom::Rect> exact(_records.size());
+        for (std::size_t i = 0; i < _records.size(); ++i) {
+            if (!used[i]) continue;
+            CurveRecord const &r = _records[i];
+            exact[i] = r.curve->isLineSegment() ? r.bounds : r.curve->boundsExact();
+            exact[i].expandBy(precision);
+        }
+
+        // Not parallel: the Bezier clipping used for curve intersections keeps state in statics.
+        std::vector<Geom::PVIntersection> result;
+        for (auto const &pair : _pairs) {
+            if (!exact[pair.first].intersects(exact[pair.second])) continue;
+            CurveRecord const &ra = _records[pair.first];
+            CurveRecord const &rb = _records[pair.second];
+            std::vector<Geom::CurveIntersection> found = ra.curve->intersect(*rb.curve, precision);
+            for (auto const &x : found) {
+                // intersections at the ends of curves are found twice; see below
+                Geom::PathTime ta(ra.index, x.first), tb(rb.index, x.second);
+                ta.normalizeForward(ra.path_size);
+                tb.normalizeForward(rb.path_size);
+                result.emplace_back(Geom::PathVectorTime(ra.path_index, ta),
+                                    Geom::PathVectorTime(rb.path_index, tb), x.point());
+            }
+        }
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        return result;
+    }
+
+private:
+    typedef boost::intrusive::list<
+        CurveRecord,
+        boost::intrusive::member_hook<CurveRecord, boost::intrusive::list_member_hook<>, &CurveRecord::_hook>>
+        ActiveCurveList;
+
+    void _addCurves(Geom::PathVector const &pv, unsigned w)
+    {
+        for (std::size_t i = 0; i < pv.size(); ++i) {
+            std::size_t sz = pv[i].size();
+            for (std::size_t j = 0; j < sz; ++j) {
+                _records.emplace_back(&pv[i][j], i, sz, j, w);
+            }
+        }
+    }
+
+    std::vector<CurveRecord> _records;
+    std::vector<std::pair<std::size_t, std::size_t>> _pairs;
+    ActiveCurveList _active[2];
+    Geom::Dim2 _sweep_dir;
+};
+
+} // namespace
+
+std::vector<Geom::PVIntersection>
+pathv_intersections(Geom::PathVector const &a, Geom::PathVector const &b, Geom::Coord precision)
+{
+    CurveIntersectionSweepSet cisset(a, b);
+    Geom::Sweeper<CurveIntersectionSweepSet> sweeper(cisset);
+    sweeper.process();
+
+    return cisset.intersections(precision);
+}
+
 //#################################################################################
 // BOUNDING BOX CALCULATIONS
 
@@ -15,9 +15,12 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <vector>
+
 #include <2geom/forward.h>
 #include <2geom/rect.h>
 #include <2geom/affine.h>
+#include <2geom/pathvector.h>
 
 Geom::OptRect bounds_fast_transformed(Geom::PathVector const & pv, Geom::Affine const & t);
 Geom::OptRect bounds_exact_transformed(Geom::PathVector const & pv, Geom::Affine const & t);
@@ -26,6 +29,24 @@ void pathv_matrix_point_bbox_wind_distance ( Geom::PathVector const & pathv, Geo
                                              Geom::Rect *bbox, int *wind, Geom::Coord *dist,
                                              Geom::Coord tolerance, Geom::Rect const *viewbox);
 
+/**
+ * Find the nearest times on all curves of @a pathv that pass closer to @a pt than @a max_dist,
+ * ordered by increasing distance. Curves whose bounds are out of reach are skipped without
+ * searching them, and many remaining curves are searched on several threads.
+ * @param max_count Return at most this many times, or all of them if 0
+ * @param dists If not null, receives the distances of the returned times
+ */
+std::vector<Geom::PathVectorTime> pathv_nearest_times(Geom::PathVector const &pathv, Geom::Point const &pt,
+                                                      Geom::Coord max_dist, std::size_t max_count = 0,
+                                                      std::vector<Geom::Coord> *dists = nullptr);
+
+/**
+ * Find the intersections of two path vectors, like Geom::PathVector::intersect(), sweeping the
+ * curves of all paths at once. This scales to path vectors with many curves and paths.
+ */
+std::vector<Geom::PVIntersection> pathv_intersections(Geom::PathVector const &a, Geom::PathVector const &b,
+                                                      Geom::Coord precision = Geom::EPSILON);
+
 Geom::PathVector pathv_to_linear_and_cubic_beziers( Geom::PathVector const &pathv );
 Geom::PathVector pathv_to_linear( Geom::PathVector const &pathv, double maxdisp );
 Geom::PathVector pathv_to_cubicbezier( Geom::PathVector const &pathv);
@@ -14,6 +14,12 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
+#endif
+
+#include <algorithm>
+#include <memory>
 
 #include <2geom/rect.h>
 #include <2geom/transforms.h>
@@ -58,6 +64,7 @@ struct SPEBP {
     guchar *px;
     unsigned (*status)(float, void *);
     void *data;
+    int threads; // threads rendering each strip, see Inkscape::Drawing::renderThreaded()
 };
 
 /* write a png file */
@@ -123,8 +130,51 @@ void PngTextList::add(gchar const* key, gchar const* text)
     }
 }
 
+/**
+ * Collect the document metadata stored in the text chunks of exported PNG files.
+ */
+static void
+sp_png_collect_text(SPDocument *doc, PngTextList &textList)
+{
+    textList.add("Software", "www.inkscape.org"); // Made by Inkscape comment
+    const gchar* pngToDc[] = {"Title", "title",
+                              "Author", "creator",
+                              "Description", "description",
+                              //"Copyright", "",
+                              "Creation Time", "date",
+                              //"Disclaimer", "",
+                              //"Warning", "",
+                              "Source", "source"
+                              //"Comment", ""
+    };
+    for (size_t i = 0; i < G_N_ELEMENTS(pngToDc); i += 2) {
+        struct rdf_work_entity_t * entity = rdf_find_entity ( pngToDc[i + 1] );
+        if (entity) {
+            gchar const* data = rdf_get_work_entity(doc, entity);
+            if (data && *data) {
+                textList.add(pngToDc[i], data);
+            }
+        } else {
+            g_warning("Unable to find entity [%s]", pngToDc[i + 1]);
+        }
+    }
+
+    struct rdf_license_t *license =  rdf_get_license(doc);
+    if (license) {
+        if (license->name && license->uri) {
+            gchar* tmp = g_strdup_printf("%s %s", license->name, license->uri);
+            textList.add("Copyright", tmp);
+            g_free(tmp);
+        } else if (license->name) {
+            textList.add("Copyright", license->name);
+        } else if (license->uri) {
+            textList.add("Copyright", license->uri);
+        }
+    }
+}
+
 static bool
-sp_png_write_rgba_striped(SPDocument *doc,
+sp_png_write_rgba_striped(PngTextList &textList,
                           gchar const *filename, unsigned long int width, unsigned long int height, double xdpi, double ydpi,
                           int (* get_rows)(guchar const **rows, void **to_free, int row, int num_rows, void *data, int color_type, int bit_depth, int antialias),
                           void *data, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
@@ -210,46 +260,6 @@ sp_png_write_rgba_striped(SPDocument *doc,
         png_set_sBIT(png_ptr, info_ptr, &sig_bit);
     }
 
-    PngTextList textList;
-
-    textList.add("Software", "www.inkscape.org"); // Made by Inkscape comment
-    {
-        const gchar* pngToDc[] = {"Title", "title",
-                               "Author", "creator",
-                               "Description", "description",
-                               //"Copyright", "",
-                               "Creation Time", "date",
-                               //"Disclaimer", "",
-                               //"Warning", "",
-                               "Source", "source"
-                               //"Comment", ""
-        };
-        for (size_t i = 0; i < G_N_ELEMENTS(pngToDc); i += 2) {
-            struct rdf_work_entity_t * entity = rdf_find_entity ( pngToDc[i + 1] );
-            if (entity) {
-                gchar const* data = rdf_get_work_entity(doc, entity);
-                if (data && *data) {
-                    textList.add(pngToDc[i], data);
-                }
-            } else {
-                g_warning("Unable to find entity [%s]", pngToDc[i + 1]);
-            }
-        }
-
-
-        struct rdf_license_t *license =  rdf_get_license(doc);
-        if (license) {
-            if (license->name && license->uri) {
-                gchar* tmp = g_strdup_printf("%s %s", license->name, license->uri);
-                textList.add("Copyright", tmp);
-                g_free(tmp);
-            } else if (license->name) {
-                textList.add("Copyright", license->name);
-            } else if (license->uri) {
-                textList.add("Copyright", license->uri);
-            }
-        }
-    }
     if (textList.getCount() > 0) {
         png_set_text(png_ptr, info_ptr, textList.getPtext(), textList.getCount());
     }
@@ -355,7 +365,11 @@ sp_export_get_rows(guchar const **rows, void **to_free, int row, int num_rows, v
     dc.setOperator(CAIRO_OPERATOR_OVER);
 
     /* Render */
-    ebp->drawing->render(dc, bbox, 0, antialiasing);
+    if (ebp->threads > 1) {
+        ebp->drawing->renderThreaded(dc, bbox, ebp->threads, 0, antialiasing);
+    } else {
+        ebp->drawing->render(dc, bbox, 0, antialiasing);
+    }
     cairo_surface_destroy(s);
 
     // PNG stores data as unpremultiplied big-endian RGBA, which means
@@ -399,39 +413,25 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                                 unsigned long bgcolor,
                                 unsigned int (*status) (float, void *),
                                 void *data, bool force_overwrite,
-                                const std::vector<SPItem*> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+                                const std::vector<SPItem*> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                int threads)
 {
     return sp_export_png_file(doc, filename, Geom::Rect(Geom::Point(x0,y0),Geom::Point(x1,y1)),
-                              width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing);
+                              width, height, xdpi, ydpi, bgcolor, status, data, force_overwrite, items_only, interlace, color_type, bit_depth, zlib, antialiasing,
+                              threads);
 }
 
 /**
- * Export an area to a PNG file
+ * Show the document in a new drawing which maps @a area onto a bitmap of @a width by
+ * @a height pixels, and bring the drawing up to date.
  *
- * @param area Area in document coordinates
+ * Once this returns, the drawing can be rendered without touching the document, so that
+ * several drawings can be rendered at once.
  */
-ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
-                                Geom::Rect const &area,
-                                unsigned long width, unsigned long height, double xdpi, double ydpi,
-                                unsigned long bgcolor,
-                                unsigned (*status)(float, void *),
-                                void *data, bool force_overwrite,
-                                const std::vector<SPItem*> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+static void sp_export_show(SPDocument *doc, Inkscape::Drawing &drawing, unsigned dkey,
+                           Geom::Rect const &area, unsigned long width, unsigned long height,
+                           const std::vector<SPItem*> &items_only)
 {
-    g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
-    g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
-    g_return_val_if_fail(width >= 1, EXPORT_ERROR);
-    g_return_val_if_fail(height >= 1, EXPORT_ERROR);
-    g_return_val_if_fail(!area.hasZeroArea(), EXPORT_ERROR);
-
-
-    if (!force_overwrite && !sp_ui_overwrite_file(filename)) {
-        // aborted overwrite
-	return EXPORT_ABORTED;
-    }
-
-    doc->ensureUpToDate();
-
     /* Calculate translation by transforming to document coordinates (flipping Y)*/
     Geom::Point translation = -area.min();
 
@@ -455,20 +455,11 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
                             * Geom::Scale(width / area.width(),
                                         height / area.height()));
 
-    struct SPEBP ebp;
-    ebp.width  = width;
-    ebp.height = height;
-    ebp.background = bgcolor;
-
-    /* Create new drawing */
-    Inkscape::Drawing drawing;
     drawing.setExact(true); // export with maximum blur rendering quality
-    unsigned const dkey = SPItem::display_key_new(1);
 
     // Create ArenaItems and set transform
     drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
     drawing.root()->setTransform(affine);
-    ebp.drawing = &drawing;
 
     // We show all and then hide all items we don't want, instead of showing only requested items,
     // because that would not work if the shown item references something in defs
@@ -476,16 +467,80 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
         hide_other_items_recursively(doc->getRoot(), items_only, dkey);
     }
 
+    // Glyph outlines and other shared data are loaded while updating, so update the whole
+    // bitmap now; updating each strip later finds nothing left to do.
+    drawing.update(Geom::IntRect::from_xywh(0, 0, width, height));
+}
+
+/**
+ * Number of rows rendered at once. Strips rendered by several threads are split into
+ * two bands per thread.
+ */
+static unsigned long sp_export_strip_height(unsigned long width, int threads)
+{
+    unsigned long const max_bytes = 64 << 20;
+    unsigned long sheight = 64;
+    if (threads > 1) {
+        sheight = std::max(sheight, std::min(128UL * threads, max_bytes / (4 * width)));
+    }
+    return sheight;
+}
+
+/**
+ * Export an area to a PNG file
+ *
+ * @param area Area in document coordinates
+ * @param threads Number of threads rendering the bitmap; each strip of rows is split into
+ *                bands rendered concurrently, and the rows are passed on to the PNG encoder
+ *                in order.
+ */
+ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
+                                Geom::Rect const &area,
+                                unsigned long width, unsigned long height, double xdpi, double ydpi,
+                                unsigned long bgcolor,
+                                unsigned (*status)(float, void *),
+                                void *data, bool force_overwrite,
+                                const std::vector<SPItem*> &items_only, bool interlace, int color_type, int bit_depth, int zlib, int antialiasing,
+                                int threads)
+{
+    g_return_val_if_fail(doc != nullptr, EXPORT_ERROR);
+    g_return_val_if_fail(filename != nullptr, EXPORT_ERROR);
+    g_return_val_if_fail(width >= 1, EXPORT_ERROR);
+    g_return_val_if_fail(height >= 1, EXPORT_ERROR);
+    g_return_val_if_fail(!area.hasZeroArea(), EXPORT_ERROR);
+
+
+    if (!force_overwrite && !sp_ui_overwrite_file(filename)) {
+        // aborted overwrite
+	return EXPORT_ABORTED;
+    }
+
+    doc->ensureUpToDate();
+
+    struct SPEBP ebp;
+    ebp.width  = width;
+    ebp.height = height;
+    ebp.background = bgcolor;
+
+    /* Create new drawing */
+    Inkscape::Drawing drawing;
+    unsigned const dkey = SPItem::display_key_new(1);
+    sp_export_show(doc, drawing, dkey, area, width, height, items_only);
+    ebp.drawing = &drawing;
+
     ebp.status = status;
     ebp.data   = data;
+    ebp.threads = threads;
 
     bool write_status = false;;
 
-    ebp.sheight = 64;
+    ebp.sheight = sp_export_strip_height(width, threads);
     ebp.px = g_try_new(guchar, 4 * ebp.sheight * width);
 
     if (ebp.px) {
-        write_status = sp_png_write_rgba_striped(doc, filename, width, height, xdpi, ydpi, sp_export_get_rows, &ebp, interlace, color_type, bit_depth, zlib, antialiasing);
+        PngTextList textList;
+        sp_png_collect_text(doc, textList);
+        write_status = sp_png_write_rgba_striped(textList, filename, width, height, xdpi, ydpi, sp_export_get_rows, &ebp, interlace, color_type, bit_depth, zlib, antialiasing);
         g_free(ebp.px);
     }
 
@@ -495,6 +550,101 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
     return write_status ? EXPORT_OK : EXPORT_ERROR;
 }
 
+/**
+ * Export several areas to PNG files, overwriting existing files.
+ *
+ * The drawings of a batch of jobs are created one after another, and then rendered and
+ * encoded concurrently, each by a single thread. A lone job is rendered by all threads
+ * instead. The result of each export is stored in its job.
+ *
+ * @param threads Number of threads, which is also the number of files written at once.
+ */
+void sp_export_png_files(SPDocument *doc, std::vector<SPExportPNGJob> &jobs, int threads,
+                         bool interlace, int color_type, int bit_depth, int zlib, int antialiasing)
+{
+    g_return_if_fail(doc != nullptr);
+
+    for (auto &job : jobs) {
+        job.result = EXPORT_ERROR;
+    }
+    if (jobs.empty()) {
+        return;
+    }
+    threads = std::max(threads, 1);
+    if (jobs.size() == 1 || threads == 1) {
+        for (auto &job : jobs) {
+            job.result = sp_export_png_file(doc, job.filename.c_str(), job.area, job.width, job.height,
+                                            job.xdpi, job.ydpi, job.bgcolor, nullptr, nullptr, true,
+                                            job.items_only, interlace, color_type, bit_depth, zlib,
+                                            antialiasing, threads);
+        }
+        return;
+    }
+
+    doc->ensureUpToDate();
+
+    // The document must not change while the drawings are rendered, and rdf lookups are
+    // not reentrant, so the text chunks are shared by all files. The drawings share the
+    // fonts of their texts, whose glyphs are loaded under a lock (see font_instance).
+    PngTextList textList;
+    sp_png_collect_text(doc, textList);
+
+    // Several jobs per thread even out the differences in their size. Every job of a batch
+    // holds its drawing until the whole batch is done.
+    size_t const batch_size = 4 * threads;
+
+    for (size_t first = 0; first < jobs.size(); first += batch_size) {
+        int const count = std::min(batch_size, jobs.size() - first);
+
+        std::vector<std::unique_ptr<Inkscape::Drawing>> drawings(count);
+        std::vector<unsigned> dkeys(count);
+        for (int i = 0; i < count; ++i) {
+            SPExportPNGJob const &job = jobs[first + i];
+            if (job.width < 1 || job.height < 1 || job.area.hasZeroArea()) {
+                continue;
+            }
+            drawings[i].reset(new Inkscape::Drawing());
+            dkeys[i] = SPItem::display_key_new(1);
+            sp_export_show(doc, *drawings[i], dkeys[i], job.area, job.width, job.height, job.items_only);
+        }
+
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+        for (int i = 0; i < count; ++i) {
+            if (!drawings[i]) {
+                continue;
+            }
+            SPExportPNGJob &job = jobs[first + i];
+
+            struct SPEBP ebp;
+            ebp.width = job.width;
+            ebp.height = job.height;
+            ebp.background = job.bgcolor;
+            ebp.drawing = drawings[i].get();
+            ebp.status = nullptr;
+            ebp.data = nullptr;
+            ebp.threads = 1;
+            ebp.sheight = sp_export_strip_height(job.width, 1);
+            ebp.px = g_try_new(guchar, 4 * ebp.sheight * job.width);
+
+            if (ebp.px) {
+                bool write_status = sp_png_write_rgba_striped(textList, job.filename.c_str(), job.width, job.height,
+                                                              job.xdpi, job.ydpi, sp_export_get_rows, &ebp,
+                                                              interlace, color_type, bit_depth, zlib, antialiasing);
+                g_free(ebp.px);
+                job.result = write_status ? EXPORT_OK : EXPORT_ERROR;
+            }
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (drawings[i]) {
+                doc->getRoot()->invoke_hide(dkeys[i]);
+            }
+        }
+    }
+}
+
 
 /*
   Local Variables:
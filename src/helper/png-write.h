@@ -15,9 +15,12 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <string>
+#include <vector>
+
 #include <glib.h> // Only for gchar.
 
-#include <2geom/forward.h>
+#include <2geom/rect.h>
 
 class SPDocument;
 class SPItem;
@@ -38,13 +41,36 @@ ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 				unsigned long int width, unsigned long int height, double xdpi, double ydpi,
 				unsigned long bgcolor,
 				unsigned int (*status) (float, void *), void *data, bool force_overwrite = false, const std::vector<SPItem*> &items_only = std::vector<SPItem*>(), 
-                                bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2);
+                                bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2,
+                                int threads = 1);
 
 ExportResult sp_export_png_file(SPDocument *doc, gchar const *filename,
 				Geom::Rect const &area,
 				unsigned long int width, unsigned long int height, double xdpi, double ydpi,
 				unsigned long bgcolor,
 				unsigned int (*status) (float, void *), void *data, bool force_overwrite = false, const std::vector<SPItem*> &items_only = std::vector<SPItem*>(), 
-                                bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2);
+                                bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2,
+                                int threads = 1);
+
+/**
+ * One file written by sp_export_png_files().
+ */
+struct SPExportPNGJob {
+    std::string filename;
+    Geom::Rect area; ///< Area in document coordinates
+    unsigned long width;
+    unsigned long height;
+    double xdpi;
+    double ydpi;
+    unsigned long bgcolor;
+    std::vector<SPItem*> items_only;
+    ExportResult result;
+};
+
+/**
+ * Export several areas of the given document as PNG files, writing up to @a threads files at once.
+ */
+void sp_export_png_files(SPDocument *doc, std::vector<SPExportPNGJob> &jobs, int threads,
+                         bool interlace = false, int color_type = 6, int bit_depth = 8, int zlib = 6, int antialiasing = 2);
 
 #endif // SEEN_SP_PNG_WRITE_H
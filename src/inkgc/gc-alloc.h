@@ -50,7 +50,7 @@ public:
     }
 
     void construct(pointer p, const_reference value) {
-        new (static_cast<void *>(p)) T(value);
+        ::new (static_cast<void *>(p)) T(value);
     }
     void destroy(pointer p) { p->~T(); }
 
@@ -574,6 +574,7 @@ ConcreteInkscapeApplication<T>::ConcreteInkscapeApplication()
     this->add_main_option_entry(T::OPTION_TYPE_BOOL,     "export-use-hints",       't', N_("Use stored filename and DPI hints when exporting object selected by --export-id"), ""); // Bxx
     this->add_main_option_entry(T::OPTION_TYPE_STRING,   "export-background",      'b', N_("Background color for exported bitmaps (any SVG color string)"),         N_("COLOR")); // Bxx
     this->add_main_option_entry(T::OPTION_TYPE_DOUBLE,   "export-background-opacity", 'y', N_("Background opacity for exported bitmaps (0.0 to 1.0, or 1 to 255)"), N_("VALUE")); // Bxx
+    this->add_main_option_entry(T::OPTION_TYPE_INT,      "export-threads",        '\0', N_("Number of bitmaps rendered at once, or threads rendering a single bitmap"), N_("THREADS")); // Bxx
 
     // Query - Geometry
     _start_main_option_section(_("Query object/document geometry"));
@@ -1371,6 +1372,10 @@ ConcreteInkscapeApplication<T>::on_handle_local_options(const Glib::RefPtr<Glib:
         options->lookup_value("export-background-opacity", _file_export.export_background_opacity);
     }
 
+    if (options->contains("export-threads")) {
+        options->lookup_value("export-threads",   _file_export.export_threads);
+    }
+
 
     // ==================== D-BUS ======================
 
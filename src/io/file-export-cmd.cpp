@@ -13,6 +13,14 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
+#endif
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #include "file-export-cmd.h"
 
 #include <png.h> // PNG export
@@ -29,6 +37,7 @@
 #include "selection-chemistry.h" // fit_canvas_to_drawing
 #include "svg/svg-color.h" // Background color
 #include "helper/png-write.h" // PNG Export
+#include "preferences.h"
 
 #include "extension/extension.h"
 #include "extension/system.h"
@@ -54,6 +63,7 @@ InkFileExportCmd::InkFileExportCmd()
     , export_id_only(false)
     , export_background_opacity(0.0) // Transparent default
     , export_plain_svg(false)
+    , export_threads(0)
 {
 }
 
@@ -346,6 +356,9 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string filename_in)
         objects.emplace_back(); // So we do loop at least once for root.
     }
 
+    // The files are written once all of them are known, several at once.
+    std::vector<SPExportPNGJob> jobs;
+
     for (auto object_id : objects) {
 
         std::string filename_out = get_filename_out(filename_in, object_id);
@@ -540,14 +553,37 @@ InkFileExportCmd::do_export_png(SPDocument *doc, std::string filename_in)
 
         reverse(items.begin(),items.end()); // But there was only one item!
 
-        if( sp_export_png_file(doc, filename_out.c_str(), area, width, height, dpi,
-                               dpi, bgcolor, nullptr, nullptr, true, export_id_only ? items : std::vector<SPItem*>()) == 1 ) {
-        } else {
-            std::cerr << "InkFileExport::do_export_png: Failed to export to " << filename_out << std::endl;
-            continue;
-        }
+        SPExportPNGJob job;
+        job.filename = filename_out;
+        job.area = area;
+        job.width = width;
+        job.height = height;
+        job.xdpi = dpi;
+        job.ydpi = dpi;
+        job.bgcolor = bgcolor;
+        job.items_only = export_id_only ? items : std::vector<SPItem*>();
+        job.result = EXPORT_ERROR;
+        jobs.push_back(job);
 
     } // End loop over objects.
+
+    // Default to the number of threads used for rendering the canvas.
+    int threads = export_threads;
+    if (threads < 1) {
+        threads = 1;
+#if HAVE_OPENMP
+        Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+        threads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
+#endif
+    }
+
+    sp_export_png_files(doc, jobs, threads);
+
+    for (auto const &job : jobs) {
+        if (job.result != EXPORT_OK) {
+            std::cerr << "InkFileExport::do_export_png: Failed to export to " << job.filename << std::endl;
+        }
+    }
     return 0;
 }
 
@@ -63,6 +63,7 @@ public:
     Glib::ustring export_background;
     double        export_background_opacity;
     bool          export_plain_svg;
+    int           export_threads;
 };
 
 #endif // INK_FILE_EXPORT_CMD_H
@@ -466,6 +466,63 @@ void font_factory::GetUIFamilies(std::vector<PangoFontFamily *>& out)
     }
 }
 
+/*
+ * Appends a face to the style list of a family, unless the list already has a face with the
+ * same CSS values.
+ */
+static GList *sp_append_ui_style(GList *styles, Glib::ustring const &familyUIName, Glib::ustring styleUIName,
+                                 Glib::ustring const &displayName, bool warn)
+{
+    // Pango breaks the 1 to 1 mapping between Pango weights and CSS weights by
+    // adding Semi-Light (as of 1.36.7), Book (as of 1.24), and Ultra-Heavy (as of
+    // 1.24). We need to map these weights to CSS weights. Book and Ultra-Heavy
+    // are rarely used. Semi-Light (350) is problematic as it is halfway between
+    // Light (300) and Normal (400) and if care is not taken it is converted to
+    // Normal, rather than Light.
+    //
+    // Note: The ultimate solution to handling various weight in the same
+    // font family is to support the @font rules from CSS.
+    //
+    // Additional notes, helpful for debugging:
+    //   Pango's FC backend:
+    //     Weights defined in fontconfig/fontconfig.h
+    //     String equivalents in src/fcfreetype.c
+    //     Weight set from os2->usWeightClass
+    //   Use Fontforge: Element->Font Info...->OS/2->Misc->Weight Class to check font weight
+    size_t f = styleUIName.find( "Book" );
+    if( f != Glib::ustring::npos ) {
+        styleUIName.replace( f, 4, "Normal" );
+    }
+    f = styleUIName.find( "Semi-Light" );
+    if( f != Glib::ustring::npos ) {
+        styleUIName.replace( f, 10, "Light" );
+    }
+    f = styleUIName.find( "Ultra-Heavy" );
+    if( f != Glib::ustring::npos ) {
+        styleUIName.replace( f, 11, "Heavy" );
+    }
+
+    bool exists = false;
+    for(GList *temp = styles; temp; temp = temp->next) {
+        if( ((StyleNames*)temp->data)->CssName.compare( styleUIName ) == 0 ) {
+            exists = true;
+            if (warn) {
+                std::cerr << "Warning: Font face with same CSS values already added: "
+                          << familyUIName << " " << styleUIName
+                          << " (" << ((StyleNames*)temp->data)->DisplayName
+                          << ", " << displayName << ")" << std::endl;
+            }
+            break;
+        }
+    }
+
+    if (!exists && !familyUIName.empty() && !styleUIName.empty()) {
+        // Add the style information
+        styles = g_list_append(styles, new StyleNames(styleUIName, displayName));
+    }
+    return styles;
+}
+
 GList* font_factory::GetUIStyles(PangoFontFamily * in)
 {
     GList* ret = nullptr;
@@ -507,51 +564,7 @@ GList* font_factory::GetUIStyles(PangoFontFamily * in)
                 }
             }
 
-            // Pango breaks the 1 to 1 mapping between Pango weights and CSS weights by
-            // adding Semi-Light (as of 1.36.7), Book (as of 1.24), and Ultra-Heavy (as of
-            // 1.24). We need to map these weights to CSS weights. Book and Ultra-Heavy
-            // are rarely used. Semi-Light (350) is problematic as it is halfway between
-            // Light (300) and Normal (400) and if care is not taken it is converted to
-            // Normal, rather than Light.
-            //
-            // Note: The ultimate solution to handling various weight in the same
-            // font family is to support the @font rules from CSS.
-            //
-            // Additional notes, helpful for debugging:
-            //   Pango's FC backend:
-            //     Weights defined in fontconfig/fontconfig.h
-            //     String equivalents in src/fcfreetype.c
-            //     Weight set from os2->usWeightClass
-            //   Use Fontforge: Element->Font Info...->OS/2->Misc->Weight Class to check font weight
-            size_t f = styleUIName.find( "Book" );
-            if( f != Glib::ustring::npos ) {
-                styleUIName.replace( f, 4, "Normal" );
-            }
-            f = styleUIName.find( "Semi-Light" );
-            if( f != Glib::ustring::npos ) {
-                styleUIName.replace( f, 10, "Light" );
-            }
-            f = styleUIName.find( "Ultra-Heavy" );
-            if( f != Glib::ustring::npos ) {
-                styleUIName.replace( f, 11, "Heavy" );
-            }
-
-            bool exists = false;
-            for(GList *temp = ret; temp; temp = temp->next) {
-                if( ((StyleNames*)temp->data)->CssName.compare( styleUIName ) == 0 ) {
-                    exists = true;
-                    std::cerr << "Warning: Font face with same CSS values already added: "
-                              << familyUIName << " " << styleUIName
-                              << " (" << ((StyleNames*)temp->data)->DisplayName
-                              << ", " << displayName << ")" << std::endl;
-                    break;
-                }
-            }
-
-            if (!exists && !familyUIName.empty() && !styleUIName.empty()) {
-                // Add the style information
-                ret = g_list_append(ret, new StyleNames(styleUIName, displayName));
-            }
+            ret = sp_append_ui_style(ret, familyUIName, styleUIName, displayName, true);
         }
         pango_font_description_free(faceDescr);
     }
@@ -562,6 +575,18 @@ GList* font_factory::GetUIStyles(PangoFontFamily * in)
     return ret;
 }
 
+GList* font_factory::GetUIStyles(Glib::ustring const &family,
+                                 std::vector<std::pair<Glib::ustring, Glib::ustring>> const &styles)
+{
+    GList* ret = nullptr;
+    for (auto const &style : styles) {
+        // the same face may well be installed twice
+        ret = sp_append_ui_style(ret, family, style.first, style.second, false);
+    }
+    ret = g_list_sort( ret, StyleNameCompareInternalGlib );
+    return ret;
+}
+
 
 font_instance* font_factory::FaceFromStyle(SPStyle const *style)
 {
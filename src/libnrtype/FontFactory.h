@@ -19,6 +19,7 @@
 #include <functional>
 #include <algorithm>
 #include <utility>
+#include <vector>
 
 #ifdef _WIN32
 //#define USE_PANGO_WIN32 // disable for Bug 165665
@@ -118,12 +119,15 @@ public:
 
     /// Returns strings to be used in the UI for family and face (or "style" as the column is labeled)
     Glib::ustring         GetUIFamilyString(PangoFontDescription const *fontDescr);
-    Glib::ustring         GetUIStyleString(PangoFontDescription const *fontDescr);
+    static Glib::ustring  GetUIStyleString(PangoFontDescription const *fontDescr);
 
     // Helpfully inserts all font families into the provided vector
     void                  GetUIFamilies(std::vector<PangoFontFamily *>& out);
     // Retrieves style information about a family in a newly allocated GList.
     GList*                GetUIStyles(PangoFontFamily * in);
+    // Same from the (style, display name) pairs of the faces of a family, as kept by the FontCatalog.
+    GList*                GetUIStyles(Glib::ustring const &family,
+                                      std::vector<std::pair<Glib::ustring, Glib::ustring>> const &styles);
 
     /// Retrieve a font_instance from a style object, first trying to use the font-specification, the CSS information
     font_instance*        FaceFromStyle(SPStyle const *style);
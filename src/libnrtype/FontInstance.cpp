@@ -34,6 +34,7 @@
 #include <2geom/path-sink.h>
 #include "libnrtype/font-glyph.h"
 #include "libnrtype/font-instance.h"
+#include "libnrtype/glyph-cache.h"
 
 #include "display/cairo-utils.h"  // Inkscape::Pixbuf
 
@@ -155,11 +156,8 @@ font_instance::~font_instance()
     //    if ( theFace ) FT_Done_Face(theFace); // owned by pFont. don't touch
     theFace = nullptr;
 
-    for (int i=0;i<nbGlyph;i++) {
-        if ( glyphs[i].pathvector ) {
-            delete glyphs[i].pathvector;
-        }
-    }
+    // the outlines belong to the cached glyphs
+    _glyphRefs.clear();
     if ( glyphs ) {
         free(glyphs);
         glyphs = nullptr;
@@ -211,6 +209,25 @@ void font_instance::InitTheFace(bool loadgsub)
         if ( theFace ) {
             FT_Select_Charmap(theFace, ft_encoding_unicode);
             FT_Select_Charmap(theFace, ft_encoding_symbol);
+
+            // The glyphs are shared by all instances loaded from the same face
+            FcPattern *pattern = nullptr;
+#if PANGO_VERSION_CHECK(1,48,0)
+            pattern = pango_fc_font_get_pattern(PANGO_FC_FONT(pFont));
+#else
+            // not referenced, the pattern lives as long as the font
+            g_object_get(pFont, "pattern", &pattern, nullptr);
+#endif
+            FcChar8 *file = nullptr;
+            int index = 0;
+            char const *variations = nullptr;
+#if PANGO_VERSION_CHECK(1,41,1)
+            variations = pango_font_description_get_variations(descr);
+#endif
+            if (pattern && FcPatternGetString(pattern, FC_FILE, 0, &file) == FcResultMatch) {
+                FcPatternGetInteger(pattern, FC_INDEX, 0, &index);
+                _glyphFace = GlyphCache::faceKey(reinterpret_cast<char const *>(file), index, variations);
+            }
         }
 
 #endif
@@ -386,6 +403,12 @@ static inline Geom::Point pointfx_to_nrpoint(const POINTFX &p, double scale)
 #endif
 
 void font_instance::LoadGlyph(int glyph_id)
+{
+    std::lock_guard<std::mutex> lock(_glyphMutex);
+    _loadGlyph(glyph_id);
+}
+
+void font_instance::_loadGlyph(int glyph_id)
 {
     if ( pFont == nullptr ) {
         return;
@@ -398,12 +421,22 @@ void font_instance::LoadGlyph(int glyph_id)
 #endif
 
     if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-        Geom::PathBuilder path_builder;
-
         if ( nbGlyph >= maxGlyph ) {
             maxGlyph=2*nbGlyph+1;
             glyphs=(font_glyph*)realloc(glyphs,maxGlyph*sizeof(font_glyph));
         }
+
+        // Another instance of the face may have loaded the glyph already
+        GlyphCache::Glyph cached = GlyphCache::lookup(_glyphFace, glyph_id);
+        if (cached) {
+            _glyphRefs.push_back(cached);
+            glyphs[nbGlyph] = cached->glyph;
+            id_to_no[glyph_id] = nbGlyph;
+            nbGlyph++;
+            return;
+        }
+
+        Geom::PathBuilder path_builder;
         font_glyph  n_g;
         n_g.pathvector=nullptr;
         n_g.bbox[0]=n_g.bbox[1]=n_g.bbox[2]=n_g.bbox[3]=0;
@@ -540,9 +573,10 @@ void font_instance::LoadGlyph(int glyph_id)
             for (auto & i : pv) {
                 i.close();
             }
+            Geom::PathVector *outline = nullptr;
             if ( !pv.empty() ) {
-                n_g.pathvector = new Geom::PathVector(pv);
-                Geom::OptRect bounds = bounds_exact(*n_g.pathvector);
+                outline = new Geom::PathVector(pv);
+                Geom::OptRect bounds = bounds_exact(*outline);
                 if (bounds) {
                     n_g.bbox[0] = bounds->left();
                     n_g.bbox[1] = bounds->top();
@@ -550,7 +584,9 @@ void font_instance::LoadGlyph(int glyph_id)
                     n_g.bbox[3] = bounds->bottom();
                 }
             }
-            glyphs[nbGlyph]=n_g;
+            cached = GlyphCache::store(_glyphFace, glyph_id, n_g, outline);
+            _glyphRefs.push_back(cached);
+            glyphs[nbGlyph]=cached->glyph;
             id_to_no[glyph_id]=nbGlyph;
             nbGlyph++;
         }
@@ -642,19 +678,23 @@ bool font_instance::FontSlope(double &run, double &rise)
     return true;
 }
 
-Geom::OptRect font_instance::BBox(int glyph_id)
+int font_instance::_glyphIndex(int glyph_id)
 {
-    int no = -1;
-    if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-        LoadGlyph(glyph_id);
-        if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-            // didn't load
-        } else {
-            no = id_to_no[glyph_id];
+    auto it = id_to_no.find(glyph_id);
+    if (it == id_to_no.end()) {
+        _loadGlyph(glyph_id);
+        it = id_to_no.find(glyph_id);
+        if (it == id_to_no.end()) {
+            return -1; // didn't load
         }
-    } else {
-        no = id_to_no[glyph_id];
     }
+    return it->second;
+}
+
+Geom::OptRect font_instance::BBox(int glyph_id)
+{
+    std::lock_guard<std::mutex> lock(_glyphMutex);
+    int no = _glyphIndex(glyph_id);
     if ( no < 0 ) {
         return Geom::OptRect();
     } else {
@@ -666,17 +706,8 @@ Geom::OptRect font_instance::BBox(int glyph_id)
 
 Geom::PathVector* font_instance::PathVector(int glyph_id)
 {
-    int no = -1;
-    if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-        LoadGlyph(glyph_id);
-        if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-            // didn't load
-        } else {
-            no = id_to_no[glyph_id];
-        }
-    } else {
-        no = id_to_no[glyph_id];
-    }
+    std::lock_guard<std::mutex> lock(_glyphMutex);
+    int no = _glyphIndex(glyph_id);
     if ( no < 0 ) return nullptr;
     return glyphs[no].pathvector;
 }
@@ -685,6 +716,7 @@ Inkscape::Pixbuf* font_instance::PixBuf(int glyph_id)
 {
     Inkscape::Pixbuf* pixbuf = nullptr;
 
+    std::lock_guard<std::mutex> lock(_glyphMutex);
     auto glyph_iter = openTypeSVGGlyphs.find(glyph_id);
     if (glyph_iter != openTypeSVGGlyphs.end()) {
 
@@ -788,6 +820,11 @@ Inkscape::Pixbuf* font_instance::PixBuf(int glyph_id)
             // Finally create pixbuf!
             pixbuf = Inkscape::Pixbuf::create_from_buffer(svg);
 
+            // Convert it now, so that drawing it from several threads does not.
+            if (pixbuf) {
+                pixbuf->ensurePixelFormat(Inkscape::Pixbuf::PF_CAIRO);
+            }
+
             // And cache it.
             glyph_iter->second.pixbuf = pixbuf;
         }
@@ -798,17 +835,8 @@ Inkscape::Pixbuf* font_instance::PixBuf(int glyph_id)
 
 double font_instance::Advance(int glyph_id, bool vertical)
 {
-    int no = -1;
-    if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-        LoadGlyph(glyph_id);
-        if ( id_to_no.find(glyph_id) == id_to_no.end() ) {
-            // didn't load
-        } else {
-            no=id_to_no[glyph_id];
-        }
-    } else {
-        no = id_to_no[glyph_id];
-    }
+    std::lock_guard<std::mutex> lock(_glyphMutex);
+    int no = _glyphIndex(glyph_id);
     if ( no >= 0 ) {
         if ( vertical ) {
             return glyphs[no].v_advance;
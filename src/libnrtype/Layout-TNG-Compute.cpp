@@ -16,6 +16,10 @@
 #include "object/sp-object.h"
 #include "Layout-TNG-Scanline-Maker.h"
 #include <limits>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
 
 namespace Inkscape {
 namespace Text {
@@ -34,9 +38,10 @@ This class does a standard greedy paragraph wrapping algorithm.
 Very high-level overview:
 
 <pre>
-foreach(paragraph) {
-  call pango_itemize() (_buildPangoItemizationForPara())
-  break into spans, without dealing with wrapping (_buildSpansForPara())
+restore the lines of the paragraphs before the first one changed since the last layout (_resumeBreaking())
+foreach(remaining paragraph) {
+  call pango_itemize(), unless the paragraph is unchanged since the last layout (_buildPangoItemizationForPara())
+  break into spans, without dealing with wrapping, shaping those not shaped by the last layout (_buildSpansForPara())
   foreach(line in flow shape) {
     foreach(chunk in flow shape) {   (in _buildChunksInScanRun())
       // this inner loop in _measureUnbrokenSpan()
@@ -47,11 +52,143 @@ foreach(paragraph) {
     push all the glyphs, chars, spans, chunks and line to output (not completely trivial because we must draw rtl in character order) (in _outputLine())
   }
   push the paragraph (in calculate())
+  remember where the breaking stands for the next layout (_addCheckpoint())
 }
 </pre>
 
 ...and all of that needs to work vertically too, and with all the little details that make life annoying
 */
+
+/** The results of pango for the paragraphs of the last layout, by the text
+and fonts of the paragraph, and where its line breaking stood at the end of
+each paragraph. The lines of a paragraph depend on everything before it, so
+the next layout can only keep the lines of the paragraphs before the first
+one which changed. */
+struct Layout::ShapingCache
+{
+    struct Paragraph {
+        bool itemized;
+        std::vector<PangoItem *> items;
+        std::vector<font_instance *> fonts;    ///< of the items
+        std::vector<PangoLogAttr> char_attributes;
+        /** Shaped UnbrokenSpans, by their first byte and length in the paragraph. */
+        std::map<std::pair<unsigned, unsigned>, PangoGlyphString *> glyph_strings;
+
+        Paragraph() : itemized(false) {}
+        Paragraph(Paragraph const &) = delete;
+        Paragraph &operator=(Paragraph const &) = delete;
+        ~Paragraph()
+        {
+            for (auto item : items)
+                pango_item_free(item);
+            for (auto font : fonts)
+                if (font)
+                    font->Unref();
+            for (auto &glyph_string : glyph_strings)
+                pango_glyph_string_free(glyph_string.second);
+        }
+    };
+    typedef std::unordered_map<std::string, std::unique_ptr<Paragraph>> Paragraphs;
+
+    Paragraphs paragraphs;
+
+    /** Where the text of an output span starts: the index of its text source
+    in the input stream and the byte offset from the beginning of the source,
+    or -1 for spans with no text. */
+    typedef std::pair<int, std::ptrdiff_t> SpanText;
+
+    /** Where the line breaking stood at the end of a paragraph. */
+    struct Checkpoint {
+        std::string shaping_key;     ///< of the paragraph, see Calculator::_buildPangoItemizationForPara()
+        std::string layout_key;      ///< of the paragraph, see Calculator::_paragraphLayoutKey()
+        unsigned next_input_index;   ///< where the next paragraph starts
+        unsigned shape_index;
+        double y;                    ///< of the scanline maker
+        double y_offset;
+        FontMetrics line_box_height;
+        // the sizes of the output arrays
+        unsigned paragraphs;
+        unsigned lines;
+        unsigned chunks;
+        unsigned spans;
+        unsigned characters;
+        unsigned glyphs;
+    };
+
+    std::string setup;   ///< see Calculator::_layoutSetup()
+    std::vector<Checkpoint> checkpoints;
+
+    /** The output of the last layout up to its last checkpoint, as it was
+    calculated, that is before any fitToPathAlign(). */
+    struct Output {
+        std::vector<Layout::Paragraph> paragraphs;
+        std::vector<Line> lines;
+        std::vector<Chunk> chunks;
+        std::vector<Span> spans;             ///< holding a reference on their fonts
+        std::vector<SpanText> span_texts;    ///< of the spans
+        std::vector<Character> characters;
+        std::vector<Glyph> glyphs;
+    } output;
+
+    CalculationStats stats;
+
+    ShapingCache() : _recent(false)
+    {
+        stats = CalculationStats();
+    }
+    ShapingCache(ShapingCache const &) = delete;
+    ShapingCache &operator=(ShapingCache const &) = delete;
+    ~ShapingCache()
+    {
+        if (_recent)
+            _recentList().erase(_position);
+        forgetBreaking();
+    }
+
+    void forgetBreaking()
+    {
+        for (auto &span : output.spans)
+            if (span.font)
+                span.font->Unref();
+        output = Output();
+        checkpoints.clear();
+        setup.clear();
+    }
+
+    /** Marks the shaping as the most recently laid out one. Only the shaping of the
+    few layouts calculated last is kept: texts which are being edited are laid out
+    over and over, while static texts are not laid out again, so they need not hold
+    on to copies of all their glyphs. */
+    void touch()
+    {
+        std::list<ShapingCache *> &recent = _recentList();
+        if (_recent)
+            recent.erase(_position);
+        recent.push_front(this);
+        _position = recent.begin();
+        _recent = true;
+
+        while (recent.size() > MAX_RECENT) {
+            ShapingCache *oldest = recent.back();
+            recent.pop_back();
+            oldest->_recent = false;
+            oldest->paragraphs.clear();
+            oldest->forgetBreaking();
+        }
+    }
+
+private:
+    static unsigned const MAX_RECENT = 16;
+    static std::list<ShapingCache *> &_recentList()
+    {
+        static std::list<ShapingCache *> recent;
+        return recent;
+    }
+
+    bool _recent;
+    std::list<ShapingCache *>::iterator _position;
+};
+
 class Layout::Calculator
 {
     class SpanPosition;
@@ -79,6 +216,18 @@ class Layout::Calculator
     PANGO_SCALE. See font_factory::font_factory(). */
     double _font_factory_size_multiplier;
 
+    /** The paragraphs shaped by the previous layout which have not been
+    found again yet. Those which have move back to _flow._shaping_cache. */
+    ShapingCache::Paragraphs _previous_shaping;
+
+    /** Where the line breaking of this layout stood at the end of its
+    paragraphs, up to the first one it can't be resumed after. */
+    std::vector<ShapingCache::Checkpoint> _checkpoints;
+    bool _checkpointing;
+
+    /** The text of each span of the output, see ShapingCache::SpanText. */
+    std::vector<ShapingCache::SpanText> _span_texts;
+
     /** Temporary storage associated with each item in Layout::_input_stream. */
     struct InputItemInfo {
         bool in_sub_flow;
@@ -174,6 +323,8 @@ class Layout::Calculator
         std::vector<PangoItemInfo> pango_items;
         std::vector<PangoLogAttr> char_attributes;    ///< For every character in the paragraph.
         std::vector<UnbrokenSpan> unbroken_spans;
+        ShapingCache::Paragraph *shaping = nullptr;   ///< Owned by _flow._shaping_cache.
+        std::string shaping_key;                      ///< Of #shaping.
 
         template<typename T> static void free_sequence(T &seq)
         {
@@ -238,9 +389,16 @@ class Layout::Calculator
         int whitespace_count;
     };
 
-    void _buildPangoItemizationForPara(ParagraphInfo *para) const;
+    ShapingCache::Paragraph *_findShaping(std::string const &key);
+    bool _layoutSetup(std::string *setup) const;
+    unsigned _paragraphLayoutKey(unsigned first_input_index, std::string *key) const;
+    unsigned _resumeBreaking(std::string const &setup, FontMetrics *line_box_height);
+    void _addCheckpoint(ParagraphInfo const &para, unsigned para_end_input_index,
+                        FontMetrics const &line_box_height);
+    void _saveBreaking(std::string const &setup);
+    void _buildPangoItemizationForPara(ParagraphInfo *para);
     static double _computeFontLineHeight( SPStyle const *style ); // Returns line_height_multiplier
-    unsigned _buildSpansForPara(ParagraphInfo *para) const;
+    unsigned _buildSpansForPara(ParagraphInfo *para);
     bool _goToNextWrapShape();
     void _createFirstScanlineMaker();
 
@@ -692,12 +850,16 @@ void Layout::Calculator::_outputLine(ParagraphInfo const &para,
             new_span.baseline_shift = 0.0;
             new_span.block_progression = _block_progression;
             new_span.text_orientation = unbroken_span.text_orientation;
+            ShapingCache::SpanText new_span_text(-1, 0);
             if ((_flow._input_stream[unbroken_span.input_index]->Type() == TEXT_SOURCE) && (new_span.font = para.pango_items[unbroken_span.pango_item_index].font))
             {
                 new_span.font->Ref();
                 new_span.font_size = unbroken_span.font_size;
                 new_span.direction = para.pango_items[unbroken_span.pango_item_index].item->analysis.level & 1 ? RIGHT_TO_LEFT : LEFT_TO_RIGHT;
                 new_span.input_stream_first_character = Glib::ustring::const_iterator(unbroken_span.input_stream_first_character.base() + it_span->start.char_byte);
+                InputStreamTextSource const *text_source = static_cast<InputStreamTextSource const *>(_flow._input_stream[unbroken_span.input_index]);
+                new_span_text.first = unbroken_span.input_index;
+                new_span_text.second = new_span.input_stream_first_character.base() - text_source->text_begin.base();
             } else {  // a control code
                 new_span.font = nullptr;
                 new_span.font_size = new_span.line_height.emSize();
@@ -942,6 +1104,7 @@ void Layout::Calculator::_outputLine(ParagraphInfo const &para,
 
             new_span.x_end = new_span.x_start + x_in_span_last;
             _flow._spans.push_back(new_span);
+            _span_texts.push_back(new_span_text);
             previous_direction = new_span.direction;
         }
         // end adding spans to the list, on to the next chunk...
@@ -1089,16 +1252,322 @@ void Layout::Calculator::BrokenSpan::setZero()
 //    }
 //}
 
+/**
+ * Returns the shaping of the paragraph described by \a key in this layout or
+ * in the previous one, or a new empty one.
+ */
+Layout::ShapingCache::Paragraph *Layout::Calculator::_findShaping(std::string const &key)
+{
+    ShapingCache::Paragraphs &current = _flow._shaping_cache->paragraphs;
+    auto found = current.find(key);
+    if (found != current.end())
+        return found->second.get();   // the same paragraph appears twice
+
+    std::unique_ptr<ShapingCache::Paragraph> shaping;
+    auto previous = _previous_shaping.find(key);
+    if (previous != _previous_shaping.end()) {
+        shaping = std::move(previous->second);
+        _previous_shaping.erase(previous);
+    } else {
+        shaping.reset(new ShapingCache::Paragraph);
+    }
+    return current.emplace(key, std::move(shaping)).first->second.get();
+}
+
+/** Appends the bytes of \a value to \a key. */
+template<typename T>
+static void append_to_key(std::string *key, T value)
+{
+    key->append(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+static void append_to_key(std::string *key, Layout::FontMetrics const &metrics)
+{
+    append_to_key(key, metrics.ascent);
+    append_to_key(key, metrics.descent);
+    append_to_key(key, metrics.xheight);
+    append_to_key(key, metrics.ascent_max);
+    append_to_key(key, metrics.descent_max);
+}
+
+static void append_to_key(std::string *key, std::vector<SVGLength> const &lengths)
+{
+    append_to_key(key, lengths.size());
+    for (auto const &length : lengths) {
+        append_to_key(key, static_cast<bool>(length._set));
+        append_to_key(key, length.computed);
+    }
+}
+
+/** Appends everything the layout reads from \a style to \a key. */
+static void append_style_to_key(std::string *key, SPStyle *style)
+{
+    PangoFontDescription *font_description = ink_font_description_from_style(style);
+    gchar *font_description_string = pango_font_description_to_string(font_description);
+    *key += font_description_string;
+    *key += '\n';
+    g_free(font_description_string);
+    pango_font_description_free(font_description);
+#if PANGO_VERSION_CHECK(1,37,1)
+    *key += style->getFontFeatureString();
+    *key += '\n';
+#endif
+    append_to_key(key, style->font_size.computed);
+    append_to_key(key, static_cast<bool>(style->line_height.normal));
+    append_to_key(key, static_cast<unsigned>(style->line_height.unit));
+    append_to_key(key, style->line_height.computed);
+    append_to_key(key, style->letter_spacing.computed);
+    append_to_key(key, style->word_spacing.computed);
+    append_to_key(key, style->baseline_shift.computed);
+    append_to_key(key, style->direction.computed);
+    append_to_key(key, style->writing_mode.computed);
+    append_to_key(key, style->text_orientation.computed);
+    append_to_key(key, style->dominant_baseline.computed);
+}
+
+/**
+ * Describes everything the lines of the paragraph starting at
+ * \a first_input_index depend on, apart from where the paragraphs before
+ * it ended: its text, styles and positioning attributes.
+ *
+ * Output: \a key.
+ * Returns: the index of the input item ending the paragraph, the same as
+ * _buildSpansForPara().
+ */
+unsigned Layout::Calculator::_paragraphLayoutKey(unsigned first_input_index, std::string *key) const
+{
+    unsigned input_index;
+    for (input_index = first_input_index ; input_index < _flow._input_stream.size() ; input_index++) {
+        InputStreamItem *item = _flow._input_stream[input_index];
+        append_to_key(key, item->Type());
+        SPObject *object = static_cast<SPObject *>(item->source_cookie);
+
+        if (item->Type() == CONTROL_CODE) {
+            InputStreamControlCode const *control_code = static_cast<InputStreamControlCode const *>(item);
+            append_to_key(key, control_code->code);
+            append_to_key(key, control_code->ascent);
+            append_to_key(key, control_code->descent);
+            append_to_key(key, control_code->width);
+            // the style of breaks gives the height of empty lines
+            append_to_key(key, object && object->style);
+            if (object && object->style)
+                append_style_to_key(key, object->style);
+            if (   control_code->code == SHAPE_BREAK
+                   || control_code->code == PARAGRAPH_BREAK)
+                break;
+
+        } else if (item->Type() == TEXT_SOURCE) {
+            InputStreamTextSource const *text_source = static_cast<InputStreamTextSource const *>(item);
+            std::string::size_type const text_bytes = text_source->text_end.base() - text_source->text_begin.base();
+            append_to_key(key, text_bytes);
+            if (text_bytes)
+                key->append(&*text_source->text_begin.base(), text_bytes);
+            std::string const lang = object ? object->lang.raw() : std::string();
+            append_to_key(key, lang.size());
+            *key += lang;
+            append_style_to_key(key, text_source->style);
+            append_to_key(key, text_source->x);
+            append_to_key(key, text_source->y);
+            append_to_key(key, text_source->dx);
+            append_to_key(key, text_source->dy);
+            append_to_key(key, text_source->rotate);
+            append_to_key(key, static_cast<bool>(text_source->textLength._set));
+            append_to_key(key, text_source->textLength.computed);
+            append_to_key(key, text_source->lengthAdjust);
+            if (input_index == first_input_index) {
+                // the alignment of the paragraph also depends on the ancestors of the style
+                Direction direction = text_source->style->direction.computed == SP_CSS_DIRECTION_LTR ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
+                append_to_key(key, text_source->styleGetAlignment(direction, !_flow._input_wrap_shapes.empty()));
+            }
+        }
+    }
+    return input_index;
+}
+
+/**
+ * Describes everything the line breaking depends on apart from the
+ * paragraphs: the wrap shapes and the settings of the whole flow.
+ *
+ * Output: \a setup.
+ * Returns: false if the lines of a paragraph also depend on the paragraphs
+ * after it, in which case the breaking can never be resumed.
+ */
+bool Layout::Calculator::_layoutSetup(std::string *setup) const
+{
+    // the length of the whole text is spread over all its characters
+    if (_flow.textLength._set)
+        return false;
+
+    append_to_key(setup, _flow.wrap_mode);
+    append_to_key(setup, _flow.lengthAdjust);
+    append_to_key(setup, _block_progression);
+    append_to_key(setup, _flow._blockTextOrientation());
+    append_to_key(setup, _flow._blockBaseline());
+    append_to_key(setup, _font_factory_size_multiplier);
+    append_to_key(setup, _flow.strut);
+    for (auto const &wrap_shape : _flow._input_wrap_shapes) {
+        Shape const *shape = wrap_shape.shape;
+        append_to_key(setup, wrap_shape.display_align);
+        append_to_key(setup, shape->numberOfPoints());
+        for (int i = 0 ; i < shape->numberOfPoints() ; i++) {
+            append_to_key(setup, shape->getPoint(i).x[Geom::X]);
+            append_to_key(setup, shape->getPoint(i).x[Geom::Y]);
+        }
+        append_to_key(setup, shape->numberOfEdges());
+        for (int i = 0 ; i < shape->numberOfEdges() ; i++) {
+            append_to_key(setup, shape->getEdge(i).st);
+            append_to_key(setup, shape->getEdge(i).en);
+        }
+    }
+    return true;
+}
+
+/**
+ * Restores the output and the state of the line breaking of the previous
+ * layout at the end of the last paragraph before the first one which
+ * changed, together with the shaping of the paragraphs before it.
+ *
+ * Input: the input stream, the setup of this layout.
+ * Output: the output arrays of #_flow, #_scanline_maker and the rest of the
+ * state of the breaking, \a line_box_height.
+ * Returns: the index of the first input item to break into lines.
+ */
+unsigned Layout::Calculator::_resumeBreaking(std::string const &setup, FontMetrics *line_box_height)
+{
+    ShapingCache &cache = *_flow._shaping_cache;
+    if (cache.setup != setup)
+        return 0;
+
+    unsigned kept = 0;
+    unsigned input_index = 0;
+    for (auto const &checkpoint : cache.checkpoints) {
+        std::string key;
+        if (checkpoint.next_input_index >= _flow._input_stream.size()
+            || _paragraphLayoutKey(input_index, &key) + 1 != checkpoint.next_input_index
+            || key != checkpoint.layout_key)
+            break;
+        input_index = checkpoint.next_input_index;
+        kept++;
+    }
+    if (kept == 0)
+        return 0;
+    TRACE(("keeping the lines of %u paragraphs\n", kept));
+
+    ShapingCache::Checkpoint const &checkpoint = cache.checkpoints[kept - 1];
+    ShapingCache::Output const &output = cache.output;
+    _flow._paragraphs.assign(output.paragraphs.begin(), output.paragraphs.begin() + checkpoint.paragraphs);
+    _flow._lines.assign(output.lines.begin(), output.lines.begin() + checkpoint.lines);
+    _flow._chunks.assign(output.chunks.begin(), output.chunks.begin() + checkpoint.chunks);
+    _flow._characters.assign(output.characters.begin(), output.characters.begin() + checkpoint.characters);
+    _flow._glyphs.assign(output.glyphs.begin(), output.glyphs.begin() + checkpoint.glyphs);
+    _flow._spans.assign(output.spans.begin(), output.spans.begin() + checkpoint.spans);
+    _span_texts.assign(output.span_texts.begin(), output.span_texts.begin() + checkpoint.spans);
+    for (unsigned i = 0 ; i < _flow._spans.size() ; i++) {
+        Layout::Span &span = _flow._spans[i];
+        if (span.font)
+            span.font->Ref();
+        // the text is the same, but its storage may not be
+        span.input_stream_first_character = Glib::ustring::const_iterator();
+        if (_span_texts[i].first >= 0) {
+            InputStreamTextSource const *text_source = static_cast<InputStreamTextSource const *>(_flow._input_stream[_span_texts[i].first]);
+            span.input_stream_first_character = Glib::ustring::const_iterator(text_source->text_begin.base() + _span_texts[i].second);
+        }
+    }
+
+    ShapingCache::Paragraphs &current = _flow._shaping_cache->paragraphs;
+    for (unsigned i = 0 ; i < kept ; i++) {
+        auto previous = _previous_shaping.find(cache.checkpoints[i].shaping_key);
+        if (previous != _previous_shaping.end()) {
+            current.emplace(previous->first, std::move(previous->second));
+            _previous_shaping.erase(previous);
+        }
+    }
+    _checkpoints.assign(cache.checkpoints.begin(), cache.checkpoints.begin() + kept);
+
+    if (checkpoint.shape_index != _current_shape_index) {
+        delete _scanline_maker;
+        _current_shape_index = checkpoint.shape_index;
+        _scanline_maker = new ShapeScanlineMaker(_flow._input_wrap_shapes[_current_shape_index].shape, _block_progression);
+    }
+    _scanline_maker->setNewYCoordinate(checkpoint.y);
+    _y_offset = checkpoint.y_offset;
+    *line_box_height = checkpoint.line_box_height;
+    return checkpoint.next_input_index;
+}
+
+/**
+ * Records where the line breaking stands at the end of the paragraph
+ * \a para, so that the next layout can start from here if neither this
+ * paragraph nor the ones before it change.
+ */
+void Layout::Calculator::_addCheckpoint(ParagraphInfo const &para, unsigned para_end_input_index,
+                                        FontMetrics const &line_box_height)
+{
+    if (!_checkpointing)
+        return;
+    // the last paragraph is laid out differently when more follow
+    std::string key;
+    _checkpointing = _scanline_maker != nullptr
+                     && para_end_input_index + 1 < _flow._input_stream.size()
+                     && _paragraphLayoutKey(para.first_input_index, &key) == para_end_input_index;
+    if (!_checkpointing)
+        return;
+
+    ShapingCache::Checkpoint checkpoint;
+    checkpoint.shaping_key = para.shaping_key;
+    checkpoint.layout_key = std::move(key);
+    checkpoint.next_input_index = para_end_input_index + 1;
+    checkpoint.shape_index = _current_shape_index;
+    checkpoint.y = _scanline_maker->yCoordinate();
+    checkpoint.y_offset = _y_offset;
+    checkpoint.line_box_height = line_box_height;
+    checkpoint.paragraphs = _flow._paragraphs.size();
+    checkpoint.lines = _flow._lines.size();
+    checkpoint.chunks = _flow._chunks.size();
+    checkpoint.spans = _flow._spans.size();
+    checkpoint.characters = _flow._characters.size();
+    checkpoint.glyphs = _flow._glyphs.size();
+    _checkpoints.push_back(std::move(checkpoint));
+}
+
+/**
+ * Keeps the checkpoints of this layout, and its output up to the last of
+ * them, for the next layout.
+ */
+void Layout::Calculator::_saveBreaking(std::string const &setup)
+{
+    ShapingCache &cache = *_flow._shaping_cache;
+    cache.forgetBreaking();
+    if (_checkpoints.empty())
+        return;
+
+    ShapingCache::Checkpoint const &checkpoint = _checkpoints.back();
+    ShapingCache::Output &output = cache.output;
+    output.paragraphs.assign(_flow._paragraphs.begin(), _flow._paragraphs.begin() + checkpoint.paragraphs);
+    output.lines.assign(_flow._lines.begin(), _flow._lines.begin() + checkpoint.lines);
+    output.chunks.assign(_flow._chunks.begin(), _flow._chunks.begin() + checkpoint.chunks);
+    output.characters.assign(_flow._characters.begin(), _flow._characters.begin() + checkpoint.characters);
+    output.glyphs.assign(_flow._glyphs.begin(), _flow._glyphs.begin() + checkpoint.glyphs);
+    output.spans.assign(_flow._spans.begin(), _flow._spans.begin() + checkpoint.spans);
+    output.span_texts.assign(_span_texts.begin(), _span_texts.begin() + checkpoint.spans);
+    for (auto &span : output.spans)
+        if (span.font)
+            span.font->Ref();
+    cache.setup = setup;
+    cache.checkpoints.swap(_checkpoints);
+}
+
 /**
  * Take all the text from \a _para.first_input_index to the end of the
  * paragraph and stitch it together so that pango_itemize() can be called on
- * the whole thing.
+ * the whole thing. If the same text was itemized with the same fonts by the
+ * previous layout, its items are reused instead.
  *
  * Input: para.first_input_index.
- * Output: para.direction, para.pango_items, para.char_attributes.
+ * Output: para.direction, para.pango_items, para.char_attributes, para.shaping.
  * Returns: the number of spans created by pango_itemize
  */
-void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) const
+void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para)
 {
     TRACE(("pango version string: %s\n", pango_version_string() ));
 #if PANGO_VERSION_CHECK(1,37,1)
@@ -1108,6 +1577,8 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
     Glib::ustring para_text;
     PangoAttrList *attributes_list;
     unsigned input_index;
+    // everything pango_itemize() and pango_shape() depend on
+    std::string key = std::to_string(_block_progression) + ' ' + std::to_string(_flow._blockTextOrientation());
 
     para->free_sequence(para->pango_items);
     para->char_attributes.clear();
@@ -1126,11 +1597,28 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
         } else if (_flow._input_stream[input_index]->Type() == TEXT_SOURCE) {
             Layout::InputStreamTextSource *text_source = static_cast<Layout::InputStreamTextSource *>(_flow._input_stream[input_index]);
 
+            auto const text_bytes = text_source->text_end.base() - text_source->text_begin.base();
+            key += '\n';
+            key += std::to_string(text_bytes);
+            key += '\n';
+            key.append(&*text_source->text_begin.base(), text_bytes);
+
             // create the font_instance
             font_instance *font = text_source->styleGetFontInstance();
             if (font == nullptr)
                 continue;  // bad news: we'll have to ignore all this text because we know of no font to render it
 
+            gchar *font_description_string = pango_font_description_to_string(font->descr);
+            key += '\n';
+            key += font_description_string;
+            g_free(font_description_string);
+            key += '\n';
+#if PANGO_VERSION_CHECK(1,37,1)
+            key += text_source->style->getFontFeatureString();
+#endif
+            key += '\n';
+            key += static_cast<SPObject *>(text_source->source_cookie)->lang;
+
             PangoAttribute *attribute_font_description = pango_attr_font_desc_new(font->descr);
             attribute_font_description->start_index = para_text.bytes();
 
@@ -1163,14 +1651,37 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
 
     TRACE(("whole para: \"%s\"\n", para_text.data()));
     TRACE(("%d input sources used\n", input_index - para->first_input_index));
-    // do the pango_itemize()
-    GList *pango_items_glist = nullptr;
     para->direction = LEFT_TO_RIGHT; // CSS default
-    if (_flow._input_stream[para->first_input_index]->Type() == TEXT_SOURCE) {
+    bool has_base_direction = _flow._input_stream[para->first_input_index]->Type() == TEXT_SOURCE;
+    if (has_base_direction) {
         Layout::InputStreamTextSource const *text_source = static_cast<Layout::InputStreamTextSource *>(_flow._input_stream[para->first_input_index]);
+        para->direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
+        key.insert(0, para->direction == LEFT_TO_RIGHT ? "ltr " : "rtl ");
+    }
 
-        para->direction =                (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? LEFT_TO_RIGHT : RIGHT_TO_LEFT;
-        PangoDirection pango_direction = (text_source->style->direction.computed == SP_CSS_DIRECTION_LTR) ? PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL;
+    para->shaping_key = key;
+    para->shaping = _findShaping(key);
+    if (para->shaping->itemized) {
+        TRACE(("para unchanged, reusing %lu items\n", para->shaping->items.size()));
+        pango_attr_list_unref(attributes_list);
+        para->pango_items.reserve(para->shaping->items.size());
+        for (unsigned i = 0 ; i < para->shaping->items.size() ; i++) {
+            PangoItemInfo new_item;
+            new_item.item = pango_item_copy(para->shaping->items[i]);
+            new_item.font = para->shaping->fonts[i];
+            if (new_item.font)
+                new_item.font->Ref();
+            para->pango_items.push_back(new_item);
+        }
+        para->char_attributes = para->shaping->char_attributes;
+        return;
+    }
+    _flow._shaping_cache->stats.itemized_paragraphs++;
+
+    // do the pango_itemize()
+    GList *pango_items_glist = nullptr;
+    if (has_base_direction) {
+        PangoDirection pango_direction = para->direction == LEFT_TO_RIGHT ? PANGO_DIRECTION_LTR : PANGO_DIRECTION_RTL;
         pango_items_glist = pango_itemize_with_base_dir(_pango_context, pango_direction, para_text.data(), 0, para_text.bytes(), attributes_list, nullptr);
     }
 
@@ -1191,12 +1702,19 @@ void  Layout::Calculator::_buildPangoItemizationForPara(ParagraphInfo *para) con
         new_item.font = (font_factory::Default())->Face(font_description);
         pango_font_description_free(font_description);   // Face() makes a copy
         para->pango_items.push_back(new_item);
+
+        para->shaping->items.push_back(pango_item_copy(new_item.item));
+        para->shaping->fonts.push_back(new_item.font);
+        if (new_item.font)
+            new_item.font->Ref();
     }
     g_list_free(pango_items_glist);
 
     // and get the character attributes on everything
     para->char_attributes.resize(para_text.length() + 1);
     pango_get_log_attrs(para_text.data(), para_text.bytes(), -1, nullptr, &*para->char_attributes.begin(), para->char_attributes.size());
+    para->shaping->char_attributes = para->char_attributes;
+    para->shaping->itemized = true;
 
     TRACE(("end para itemize, direction = %d\n", para->direction));
 }
@@ -1239,7 +1757,7 @@ bool compareGlyphWidth(const PangoGlyphInfo &a, const PangoGlyphInfo &b)
  * Output: para->spans
  * Returns: the index of the beginning of the following paragraph in _flow._input_stream
  */
-unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para) const
+unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para)
 {
     unsigned pango_item_index = 0;
     unsigned char_index_in_para = 0;
@@ -1364,98 +1882,107 @@ unsigned Layout::Calculator::_buildSpansForPara(ParagraphInfo *para) const
                 // now we know the length, do some final calculations and add the UnbrokenSpan to the list
                 new_span.font_size = text_source->style->font_size.computed * _flow.getTextLengthMultiplierDue();
                 if (new_span.text_bytes) {
-                    new_span.glyph_string = pango_glyph_string_new();
-                    /* Some assertions intended to help diagnose bug #1277746. */
-                    g_assert( 0 < new_span.text_bytes );
-                    g_assert( span_start_byte_in_source < text_source->text->bytes() );
-                    g_assert( span_start_byte_in_source + new_span.text_bytes <= text_source->text->bytes() );
-                    g_assert( memchr(text_source->text->data() + span_start_byte_in_source, '\0', static_cast<size_t>(new_span.text_bytes))
-                              == nullptr );
-
-                    /* Notes as of 4/29/13.  Pango_shape is not generating English language ligatures, but it is generating
-                    them for Hebrew (and probably other similar languages).  In the case observed 3 unicode characters (a base
-                    and 2 Mark, nonspacings) are merged into two glyphs (the base + first Mn, the 2nd Mn).  All of these map
-                    from glyph to first character of the log_cluster range.  This destroys the 1:1 correspondence between
-                    characters and glyphs.  A big chunk of the conditional code which immediately follows this call
-                    is there to clean up the resulting mess.
-                    */
+                    // Spans shaped by the previous layout of the paragraph only need copying
+                    std::pair<unsigned, unsigned> const shaping_key(byte_index_in_para, new_span.text_bytes);
+                    auto shaped = para->shaping->glyph_strings.find(shaping_key);
+                    if (shaped != para->shaping->glyph_strings.end()) {
+                        new_span.glyph_string = pango_glyph_string_copy(shaped->second);
+                    } else {
+                        new_span.glyph_string = pango_glyph_string_new();
+                        /* Some assertions intended to help diagnose bug #1277746. */
+                        g_assert( 0 < new_span.text_bytes );
+                        g_assert( span_start_byte_in_source < text_source->text->bytes() );
+                        g_assert( span_start_byte_in_source + new_span.text_bytes <= text_source->text->bytes() );
+                        g_assert( memchr(text_source->text->data() + span_start_byte_in_source, '\0', static_cast<size_t>(new_span.text_bytes))
+                                  == nullptr );
+
+                        /* Notes as of 4/29/13.  Pango_shape is not generating English language ligatures, but it is generating
+                        them for Hebrew (and probably other similar languages).  In the case observed 3 unicode characters (a base
+                        and 2 Mark, nonspacings) are merged into two glyphs (the base + first Mn, the 2nd Mn).  All of these map
+                        from glyph to first character of the log_cluster range.  This destroys the 1:1 correspondence between
+                        characters and glyphs.  A big chunk of the conditional code which immediately follows this call
+                        is there to clean up the resulting mess.
+                        */
                     
-                    // Convert characters to glyphs
-                    pango_shape(text_source->text->data() + span_start_byte_in_source,
-                                new_span.text_bytes,
-                                &para->pango_items[pango_item_index].item->analysis,
-                                new_span.glyph_string);
-
-                    if (para->pango_items[pango_item_index].item->analysis.level & 1) {
-                        // pango_shape() will reorder glyphs in rtl sections into visual order which messes
-                        // us up because the svg spec requires us to draw glyphs in logical order
-                        // let's reverse the glyphstring on a cluster-by-cluster basis
-                        const unsigned nglyphs = new_span.glyph_string->num_glyphs;
-                        std::vector<PangoGlyphInfo> infos(nglyphs);
-                        std::vector<gint>           clusters(nglyphs);
-                        unsigned i, j;
-                        for (i = 0 ; i < nglyphs ; i++)new_span.glyph_string->glyphs[i].attr.is_cluster_start = 0;
-                        for (i = 0 ; i < nglyphs ; i++) {
-                            j=i;
-                            while(  (j < nglyphs-1) &&  
-                                    (new_span.glyph_string->log_clusters[j+1] == new_span.glyph_string->log_clusters[i])
-                            )j++;
-                            /*      
-                            CAREFUL, within a log_cluster the order of glyphs may not map 1:1, or
-                            even in the same order, to the original unicode characters!!!  Among
-                            other things, diacritical mark glyphs can end up sequentially in front of the base
-                            character glyph.  That makes determining kerning, even approximately, difficult
-                            later on.  
+                        // Convert characters to glyphs
+                        _flow._shaping_cache->stats.shaped_spans++;
+                        pango_shape(text_source->text->data() + span_start_byte_in_source,
+                                    new_span.text_bytes,
+                                    &para->pango_items[pango_item_index].item->analysis,
+                                    new_span.glyph_string);
+
+                        if (para->pango_items[pango_item_index].item->analysis.level & 1) {
+                            // pango_shape() will reorder glyphs in rtl sections into visual order which messes
+                            // us up because the svg spec requires us to draw glyphs in logical order
+                            // let's reverse the glyphstring on a cluster-by-cluster basis
+                            const unsigned nglyphs = new_span.glyph_string->num_glyphs;
+                            std::vector<PangoGlyphInfo> infos(nglyphs);
+                            std::vector<gint>           clusters(nglyphs);
+                            unsigned i, j;
+                            for (i = 0 ; i < nglyphs ; i++)new_span.glyph_string->glyphs[i].attr.is_cluster_start = 0;
+                            for (i = 0 ; i < nglyphs ; i++) {
+                                j=i;
+                                while(  (j < nglyphs-1) &&  
+                                        (new_span.glyph_string->log_clusters[j+1] == new_span.glyph_string->log_clusters[i])
+                                )j++;
+                                /*      
+                                CAREFUL, within a log_cluster the order of glyphs may not map 1:1, or
+                                even in the same order, to the original unicode characters!!!  Among
+                                other things, diacritical mark glyphs can end up sequentially in front of the base
+                                character glyph.  That makes determining kerning, even approximately, difficult
+                                later on.  
                             
-                            To resolve this to the extent possible sort the glyphs within the same
-                            log_cluster into descending order by width in a special manner before copying.  Diacritical marks
-                            and similar have zero width and the glyph they modify has nonzero width.  The order 
-                            of the zero width ones does not matter.  A logical cluster is sorted into sequential order
-                               [base] [zw_modifier1] [zw_modifier2] 
-                            where all the modifiers have zero width and the base does not. This works for languages like Hebrew. 
+                                To resolve this to the extent possible sort the glyphs within the same
+                                log_cluster into descending order by width in a special manner before copying.  Diacritical marks
+                                and similar have zero width and the glyph they modify has nonzero width.  The order 
+                                of the zero width ones does not matter.  A logical cluster is sorted into sequential order
+                                   [base] [zw_modifier1] [zw_modifier2] 
+                                where all the modifiers have zero width and the base does not. This works for languages like Hebrew. 
                             
-                            Pango also creates log clusters for languages like Telugu having many glyphs with nonzero widths. 
-                            Since these are nonzero, their order is not modified.
+                                Pango also creates log clusters for languages like Telugu having many glyphs with nonzero widths. 
+                                Since these are nonzero, their order is not modified.
                             
-                            If some language mixes these modes, having a log cluster having something like 
-                               [base1] [zw_modifier1] [base2] [zw_modifier2]
-                            the result will be incorrect: 
-                               base1] [base2] [zw_modifier1] [zw_modifier2]
+                                If some language mixes these modes, having a log cluster having something like 
+                                   [base1] [zw_modifier1] [base2] [zw_modifier2]
+                                the result will be incorrect: 
+                                   base1] [base2] [zw_modifier1] [zw_modifier2]
 
                                
-                            If ligatures other than with Mark, nonspacing are ever implemented in Pango this will screw up, for instance
-                            changing "fi" to "if".
-                            */
-                            if(j - i){
-                                std::sort(&(new_span.glyph_string->glyphs[i]), &(new_span.glyph_string->glyphs[j+1]), compareGlyphWidth);
+                                If ligatures other than with Mark, nonspacing are ever implemented in Pango this will screw up, for instance
+                                changing "fi" to "if".
+                                */
+                                if(j - i){
+                                    std::sort(&(new_span.glyph_string->glyphs[i]), &(new_span.glyph_string->glyphs[j+1]), compareGlyphWidth);
+                                }
+
+                                new_span.glyph_string->glyphs[i].attr.is_cluster_start = 1;
+                                std::copy(&new_span.glyph_string->glyphs[      i], &new_span.glyph_string->glyphs[      j+1], infos.end()    - j -1);
+                                std::copy(&new_span.glyph_string->log_clusters[i], &new_span.glyph_string->log_clusters[j+1], clusters.end() - j -1);
+                                i = j;
                             }
-
-                            new_span.glyph_string->glyphs[i].attr.is_cluster_start = 1;
-                            std::copy(&new_span.glyph_string->glyphs[      i], &new_span.glyph_string->glyphs[      j+1], infos.end()    - j -1);
-                            std::copy(&new_span.glyph_string->log_clusters[i], &new_span.glyph_string->log_clusters[j+1], clusters.end() - j -1);
-                            i = j;
+                            std::copy(infos.begin(), infos.end(), new_span.glyph_string->glyphs);
+                            std::copy(clusters.begin(), clusters.end(), new_span.glyph_string->log_clusters);
+                            /* glyphs[].x_offset values are probably out of order within any log_clusters, apparently harmless */
                         }
-                        std::copy(infos.begin(), infos.end(), new_span.glyph_string->glyphs);
-                        std::copy(clusters.begin(), clusters.end(), new_span.glyph_string->log_clusters);
-                        /* glyphs[].x_offset values are probably out of order within any log_clusters, apparently harmless */
-                    }
-                    else {  //  ltr sections are in order but glyphs in a log_cluster following a ligature may not be.  Sort, but no block swapping.
-                        const unsigned nglyphs = new_span.glyph_string->num_glyphs;
-                        unsigned i, j;
-                        for (i = 0 ; i < nglyphs ; i++)new_span.glyph_string->glyphs[i].attr.is_cluster_start = 0;
-                        for (i = 0 ; i < nglyphs ; i++) {
-                            j=i;
-                            while(  (j < nglyphs-1) &&  
-                                    (new_span.glyph_string->log_clusters[j+1] == new_span.glyph_string->log_clusters[i])
-                            )j++;
-                            /* see note in preceding section */
-                            if(j - i){
-                                std::sort(&(new_span.glyph_string->glyphs[i]), &(new_span.glyph_string->glyphs[j+1]), compareGlyphWidth);
+                        else {  //  ltr sections are in order but glyphs in a log_cluster following a ligature may not be.  Sort, but no block swapping.
+                            const unsigned nglyphs = new_span.glyph_string->num_glyphs;
+                            unsigned i, j;
+                            for (i = 0 ; i < nglyphs ; i++)new_span.glyph_string->glyphs[i].attr.is_cluster_start = 0;
+                            for (i = 0 ; i < nglyphs ; i++) {
+                                j=i;
+                                while(  (j < nglyphs-1) &&  
+                                        (new_span.glyph_string->log_clusters[j+1] == new_span.glyph_string->log_clusters[i])
+                                )j++;
+                                /* see note in preceding section */
+                                if(j - i){
+                                    std::sort(&(new_span.glyph_string->glyphs[i]), &(new_span.glyph_string->glyphs[j+1]), compareGlyphWidth);
+                                }
+                                new_span.glyph_string->glyphs[i].attr.is_cluster_start = 1;
+                                i = j;
                             }
-                            new_span.glyph_string->glyphs[i].attr.is_cluster_start = 1;
-                            i = j;
+                            /* glyphs[].x_offset values may be out of order within any log_clusters, apparently harmless */
                         }
-                        /* glyphs[].x_offset values may be out of order within any log_clusters, apparently harmless */
+                        para->shaping->glyph_strings[shaping_key] = pango_glyph_string_copy(new_span.glyph_string);
                     }
                     new_span.pango_item_index = pango_item_index;
                     new_span.line_height_multiplier = _computeFontLineHeight( text_source->style );
@@ -1818,6 +2345,15 @@ bool Layout::Calculator::calculate()
 
     _flow._clearOutputObjects();
 
+    // The paragraphs of the previous layout which are not found again are dropped at the end
+    if (!_flow._shaping_cache)
+        _flow._shaping_cache = std::make_shared<ShapingCache>();
+    _previous_shaping.clear();
+    _previous_shaping.swap(_flow._shaping_cache->paragraphs);
+    _flow._shaping_cache->stats = CalculationStats();
+    _checkpoints.clear();
+    _span_texts.clear();
+
     _pango_context = (font_factory::Default())->fontContext;
 
     _font_factory_size_multiplier = (font_factory::Default())->fontSize;
@@ -1844,14 +2380,21 @@ bool Layout::Calculator::calculate()
     _y_offset = 0.0;
     _createFirstScanlineMaker();
 
+    // Start from the first paragraph which changed since the previous layout
+    std::string setup;
+    bool const resumable = _layoutSetup(&setup);
+    _checkpointing = resumable;
+
     ParagraphInfo para;
     FontMetrics line_box_height; // Current value of line box height for line.
-    for(para.first_input_index = 0 ; para.first_input_index < _flow._input_stream.size() ; ) {
+    para.first_input_index = resumable ? _resumeBreaking(setup, &line_box_height) : 0;
+    while (para.first_input_index < _flow._input_stream.size()) {
         // jump to the next wrap shape if this is a SHAPE_BREAK control code
         if (_flow._input_stream[para.first_input_index]->Type() == CONTROL_CODE) {
             InputStreamControlCode const *control_code = static_cast<InputStreamControlCode const *>(_flow._input_stream[para.first_input_index]);
             if (control_code->code == SHAPE_BREAK) {
                 TRACE(("shape break control code\n"));
+                _checkpointing = false;
                 if (!_goToNextWrapShape()) break;
                 continue;
             }
@@ -1864,6 +2407,7 @@ bool Layout::Calculator::calculate()
 
         // Do shaping (convert characters to glyphs)
         unsigned para_end_input_index = _buildSpansForPara(&para);
+        _flow._shaping_cache->stats.broken_paragraphs++;
 
         if (_flow._input_stream[para.first_input_index]->Type() == TEXT_SOURCE)
             para.alignment = static_cast<InputStreamTextSource*>(_flow._input_stream[para.first_input_index])->styleGetAlignment(para.direction, !_flow._input_wrap_shapes.empty());
@@ -1946,6 +2490,7 @@ bool Layout::Calculator::calculate()
                     if (_flow._chunks[new_span.in_chunk].in_line != _flow._lines.size() - 1)
                         new_span.x_end = 0.0;
                 }
+                _span_texts.push_back(_span_texts.empty() ? ShapingCache::SpanText(-1, 0) : _span_texts.back());
                 new_span.in_chunk = _flow._chunks.size() - 1;
                 if (new_span.font)
                     new_span.font->Ref();
@@ -1979,12 +2524,18 @@ bool Layout::Calculator::calculate()
                 new_character.in_glyph = -1;
                 _flow._characters.push_back(new_character);
             }
+            _addCheckpoint(para, para_end_input_index, line_box_height);
+        } else {
+            _checkpointing = false;
         }
         para.free();
         para.first_input_index = para_end_input_index + 1;
     }
 
     para.free();
+    _saveBreaking(setup);
+    _previous_shaping.clear();
+    _flow._shaping_cache->touch();
     if (_scanline_maker) {
         delete _scanline_maker;
         _flow._input_truncated = false;
@@ -2056,6 +2607,13 @@ void Layout::_calculateCursorShapeForEmpty()
     }
 }
 
+Layout::CalculationStats Layout::lastCalculationStats() const
+{
+    if (!_shaping_cache)
+        return CalculationStats();
+    return _shaping_cache->stats;
+}
+
 bool Layout::calculateFlow()
 {
     TRACE(("begin calculateFlow()\n"));
@@ -19,6 +19,7 @@
 #include <glibmm/ustring.h>
 #include <pango/pango-break.h>
 #include <algorithm>
+#include <memory>
 #include <vector>
 #include <boost/optional.hpp>
 #include <svg/svg-length.h>
@@ -357,6 +358,15 @@ public:
     */
     bool calculateFlow();
 
+    /** How much of the work the last calculateFlow() had to do itself, rather
+    than reuse from the layout before it. See Layout::ShapingCache. */
+    struct CalculationStats {
+        unsigned itemized_paragraphs;   ///< passed to pango_itemize()
+        unsigned shaped_spans;          ///< passed to pango_shape()
+        unsigned broken_paragraphs;     ///< broken into lines
+    };
+    CalculationStats lastCalculationStats() const;
+
     //@}
 
     // ************************** operating on the output glyphs *************************
@@ -799,6 +809,16 @@ private:
     };
     std::vector<InputWrapShape> _input_wrap_shapes;
 
+    // ******************* shaping
+
+    /** The itemization and glyphs of the paragraphs laid out by the last
+    calculateFlow(), and its line breaking up to the end of each paragraph, so
+    that the next one only needs to shape the paragraphs which were edited and
+    to break the lines from the first of them. Only the layouts calculated most
+    recently keep them. Unlike everything else, this survives clear(). */
+    struct ShapingCache;
+    std::shared_ptr<ShapingCache> _shaping_cache;
+
     // ******************* output
 
     /** as passed to fitToPathAlign() */
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * On-disk catalog of the fonts on the system.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+
+#include <glib/gstdio.h>
+#include <glibmm/stringutils.h>
+
+#include <fontconfig/fontconfig.h>
+#include <pango/pangofc-fontmap.h>
+
+#include "io/resource.h"
+#include "libnrtype/FontFactory.h"
+#include "libnrtype/font-catalog.h"
+
+namespace {
+
+/// First line of the catalog file; change the version when the format changes.
+char const CATALOG_HEADER[] = "# Inkscape font catalog 1";
+
+bool face_less(Inkscape::FontCatalog::Face const &a, Inkscape::FontCatalog::Face const &b)
+{
+    return std::tie(a.file, a.family, a.style, a.display_style) <
+           std::tie(b.file, b.family, b.style, b.display_style);
+}
+
+}
+
+namespace Inkscape {
+
+bool FontCatalog::Face::operator==(Face const &other) const
+{
+    return family == other.family && style == other.style && display_style == other.display_style &&
+           file == other.file && mtime == other.mtime;
+}
+
+FontCatalog FontCatalog::scan()
+{
+    FontCatalog catalog;
+
+    FcPattern *pattern = FcPatternCreate();
+    FcObjectSet *objects = FcObjectSetBuild(FC_FAMILY, FC_STYLE, FC_FILE, FC_SLANT, FC_WEIGHT, FC_WIDTH,
+#ifdef FC_FONT_VARIATIONS
+                                            FC_FONT_VARIATIONS,
+#endif
+                                            nullptr);
+    FcFontSet *fonts = FcFontList(nullptr, pattern, objects);
+    FcObjectSetDestroy(objects);
+    FcPatternDestroy(pattern);
+    if (!fonts) {
+        return catalog;
+    }
+
+    catalog.faces.reserve(fonts->nfont);
+    for (int i = 0; i < fonts->nfont; ++i) {
+        FcPattern *font = fonts->fonts[i];
+        FcChar8 *family = nullptr;
+        FcChar8 *style = nullptr;
+        FcChar8 *file = nullptr;
+        if (FcPatternGetString(font, FC_FAMILY, 0, &family) != FcResultMatch ||
+            FcPatternGetString(font, FC_FILE, 0, &file) != FcResultMatch ||
+            !g_utf8_validate(reinterpret_cast<char const *>(family), -1, nullptr)) {
+            continue;
+        }
+
+        // Describe the face the way Pango does when listing the faces of a family
+        PangoFontDescription *descr = pango_fc_font_description_from_pattern(font, FALSE);
+        Face face;
+        face.family = reinterpret_cast<char const *>(family);
+        face.style = font_factory::GetUIStyleString(descr);
+        pango_font_description_free(descr);
+        if (FcPatternGetString(font, FC_STYLE, 0, &style) == FcResultMatch &&
+            g_utf8_validate(reinterpret_cast<char const *>(style), -1, nullptr)) {
+            face.display_style = reinterpret_cast<char const *>(style);
+        } else {
+            face.display_style = face.style;
+        }
+        face.file = reinterpret_cast<char const *>(file);
+        GStatBuf info;
+        face.mtime = g_stat(face.file.c_str(), &info) == 0 ? info.st_mtime : 0;
+        catalog.faces.push_back(face);
+    }
+    FcFontSetDestroy(fonts);
+
+    std::sort(catalog.faces.begin(), catalog.faces.end(), face_less);
+    return catalog;
+}
+
+std::string FontCatalog::default_filename()
+{
+    return IO::Resource::get_path_ustring(IO::Resource::CACHE, IO::Resource::NONE, "font-catalog");
+}
+
+bool FontCatalog::load(std::string const &filename)
+{
+    faces.clear();
+
+    gchar *contents = nullptr;
+    if (!g_file_get_contents(filename.c_str(), &contents, nullptr, nullptr)) {
+        return false;
+    }
+    gchar **lines = g_strsplit(contents, "\n", -1);
+    g_free(contents);
+
+    bool valid = lines[0] && strcmp(lines[0], CATALOG_HEADER) == 0;
+    for (gchar **line = lines + 1; valid && *line; ++line) {
+        if (!**line) {
+            continue;
+        }
+        gchar **fields = g_strsplit(*line, "\t", -1);
+        if (g_strv_length(fields) == 5) {
+            Face face;
+            face.file = Glib::strcompress(fields[0]);
+            face.mtime = g_ascii_strtoll(fields[1], nullptr, 10);
+            face.family = Glib::strcompress(fields[2]);
+            face.style = Glib::strcompress(fields[3]);
+            face.display_style = Glib::strcompress(fields[4]);
+            faces.push_back(face);
+        } else {
+            valid = false;
+        }
+        g_strfreev(fields);
+    }
+    g_strfreev(lines);
+
+    if (!valid) {
+        faces.clear();
+        return false;
+    }
+    std::sort(faces.begin(), faces.end(), face_less);
+    return true;
+}
+
+bool FontCatalog::save(std::string const &filename) const
+{
+    // strescape() leaves no tabs or line breaks in the fields
+    std::string contents = CATALOG_HEADER;
+    contents += '\n';
+    for (auto const &face : faces) {
+        contents += Glib::strescape(face.file);
+        contents += '\t';
+        contents += std::to_string(face.mtime);
+        contents += '\t';
+        contents += Glib::strescape(face.family);
+        contents += '\t';
+        contents += Glib::strescape(face.style);
+        contents += '\t';
+        contents += Glib::strescape(face.display_style);
+        contents += '\n';
+    }
+
+    gchar *dir = g_path_get_dirname(filename.c_str());
+    g_mkdir_with_parents(dir, 0700);
+    g_free(dir);
+    // written to a temporary file first, so that another instance never reads half a catalog
+    return g_file_set_contents(filename.c_str(), contents.data(), contents.size(), nullptr);
+}
+
+} // namespace Inkscape
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
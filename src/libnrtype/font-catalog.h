@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * On-disk catalog of the fonts on the system.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_LIBNRTYPE_FONT_CATALOG_H
+#define SEEN_LIBNRTYPE_FONT_CATALOG_H
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <glibmm/ustring.h>
+
+namespace Inkscape {
+
+/**
+ * The font faces installed on the system, as found by fontconfig, which can be saved and loaded
+ * again much faster than Pango enumerates them.
+ *
+ * The FontLister fills its font list from the catalog saved by the last session, and scans the
+ * system again in the background: the list is only built from Pango if something changed.
+ * scan() does not use Pango font maps or anything else tied to the main thread.
+ */
+class FontCatalog {
+public:
+    struct Face {
+        Glib::ustring family;         ///< Family name, as given by Pango (not mapped to CSS generic names).
+        Glib::ustring style;          ///< As given by font_factory::GetUIStyleString().
+        Glib::ustring display_style;  ///< Style name given by the designer.
+        std::string file;
+        gint64 mtime;                 ///< Modification time of the file, in seconds.
+
+        bool operator==(Face const &other) const;
+        bool operator!=(Face const &other) const { return !(*this == other); }
+    };
+
+    /// Sorted by file, family and style.
+    std::vector<Face> faces;
+
+    /// The fonts currently on the system.
+    static FontCatalog scan();
+
+    /// Where the catalog is kept between sessions.
+    static std::string default_filename();
+
+    /**
+     * Read a catalog saved by save().
+     * @return false if there is no catalog, or it was saved by another version.
+     */
+    bool load(std::string const &filename);
+    bool save(std::string const &filename) const;
+
+    bool operator==(FontCatalog const &other) const { return faces == other.faces; }
+    bool operator!=(FontCatalog const &other) const { return faces != other.faces; }
+};
+
+} // namespace Inkscape
+
+#endif /* !SEEN_LIBNRTYPE_FONT_CATALOG_H */
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -11,6 +11,10 @@
 #define SEEN_LIBNRTYPE_FONT_INSTANCE_H
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <pango/pango-types.h>
 #include <pango/pango-font.h>
@@ -25,6 +29,7 @@ namespace Inkscape { class Pixbuf; }
 
 class font_factory;
 struct font_glyph;
+struct CachedGlyph;
 
 // the font_instance are the template of several raster_font; they provide metrics and outlines
 // that are drawn by the raster_font, so the raster_font needs info relative to the way the
@@ -84,7 +89,8 @@ public:
     // nota: all coordinates returned by these functions are on a [0..1] scale; you need to multiply
     // by the fontsize to get the real sizes
 
-    // Return 2geom pathvector for glyph. Deallocated when font instance dies.
+    // Return 2geom pathvector for glyph. Valid as long as the font instance lives; it may be
+    // shared with other font instances, so it must not be modified.
     Geom::PathVector*    PathVector(int glyph_id);
 
     // Return font has SVG OpenType enties.
@@ -114,6 +120,9 @@ public:
 
 private:
     void                 FreeTheFace();
+    void                 _loadGlyph(int glyph_id);
+    // Index of the glyph in glyphs[], loading it if needed; -1 if it cannot be loaded.
+    int                  _glyphIndex(int glyph_id);
     // Find ascent, descent, x-height, and baselines.
     void                 FindFontMetrics();
 
@@ -138,6 +147,14 @@ private:
 
     // Baselines
     double _baselines[SP_CSS_BASELINE_SIZE];
+
+    // Key of the face in the GlyphCache, empty if its glyphs are not shared.
+    std::string _glyphFace;
+    // The glyphs loaded, which may be shared with other instances; glyphs[] points to their outlines.
+    std::vector<std::shared_ptr<CachedGlyph const>> _glyphRefs;
+    // Guards the glyph tables and the SVG glyph pixbufs, which are filled lazily while the
+    // text is drawn, possibly from several rendering threads at once.
+    std::mutex _glyphMutex;
 };
 
 
@@ -49,9 +49,8 @@ bool familyNamesAreEqual(const Glib::ustring &a, const Glib::ustring &b)
     return (a.casefold().compare(b.casefold()) == 0);
 }
 
-static const char* sp_font_family_get_name(PangoFontFamily* family)
+static const char* sp_font_family_ui_name(const char* name)
 {
-    const char* name = pango_font_family_get_name(family);
     if (strncmp(name, "Sans", 4) == 0 && strlen(name) == 4)
         return "sans-serif";
     if (strncmp(name, "Serif", 5) == 0 && strlen(name) == 5)
@@ -61,6 +60,11 @@ static const char* sp_font_family_get_name(PangoFontFamily* family)
     return name;
 }
 
+static const char* sp_font_family_get_name(PangoFontFamily* family)
+{
+    return sp_font_family_ui_name(pango_font_family_get_name(family));
+}
+
 namespace Inkscape {
 
 FontLister::FontLister()
@@ -68,6 +72,7 @@ FontLister::FontLister()
     , current_family ("sans-serif")
     , current_style ("Normal")
     , block (false)
+    , from_catalog (false)
 {
     font_list_store = Gtk::ListStore::create(FontList);
     font_list_store->freeze_notify();
@@ -78,30 +83,15 @@ FontLister::FontLister()
     default_styles = g_list_append(default_styles, new StyleNames("Bold"));
     default_styles = g_list_append(default_styles, new StyleNames("Bold Italic"));
 
-    // Get sorted font families from Pango
-    std::vector<PangoFontFamily *> familyVector;
-    font_factory::Default()->GetUIFamilies(familyVector);
-
-    // Traverse through the family names and set up the list store
-    for (auto & i : familyVector) {
-        const char* displayName = sp_font_family_get_name(i);
-        
-        if (displayName == nullptr || *displayName == '\0') {
-            continue;
-        }
-        
-        Glib::ustring familyName = displayName;
-        if (!familyName.empty()) {
-            Gtk::TreeModel::iterator treeModelIter = font_list_store->append();
-            (*treeModelIter)[FontList.family] = familyName;
-
-            // we don't set this now (too slow) but the style will be cached if the user 
-            // ever decides to use this font
-            (*treeModelIter)[FontList.styles] = NULL;
-            // store the pango representation for generating the style
-            (*treeModelIter)[FontList.pango_family] = i;
-            (*treeModelIter)[FontList.onSystem] = true;
-        }
+    // Pango takes seconds to list thousands of fonts, so start with the fonts of the last
+    // session if they were saved; they are checked against the system in the background.
+    // The font factory adds the fonts of the user to fontconfig, which must happen first.
+    font_factory::Default();
+    from_catalog = catalog.load(FontCatalog::default_filename()) && !catalog.faces.empty();
+    if (from_catalog) {
+        add_catalog_families();
+    } else {
+        add_system_families();
     }
 
     font_list_store->thaw_notify();
@@ -117,10 +107,27 @@ FontLister::FontLister()
         (*treeModelIter)[FontStyleList.displayStyle] = ((StyleNames *)l->data)->DisplayName;
     }
     style_list_store->thaw_notify();
+
+    catalog_scanned.connect(sigc::mem_fun(*this, &FontLister::on_catalog_scanned));
+    catalog_thread = std::thread([this]() {
+        scanned_catalog = FontCatalog::scan();
+        catalog_scanned.emit();
+    });
 }
 
 FontLister::~FontLister()
 {
+    if (catalog_thread.joinable()) {
+        catalog_thread.join();
+    }
+
+    for (auto styles : stale_styles) {
+        for (GList *l = styles; l; l = l->next) {
+            delete ((StyleNames *)l->data);
+        }
+        g_list_free(styles);
+    }
+
     // Delete default_styles
     for (GList *l = default_styles; l; l = l->next) {
         delete ((StyleNames *)l->data);
@@ -144,6 +151,117 @@ FontLister *FontLister::get_instance()
     return instance;
 }
 
+void FontLister::add_system_families()
+{
+    // Get sorted font families from Pango
+    std::vector<PangoFontFamily *> familyVector;
+    font_factory::Default()->GetUIFamilies(familyVector);
+
+    // Traverse through the family names and set up the list store
+    for (auto & i : familyVector) {
+        const char* displayName = sp_font_family_get_name(i);
+        
+        if (displayName == nullptr || *displayName == '\0') {
+            continue;
+        }
+        
+        Glib::ustring familyName = displayName;
+        if (!familyName.empty()) {
+            Gtk::TreeModel::iterator treeModelIter = font_list_store->append();
+            (*treeModelIter)[FontList.family] = familyName;
+
+            // we don't set this now (too slow) but the style will be cached if the user 
+            // ever decides to use this font
+            (*treeModelIter)[FontList.styles] = NULL;
+            // store the pango representation for generating the style
+            (*treeModelIter)[FontList.pango_family] = i;
+            (*treeModelIter)[FontList.onSystem] = true;
+        }
+    }
+}
+
+void FontLister::add_catalog_families()
+{
+    // Sorted by their Pango names, like font_factory::GetUIFamilies()
+    std::map<Glib::ustring, std::vector<std::pair<Glib::ustring, Glib::ustring>>> families;
+    for (auto const &face : catalog.faces) {
+        families[face.family].emplace_back(face.style, face.display_style);
+    }
+
+    // Pango adds the generic families, with synthesized faces
+    for (auto generic : {"Sans", "Serif", "Monospace"}) {
+        if (families.find(generic) == families.end()) {
+            families[generic] = { {"Normal", "Regular"}, {"Bold", "Bold"},
+                                  {"Italic", "Italic"}, {"Bold Italic", "Bold Italic"} };
+        }
+    }
+
+    for (auto const &family : families) {
+        Glib::ustring familyName = sp_font_family_ui_name(family.first.c_str());
+        if (familyName.empty()) {
+            continue;
+        }
+        // Without a Pango family, the styles of the row cannot be loaded later on
+        GList *styles = font_factory::Default()->GetUIStyles(familyName, family.second);
+        if (!styles) {
+            continue;
+        }
+        Gtk::TreeModel::iterator treeModelIter = font_list_store->append();
+        (*treeModelIter)[FontList.family] = familyName;
+        (*treeModelIter)[FontList.styles] = styles;
+        (*treeModelIter)[FontList.pango_family] = NULL;
+        (*treeModelIter)[FontList.onSystem] = true;
+    }
+}
+
+void FontLister::on_catalog_scanned()
+{
+    catalog_thread.join();
+
+    bool changed = scanned_catalog != catalog;
+    if (changed) {
+        scanned_catalog.save(FontCatalog::default_filename());
+    }
+    catalog = std::move(scanned_catalog);
+    scanned_catalog = FontCatalog();
+    if (!changed || !from_catalog) {
+        catalog = FontCatalog();
+        return;
+    }
+
+    // Fonts were installed or removed since the last session. They are listed from the
+    // scanned catalog, as Pango would take seconds to list them on the main thread.
+    font_list_store->freeze_notify();
+
+    int first_system_row = 0;
+    Gtk::TreeModel::iterator iter = font_list_store->get_iter("0");
+    while (iter != font_list_store->children().end()) {
+        Gtk::TreeModel::Row row = *iter;
+        if (row[FontList.onSystem]) {
+            stale_styles.push_back(row[FontList.styles]);
+            iter = font_list_store->erase(iter);
+        } else {
+            ++first_system_row;
+            ++iter;
+        }
+    }
+    add_catalog_families();
+    catalog = FontCatalog();
+
+    if (current_family_row >= first_system_row) {
+        int row = 0;
+        for (iter = font_list_store->children().begin(); iter != font_list_store->children().end(); ++iter, ++row) {
+            if (row >= first_system_row && familyNamesAreEqual(current_family, (*iter)[FontList.family])) {
+                current_family_row = row;
+                break;
+            }
+        }
+    }
+
+    font_list_store->thaw_notify();
+    emit_update();
+}
+
 // To do: remove model (not needed for C++ version).
 // Ensures the style list for a particular family has been created.
 void FontLister::ensureRowStyles(Glib::RefPtr<Gtk::TreeModel> model, Gtk::TreeModel::iterator const iter)
@@ -19,7 +19,9 @@
 
 #include <map>
 #include <set>
+#include <thread>
 
+#include <glibmm/dispatcher.h>
 #include <glibmm/ustring.h>
 #include <glibmm/stringutils.h> // For strescape()
 
@@ -27,6 +29,8 @@
 #include <gtkmm/treemodelcolumn.h>
 #include <gtkmm/treepath.h>
 
+#include "font-catalog.h"
+
 class SPObject;
 class SPDocument;
 class SPCSSAttr;
@@ -305,6 +309,22 @@ private:
 
     void update_font_data_recursive(SPObject& r, std::map<Glib::ustring, std::set<Glib::ustring>> &font_data);
 
+    /**
+     * Appends the system font families to the font list, as listed by Pango.
+     */
+    void add_system_families();
+
+    /**
+     * Appends the system font families to the font list, as listed by the catalog.
+     */
+    void add_catalog_families();
+
+    /**
+     * Compares the catalog with the fonts found on the system in the background, and
+     * rebuilds the system part of the font list from the latter if they differ.
+     */
+    void on_catalog_scanned();
+
     Glib::RefPtr<Gtk::ListStore> font_list_store;
     Glib::RefPtr<Gtk::ListStore> style_list_store;
 
@@ -324,6 +344,22 @@ private:
     bool block;
     void emit_update();
     sigc::signal<void> update_signal;
+
+    /**
+     * The system fonts as saved by the last session, and as found by scanning the system
+     * in the background. Both are emptied once compared.
+     */
+    FontCatalog catalog;
+    FontCatalog scanned_catalog;
+    bool from_catalog;                 ///< The system part of the font list comes from the catalog.
+    std::thread catalog_thread;
+    Glib::Dispatcher catalog_scanned;
+
+    /**
+     * Style lists of system font families which are no longer in the font list. Document
+     * font families may still use them.
+     */
+    std::vector<GList *> stale_styles;
 };
 
 } // namespace Inkscape
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Cache of glyph outlines shared by all font instances.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include <2geom/bezier-curve.h>
+#include <2geom/pathvector.h>
+
+#include "libnrtype/glyph-cache.h"
+
+namespace {
+
+/// Total size of the glyphs kept.
+std::size_t const MAX_CACHED_BYTES = 32 << 20;
+
+struct Entry {
+    std::string key;
+    GlyphCache::Glyph glyph;
+    std::size_t bytes;
+};
+
+struct Cache {
+    std::mutex mutex;
+    std::list<Entry> entries; ///< most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::size_t bytes = 0;
+
+    void erase(std::list<Entry>::iterator e)
+    {
+        index.erase(e->key);
+        bytes -= e->bytes;
+        entries.erase(e);
+    }
+};
+
+Cache &cache()
+{
+    static Cache c;
+    return c;
+}
+
+std::string glyph_key(std::string const &face, int glyph_id)
+{
+    std::string key = face;
+    key += '\n';
+    key += std::to_string(glyph_id);
+    return key;
+}
+
+/// Approximate memory used by a glyph.
+std::size_t glyph_bytes(CachedGlyph const &glyph)
+{
+    std::size_t bytes = sizeof(Entry) + sizeof(CachedGlyph);
+    if (glyph.outline) {
+        // most glyph curves are quadratic; this counts them all as cubic
+        bytes += sizeof(Geom::PathVector) + glyph.outline->size() * sizeof(Geom::Path) +
+                 glyph.outline->curveCount() * sizeof(Geom::CubicBezier);
+    }
+    return bytes;
+}
+
+}
+
+std::string GlyphCache::faceKey(char const *file, int index, char const *variations)
+{
+    if (!file || !*file) {
+        return std::string();
+    }
+    std::string key = file;
+    key += '\n';
+    key += std::to_string(index);
+    key += '\n';
+    if (variations) {
+        key += variations;
+    }
+    return key;
+}
+
+GlyphCache::Glyph GlyphCache::lookup(std::string const &face, int glyph_id)
+{
+    if (face.empty()) {
+        return nullptr;
+    }
+
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    auto i = c.index.find(glyph_key(face, glyph_id));
+    if (i == c.index.end()) {
+        return nullptr;
+    }
+    c.entries.splice(c.entries.begin(), c.entries, i->second);
+    return i->second->glyph;
+}
+
+GlyphCache::Glyph GlyphCache::store(std::string const &face, int glyph_id, font_glyph const &metrics,
+                                    Geom::PathVector *outline)
+{
+    auto glyph = std::make_shared<CachedGlyph>();
+    glyph->glyph = metrics;
+    glyph->outline.reset(outline);
+    glyph->glyph.pathvector = outline;
+    if (face.empty()) {
+        return glyph;
+    }
+
+    Entry entry;
+    entry.key = glyph_key(face, glyph_id);
+    entry.glyph = glyph;
+    entry.bytes = glyph_bytes(*glyph);
+
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    // another font instance of the same face may have loaded the glyph meanwhile
+    auto existing = c.index.find(entry.key);
+    if (existing != c.index.end()) {
+        c.erase(existing->second);
+    }
+    while (!c.entries.empty() && c.bytes + entry.bytes > MAX_CACHED_BYTES) {
+        c.erase(std::prev(c.entries.end()));
+    }
+    c.bytes += entry.bytes;
+    c.entries.push_front(std::move(entry));
+    c.index.emplace(c.entries.front().key, c.entries.begin());
+    return glyph;
+}
+
+void GlyphCache::clear()
+{
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.index.clear();
+    c.entries.clear();
+    c.bytes = 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
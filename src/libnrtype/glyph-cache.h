@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Cache of glyph outlines shared by all font instances.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_LIBNRTYPE_GLYPH_CACHE_H
+#define SEEN_LIBNRTYPE_GLYPH_CACHE_H
+
+#include <memory>
+#include <string>
+
+#include "libnrtype/font-glyph.h"
+
+/// A glyph loaded from a font file, as kept by the GlyphCache.
+struct CachedGlyph {
+    /// Metrics of the glyph; its pathvector points to the outline.
+    font_glyph glyph;
+    std::shared_ptr<Geom::PathVector const> outline;
+};
+
+/**
+ * Remembers the glyphs recently loaded by font_instance::LoadGlyph(), so that the other
+ * font_instances of the same face do not load and convert them again.
+ *
+ * A font_instance is made for each font description, i.e. for every family, style and size
+ * used by any open document, and used to load its own copy of every glyph from FreeType. The
+ * glyphs only depend on the face though: they are scaled to the em box. The cache is shared by
+ * all documents and threads, keyed by the font file, the index of the face in the file, the
+ * variation coordinates and the glyph id. It keeps a limited amount of outlines, dropping the
+ * least recently used ones; the font_instances hold references to the glyphs they use, so
+ * dropping a glyph from the cache never frees it under them.
+ */
+class GlyphCache {
+public:
+    typedef std::shared_ptr<CachedGlyph const> Glyph;
+
+    /**
+     * The key of a face in the cache.
+     * @param file File the face is loaded from.
+     * @param index Index of the face in the file, including the named instance.
+     * @param variations Variation settings applied to the face, or nullptr.
+     * @return An empty string if the face cannot be identified: its glyphs are not cached.
+     */
+    static std::string faceKey(char const *file, int index, char const *variations);
+
+    /// The glyph @a glyph_id of @a face, or nullptr if it is not in the cache.
+    static Glyph lookup(std::string const &face, int glyph_id);
+    /**
+     * Remember the glyph @a glyph_id of @a face.
+     * @param metrics Metrics of the glyph; its pathvector is ignored.
+     * @param outline Outline of the glyph, which is taken over, or nullptr.
+     * @return The glyph, also when it is not kept because the face is unknown.
+     */
+    static Glyph store(std::string const &face, int glyph_id, font_glyph const &metrics,
+                       Geom::PathVector *outline);
+
+    /// Forget all glyphs.
+    static void clear();
+};
+
+#endif /* !SEEN_LIBNRTYPE_GLYPH_CACHE_H */
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -491,7 +491,7 @@ void Path::PolylineBoundingBox(double &l, double &t, double &r, double &b)
       return;
   }
 
-  std::vector<path_lineto>::const_iterator i = pts.begin();
+  ShapeArena::Vector<path_lineto>::const_iterator i = pts.begin();
   l = r = i->p[Geom::X];
   t = b = i->p[Geom::Y];
   ++i;
@@ -20,6 +20,7 @@
 
 #include <vector>
 #include "LivarotDefs.h"
+#include "livarot/shape-arena.h"
 #include <2geom/point.h>
 
 struct PathDescr;
@@ -99,7 +100,7 @@ public:
     bool closed; // true if subpath is closed (this point is the last point of a closed subpath)
   };
   
-  std::vector<path_lineto> pts;
+  ShapeArena::Vector<path_lineto> pts;
 
   bool back;
 
@@ -246,7 +247,7 @@ public:
   
   // creation of dashes: take the polyline given by spP (length spL) and dash it according to head, body, etc. put the result in
   // the polyline of this instance
-  void DashSubPath(int spL, int spP, std::vector<path_lineto> const &orig_pts, float head,float tail,float body,int nbD,float *dashs,bool stPlain,float stOffset);
+  void DashSubPath(int spL, int spP, ShapeArena::Vector<path_lineto> const &orig_pts, float head,float tail,float body,int nbD,float *dashs,bool stPlain,float stOffset);
 
   // Functions used by the conversion.
   // they append points to the polyline
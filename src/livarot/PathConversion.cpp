@@ -15,6 +15,7 @@
 #include "Path.h"
 #include "Shape.h"
 #include "livarot/path-description.h"
+#include "livarot/polyline-cache.h"
 
 /*
  * path description -> polyline
@@ -38,6 +39,11 @@ void Path::ConvertWithBackData(double treshhold)
         return;
     }
 
+    PolylineCache cache(*this, PolylineCache::CONVERT_WITH_BACK_DATA, treshhold);
+    if (cache.fetch(*this)) {
+        return;
+    }
+
     Geom::Point curX;
     int curP = 1;
     int lastMoveTo = -1;
@@ -182,6 +188,8 @@ void Path::ConvertWithBackData(double treshhold)
         }
         curX = nextX;
     }
+
+    cache.store(*this);
 }
 
 
@@ -201,6 +209,11 @@ void Path::Convert(double treshhold)
         return;
     }
 
+    PolylineCache cache(*this, PolylineCache::CONVERT, treshhold);
+    if (cache.fetch(*this)) {
+        return;
+    }
+
     Geom::Point curX;
     int curP = 1;
     int lastMoveTo = 0;
@@ -398,6 +411,8 @@ void Path::Convert(double treshhold)
 
         curX = nextX;
     }
+
+    cache.store(*this);
 }
 
 void Path::ConvertEvenLines(double treshhold)
@@ -416,6 +431,11 @@ void Path::ConvertEvenLines(double treshhold)
         return;
     }
 
+    PolylineCache cache(*this, PolylineCache::CONVERT_EVEN_LINES, treshhold);
+    if (cache.fetch(*this)) {
+        return;
+    }
+
     Geom::Point curX;
     int curP = 1;
     int lastMoveTo = 0;
@@ -638,6 +658,8 @@ void Path::ConvertEvenLines(double treshhold)
             curX = nextX;
         }
     }
+
+    cache.store(*this);
 }
 
 const Geom::Point Path::PrevPoint(int i) const
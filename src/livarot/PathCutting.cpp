@@ -35,7 +35,7 @@ void  Path::DashPolyline(float head,float tail,float body,int nbD,float *dashs,b
 {
   if ( nbD <= 0 || body <= 0.0001 ) return; // pas de tirets, en fait
 
-  std::vector<path_lineto> orig_pts = pts;
+  ShapeArena::Vector<path_lineto> orig_pts = pts;
   pts.clear();
 
   int       lastMI=-1;
@@ -94,7 +94,7 @@ void  Path::DashPolylineFromStyle(SPStyle *style, float scale, float min_len)
 }
 
 
-void Path::DashSubPath(int spL, int spP, std::vector<path_lineto> const &orig_pts, float head,float tail,float body,int nbD,float *dashs,bool stPlain,float stOffset)
+void Path::DashSubPath(int spL, int spP, ShapeArena::Vector<path_lineto> const &orig_pts, float head,float tail,float body,int nbD,float *dashs,bool stPlain,float stOffset)
 {
   if ( spL <= 0 || spP == -1 ) return;
   
@@ -482,7 +482,7 @@ double Path::Length()
     Geom::Point lastP = pts[0].p;
 
     double len = 0;
-    for (std::vector<path_lineto>::const_iterator i = pts.begin(); i != pts.end(); ++i) {
+    for (ShapeArena::Vector<path_lineto>::const_iterator i = pts.begin(); i != pts.end(); ++i) {
 
         if ( i->isMoveTo != polyline_moveto ) {
             len += Geom::L2(i->p - lastP);
@@ -505,7 +505,7 @@ double Path::Surface()
     Geom::Point lastP = lastM;
 
     double surf = 0;
-    for (std::vector<path_lineto>::const_iterator i = pts.begin(); i != pts.end(); ++i) {
+    for (ShapeArena::Vector<path_lineto>::const_iterator i = pts.begin(); i != pts.end(); ++i) {
 
         if ( i->isMoveTo == polyline_moveto ) {
             surf += Geom::cross(lastM, lastM - lastP);
@@ -900,7 +900,7 @@ Path::cut_position* Path::CurvilignToPosition(int nbCv, double *cvAbs, int &nbCu
     Geom::Point lastM = pts[0].p;
     Geom::Point lastP = lastM;
 
-    for (std::vector<path_lineto>::const_iterator i = pts.begin(); i != pts.end(); ++i) {
+    for (ShapeArena::Vector<path_lineto>::const_iterator i = pts.begin(); i != pts.end(); ++i) {
 
         if ( i->isMoveTo == polyline_moveto ) {
 
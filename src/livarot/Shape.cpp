@@ -283,6 +283,35 @@ Shape::Copy (Shape * who)
   _aretes = who->_aretes;
 }
 
+/**
+ *  Add the points and edges of `a' to this shape. The edges of both shapes must not
+ *  cross, e.g. because their bounding boxes are disjoint; the result is then a polygon if
+ *  both shapes are. Back data is kept if both shapes have it.
+ */
+void
+Shape::Concat (Shape * a)
+{
+  if (a == nullptr || a == this || a->numberOfEdges() == 0)
+    return;
+
+  bool const empty = (numberOfEdges() == 0);
+  bool const polygon = (empty || type == shape_polygon) && a->type == shape_polygon;
+  MakeBackData (a->_has_back_data && (empty || _has_back_data));
+
+  int const ptOffset = numberOfPoints();
+  for (int i = 0; i < a->numberOfPoints(); i++)
+    AddPoint (a->getPoint(i).x);
+  for (int i = 0; i < a->numberOfEdges(); i++)
+    {
+      int const n = AddEdge (a->getEdge(i).st + ptOffset, a->getEdge(i).en + ptOffset);
+      if (n >= 0 && _has_back_data)
+        ebData[n] = a->ebData[i];
+    }
+
+  type = polygon ? shape_polygon : shape_graph;
+  _bbox_up_to_date = false;
+}
+
 /**
  *  Clear points and edges and prepare internal data using new size.
  */
@@ -1490,7 +1519,8 @@ Shape::SortEdges ()
   }
   _need_edges_sorting = false;
 
-  edge_list *list = (edge_list *) g_malloc(numberOfEdges() * sizeof (edge_list));
+  int const nbList = numberOfEdges();
+  edge_list *list = (edge_list *) ShapeArena::allocate(nbList * sizeof (edge_list));
   for (int p = 0; p < numberOfPoints(); p++)
     {
       int const d = getPoint(p).totalDegree();
@@ -1561,7 +1591,7 @@ Shape::SortEdges ()
             }
         }
     }
-  g_free(list);
+  ShapeArena::deallocate(list, nbList * sizeof (edge_list));
 }
 
 int
@@ -2169,7 +2199,7 @@ void Shape::initialiseEdgeData()
 
 void Shape::clearIncidenceData()
 {
-    g_free(iData);
+    ShapeArena::deallocate(iData, maxInc * sizeof (incidenceData));
     iData = nullptr;
     nbInc = maxInc = 0;
 }
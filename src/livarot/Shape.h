@@ -19,6 +19,7 @@
 #include <2geom/point.h>
 
 #include "livarot/LivarotDefs.h"
+#include "livarot/shape-arena.h"
 #include "object/object-set.h"
 
 class Path;
@@ -126,6 +127,8 @@ public:
 
     // insertion/deletion/movement of elements in the graph
     void Copy(Shape *a);
+    // add the points and edges of a, which must not cross any edge of this shape, keeping their back data
+    void Concat(Shape *a);
     // -reset the graph, and ensure there's room for n points and m edges
     void Reset(int n = 0, int m = 0);
     //  -points:
@@ -322,16 +325,16 @@ public:
     void Transform(Geom::Affine const &tr)
         {for(auto & _pt : _pts) _pt.x*=tr;}
 
-    std::vector<back_data> ebData;
-    std::vector<voronoi_point> vorpData;
-    std::vector<voronoi_edge> voreData;
+    ShapeArena::Vector<back_data> ebData;
+    ShapeArena::Vector<voronoi_point> vorpData;
+    ShapeArena::Vector<voronoi_edge> voreData;
 
     int nbQRas;
     int firstQRas;
     int lastQRas;
     quick_raster_data *qrsData;
 
-    std::vector<sTreeChange> chgts;
+    ShapeArena::Vector<sTreeChange> chgts;
     int nbInc;
     int maxInc;
 
@@ -547,16 +550,16 @@ private:
     bool _has_voronoi_data;
     bool _bbox_up_to_date;      ///< the leftX/rightX/topY/bottomY are up to date
 
-    std::vector<dg_point> _pts;
-    std::vector<dg_arete> _aretes;
+    ShapeArena::Vector<dg_point> _pts;
+    ShapeArena::Vector<dg_arete> _aretes;
   
     // the arrays of temporary data
     // these ones are dynamically kept at a length of maxPt or maxAr
-    std::vector<edge_data> eData;
-    std::vector<sweep_src_data> swsData;
-    std::vector<sweep_dest_data> swdData;
-    std::vector<raster_data> swrData;
-    std::vector<point_data> pData;
+    ShapeArena::Vector<edge_data> eData;
+    ShapeArena::Vector<sweep_src_data> swsData;
+    ShapeArena::Vector<sweep_dest_data> swdData;
+    ShapeArena::Vector<raster_data> swrData;
+    ShapeArena::Vector<point_data> pData;
     
     static int CmpQRs(const quick_raster_data &p1, const quick_raster_data &p2) {
         if ( fabs(p1.x - p2.x) < 0.00001 ) {
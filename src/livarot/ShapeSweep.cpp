@@ -1987,9 +1987,10 @@ Shape::PushIncidence (Shape * a, int cb, int pt, double theta)
 
   if (nbInc >= maxInc)
     {
+      int oldMax = maxInc;
       maxInc = 2 * nbInc + 1;
       iData =
-	(incidenceData *) g_realloc(iData, maxInc * sizeof (incidenceData));
+	(incidenceData *) ShapeArena::reallocate(iData, oldMax * sizeof (incidenceData), maxInc * sizeof (incidenceData));
     }
   int n = nbInc++;
   iData[n].nextInc = a->swsData[cb].firstLinkedPoint;
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Cache of the polylines made from livarot paths.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+#include "livarot/Path.h"
+#include "livarot/path-description.h"
+#include "livarot/polyline-cache.h"
+
+namespace {
+
+/// Total size of the polylines kept.
+std::size_t const MAX_CACHED_BYTES = 16 << 20;
+/// Larger polylines are not kept, so that they do not push out everything else.
+std::size_t const MAX_ENTRY_BYTES = MAX_CACHED_BYTES / 8;
+
+struct Entry {
+    std::vector<double> key;
+    std::size_t hash;
+    std::vector<Path::path_lineto> pts;
+    std::vector<int> associated;
+
+    std::size_t bytes() const
+    {
+        return key.size() * sizeof(double) + pts.size() * sizeof(Path::path_lineto) +
+               associated.size() * sizeof(int);
+    }
+};
+
+struct Cache {
+    std::mutex mutex;
+    std::list<Entry> entries; ///< most recently used first
+    std::unordered_multimap<std::size_t, std::list<Entry>::iterator> index;
+    std::size_t bytes = 0;
+
+    std::list<Entry>::iterator find(std::vector<double> const &key, std::size_t hash)
+    {
+        auto range = index.equal_range(hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (i->second->key == key) {
+                return i->second;
+            }
+        }
+        return entries.end();
+    }
+
+    void erase(std::list<Entry>::iterator e)
+    {
+        auto range = index.equal_range(e->hash);
+        for (auto i = range.first; i != range.second; ++i) {
+            if (i->second == e) {
+                index.erase(i);
+                break;
+            }
+        }
+        bytes -= e->bytes();
+        entries.erase(e);
+    }
+};
+
+Cache &cache()
+{
+    static Cache c;
+    return c;
+}
+
+void add_point(std::vector<double> &key, Geom::Point const &p)
+{
+    key.push_back(p[Geom::X]);
+    key.push_back(p[Geom::Y]);
+}
+
+std::size_t hash_key(std::vector<double> const &key)
+{
+    // FNV-1a over the bits of the values
+    std::uint64_t h = 14695981039346656037ULL;
+    for (double v : key) {
+        std::uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        h = (h ^ bits) * 1099511628211ULL;
+    }
+    return h;
+}
+
+}
+
+PolylineCache::PolylineCache(Path const &path, Conversion conversion, double threshold)
+    : _hash(0)
+    , _cacheable(false)
+{
+    // Straight lines are copied as they are, which is as fast as looking them up
+    for (auto cmd : path.descr_cmd) {
+        int const type = cmd->getType();
+        if (type == descr_cubicto || type == descr_arcto || type == descr_bezierto ||
+            (conversion == CONVERT_EVEN_LINES && type == descr_lineto)) {
+            _cacheable = true;
+            break;
+        }
+    }
+    if (!_cacheable) {
+        return;
+    }
+
+    _key.reserve(2 + 7 * path.descr_cmd.size());
+    _key.push_back(conversion);
+    _key.push_back(threshold);
+    for (auto cmd : path.descr_cmd) {
+        int const type = cmd->getType();
+        _key.push_back(type);
+        switch (type) {
+            case descr_moveto:
+                add_point(_key, static_cast<PathDescrMoveTo *>(cmd)->p);
+                break;
+            case descr_lineto:
+                add_point(_key, static_cast<PathDescrLineTo *>(cmd)->p);
+                break;
+            case descr_cubicto: {
+                PathDescrCubicTo *c = static_cast<PathDescrCubicTo *>(cmd);
+                add_point(_key, c->p);
+                add_point(_key, c->start);
+                add_point(_key, c->end);
+                break;
+            }
+            case descr_bezierto: {
+                PathDescrBezierTo *b = static_cast<PathDescrBezierTo *>(cmd);
+                add_point(_key, b->p);
+                _key.push_back(b->nb);
+                break;
+            }
+            case descr_interm_bezier:
+                add_point(_key, static_cast<PathDescrIntermBezierTo *>(cmd)->p);
+                break;
+            case descr_arcto: {
+                PathDescrArcTo *a = static_cast<PathDescrArcTo *>(cmd);
+                add_point(_key, a->p);
+                _key.push_back(a->rx);
+                _key.push_back(a->ry);
+                _key.push_back(a->angle);
+                _key.push_back(a->large);
+                _key.push_back(a->clockwise);
+                break;
+            }
+            default:
+                // close and forced points are not positioned by their description
+                break;
+        }
+    }
+    _hash = hash_key(_key);
+}
+
+bool PolylineCache::fetch(Path &path) const
+{
+    if (!_cacheable) {
+        return false;
+    }
+
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    auto e = c.find(_key, _hash);
+    if (e == c.entries.end()) {
+        return false;
+    }
+    c.entries.splice(c.entries.begin(), c.entries, e);
+
+    path.pts.assign(e->pts.begin(), e->pts.end());
+    for (std::size_t i = 0; i < e->associated.size(); ++i) {
+        path.descr_cmd[i]->associated = e->associated[i];
+    }
+    return true;
+}
+
+void PolylineCache::store(Path const &path) const
+{
+    if (!_cacheable) {
+        return;
+    }
+
+    Entry entry;
+    entry.key = _key;
+    entry.hash = _hash;
+    entry.pts.assign(path.pts.begin(), path.pts.end());
+    // ConvertWithBackData() records the origin of the points in the points themselves
+    if (_key[0] != CONVERT_WITH_BACK_DATA) {
+        entry.associated.reserve(path.descr_cmd.size());
+        for (auto cmd : path.descr_cmd) {
+            entry.associated.push_back(cmd->associated);
+        }
+    }
+    std::size_t const bytes = entry.bytes();
+    if (bytes > MAX_ENTRY_BYTES) {
+        return;
+    }
+
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    // another thread may have converted the same path meanwhile
+    auto existing = c.find(_key, _hash);
+    if (existing != c.entries.end()) {
+        c.erase(existing);
+    }
+    while (!c.entries.empty() && c.bytes + bytes > MAX_CACHED_BYTES) {
+        c.erase(std::prev(c.entries.end()));
+    }
+    c.entries.push_front(std::move(entry));
+    c.index.emplace(_hash, c.entries.begin());
+    c.bytes += bytes;
+}
+
+void PolylineCache::clear()
+{
+    Cache &c = cache();
+    std::lock_guard<std::mutex> lock(c.mutex);
+    c.index.clear();
+    c.entries.clear();
+    c.bytes = 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
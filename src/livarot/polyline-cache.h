@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Cache of the polylines made from livarot paths.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_LIVAROT_POLYLINE_CACHE_H
+#define SEEN_LIVAROT_POLYLINE_CACHE_H
+
+#include <cstddef>
+#include <vector>
+
+class Path;
+
+/**
+ * Remembers the polylines recently made by Path::Convert(), Path::ConvertWithBackData()
+ * and Path::ConvertEvenLines(), so that converting the same path description with the same
+ * threshold again only copies the points.
+ *
+ * Offsetting, outlining and tweaking convert the same paths over and over, e.g. the source
+ * of a dynamic offset on every change of its radius. The cache is shared by all paths and
+ * threads, and keeps a limited amount of points, dropping the least recently used ones.
+ *
+ * Usage, in a conversion function:
+ * @code
+ * PolylineCache cache(*this, PolylineCache::CONVERT, treshhold);
+ * if (cache.fetch(*this)) return;
+ * // ... make the polyline ...
+ * cache.store(*this);
+ * @endcode
+ */
+class PolylineCache {
+public:
+    enum Conversion {
+        CONVERT,
+        CONVERT_WITH_BACK_DATA,
+        CONVERT_EVEN_LINES
+    };
+
+    /// Describe the conversion of the current description of @a path.
+    PolylineCache(Path const &path, Conversion conversion, double threshold);
+
+    /**
+     * Set the polyline of @a path (and the polyline indices in its description) from the
+     * cache.
+     * @return false if the polyline was not in the cache.
+     */
+    bool fetch(Path &path) const;
+    /// Remember the polyline of @a path.
+    void store(Path const &path) const;
+
+    /// Forget all polylines.
+    static void clear();
+
+private:
+    std::vector<double> _key;
+    std::size_t _hash;
+    bool _cacheable;
+};
+
+#endif /* !SEEN_LIVAROT_POLYLINE_CACHE_H */
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
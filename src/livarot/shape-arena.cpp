@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Memory for the arrays of livarot shapes and paths.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "livarot/shape-arena.h"
+
+namespace {
+
+/// The smallest size class holds blocks of 2^MIN_CLASS_SHIFT bytes.
+int const MIN_CLASS_SHIFT = 6;
+/// Larger blocks are not kept.
+int const MAX_CLASS_SHIFT = 24;
+int const CLASS_COUNT = MAX_CLASS_SHIFT - MIN_CLASS_SHIFT + 1;
+/// Number of free blocks kept per size class.
+size_t const MAX_BLOCKS_PER_CLASS = 16;
+/// Total size of the free blocks kept by one thread.
+size_t const MAX_KEPT_BYTES = 32 << 20;
+
+/// Returns the size class of a block, or -1 if blocks of this size are not kept.
+int size_class(size_t bytes)
+{
+    int shift = MIN_CLASS_SHIFT;
+    while ((size_t(1) << shift) < bytes) {
+        if (++shift > MAX_CLASS_SHIFT) {
+            return -1;
+        }
+    }
+    return shift - MIN_CLASS_SHIFT;
+}
+
+size_t class_size(int c)
+{
+    return size_t(1) << (c + MIN_CLASS_SHIFT);
+}
+
+struct FreeBlocks {
+    std::vector<void *> blocks[CLASS_COUNT];
+    size_t kept;
+
+    FreeBlocks() : kept(0) {}
+    ~FreeBlocks();
+
+    void release()
+    {
+        for (auto &list : blocks) {
+            for (auto block : list) {
+                std::free(block);
+            }
+            list.clear();
+        }
+        kept = 0;
+    }
+};
+
+// Shapes owned by other thread-local or static objects can be freed after the free lists
+// of their thread are gone; their blocks are then returned to the system.
+thread_local bool free_blocks_destroyed = false;
+
+FreeBlocks::~FreeBlocks()
+{
+    release();
+    free_blocks_destroyed = true;
+}
+
+FreeBlocks *free_blocks()
+{
+    if (free_blocks_destroyed) {
+        return nullptr;
+    }
+    thread_local FreeBlocks blocks;
+    return &blocks;
+}
+
+}
+
+void *ShapeArena::allocate(size_t bytes)
+{
+    int c = size_class(bytes);
+    if (c < 0) {
+        return std::malloc(bytes);
+    }
+
+    FreeBlocks *free = free_blocks();
+    if (free && !free->blocks[c].empty()) {
+        void *block = free->blocks[c].back();
+        free->blocks[c].pop_back();
+        free->kept -= class_size(c);
+        return block;
+    }
+    return std::malloc(class_size(c));
+}
+
+void ShapeArena::deallocate(void *block, size_t bytes)
+{
+    if (!block) {
+        return;
+    }
+
+    int c = size_class(bytes);
+    FreeBlocks *free = c < 0 ? nullptr : free_blocks();
+    if (!free || free->blocks[c].size() >= MAX_BLOCKS_PER_CLASS ||
+        free->kept + class_size(c) > MAX_KEPT_BYTES) {
+        std::free(block);
+        return;
+    }
+    free->blocks[c].push_back(block);
+    free->kept += class_size(c);
+}
+
+void *ShapeArena::reallocate(void *block, size_t old_bytes, size_t new_bytes)
+{
+    if (!block) {
+        return allocate(new_bytes);
+    }
+    int old_class = size_class(old_bytes);
+    if (old_class >= 0 && old_class == size_class(new_bytes)) {
+        return block;
+    }
+
+    void *result = allocate(new_bytes);
+    if (result) {
+        std::memcpy(result, block, std::min(old_bytes, new_bytes));
+        deallocate(block, old_bytes);
+    }
+    return result;
+}
+
+void ShapeArena::trim()
+{
+    if (FreeBlocks *free = free_blocks()) {
+        free->release();
+    }
+}
+
+size_t ShapeArena::keptBytes()
+{
+    FreeBlocks *free = free_blocks();
+    return free ? free->kept : 0;
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
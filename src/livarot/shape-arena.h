@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Memory for the arrays of livarot shapes and paths.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#ifndef SEEN_LIVAROT_SHAPE_ARENA_H
+#define SEEN_LIVAROT_SHAPE_ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ * Keeps the blocks freed by livarot, so that they can be handed out again.
+ *
+ * A boolean operation creates several shapes and paths, sweeps them and throws them away.
+ * When many operations run in a row, the same point, edge and sweep arrays are allocated
+ * and freed over and over; here they are taken from a per-thread list of free blocks
+ * instead. Sizes are rounded up to a power of two, so that a freed block fits the next
+ * request of the same size class.
+ *
+ * Memory may be freed on another thread than the one which allocated it.
+ */
+class ShapeArena {
+public:
+    static void *allocate(size_t bytes);
+    static void deallocate(void *block, size_t bytes);
+    static void *reallocate(void *block, size_t old_bytes, size_t new_bytes);
+
+    /// Free the blocks kept for the calling thread, e.g. after a large operation.
+    static void trim();
+    /// Total size of the free blocks kept for the calling thread.
+    static size_t keptBytes();
+
+    /**
+     * Standard allocator taking its memory from the arena, for the arrays stored in
+     * std::vector.
+     */
+    template <typename T>
+    class Allocator {
+    public:
+        typedef T value_type;
+
+        Allocator() = default;
+        template <typename U>
+        Allocator(Allocator<U> const &) {}
+
+        T *allocate(size_t n)
+        {
+            void *block = ShapeArena::allocate(n * sizeof(T));
+            if (!block) {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(block);
+        }
+        void deallocate(T *p, size_t n) { ShapeArena::deallocate(p, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(Allocator<U> const &) const { return true; }
+        template <typename U>
+        bool operator!=(Allocator<U> const &) const { return false; }
+    };
+
+    template <typename T>
+    using Vector = std::vector<T, Allocator<T>>;
+};
+
+#endif /* !SEEN_LIVAROT_SHAPE_ARENA_H */
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
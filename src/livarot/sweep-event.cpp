@@ -7,7 +7,7 @@
  * Copyright (C) 2018 Authors
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
-#include <glib.h>
+#include "livarot/shape-arena.h"
 #include "livarot/sweep-event-queue.h"
 #include "livarot/sweep-tree.h"
 #include "livarot/sweep-event.h"
@@ -18,14 +18,14 @@ SweepEventQueue::SweepEventQueue(int s) : nbEvt(0), maxEvt(s)
     /* FIXME: use new[] for this, but this causes problems when delete[]
     ** calls the SweepEvent destructors.
     */
-    events = (SweepEvent *) g_malloc(maxEvt * sizeof(SweepEvent));
-    inds = new int[maxEvt];
+    events = (SweepEvent *) ShapeArena::allocate(maxEvt * sizeof(SweepEvent));
+    inds = (int *) ShapeArena::allocate(maxEvt * sizeof(int));
 }
 
 SweepEventQueue::~SweepEventQueue()
 {
-    g_free(events);
-    delete []inds;
+    ShapeArena::deallocate(events, maxEvt * sizeof(SweepEvent));
+    ShapeArena::deallocate(inds, maxEvt * sizeof(int));
 }
 
 SweepEvent *SweepEventQueue::add(SweepTree *iLeft, SweepTree *iRight, Geom::Point &px, double itl, double itr)
@@ -7,7 +7,7 @@
  * Copyright (C) 2018 Authors
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
-#include <glib.h>
+#include "livarot/shape-arena.h"
 #include "livarot/sweep-tree.h"
 #include "livarot/sweep-tree-list.h"
 
@@ -15,7 +15,7 @@
 SweepTreeList::SweepTreeList(int s) :
     nbTree(0),
     maxTree(s),
-    trees((SweepTree *) g_malloc(s * sizeof(SweepTree))),
+    trees((SweepTree *) ShapeArena::allocate(s * sizeof(SweepTree))),
     racine(nullptr)
 {
     /* FIXME: Use new[] for trees initializer above, but watch out for bad things happening when
@@ -26,7 +26,7 @@ SweepTreeList::SweepTreeList(int s) :
 
 SweepTreeList::~SweepTreeList()
 {
-    g_free(trees);
+    ShapeArena::deallocate(trees, maxTree * sizeof(SweepTree));
     trees = nullptr;
 }
 
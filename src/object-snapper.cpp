@@ -13,6 +13,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
+
 #include <2geom/circle.h>
 #include <2geom/line.h>
 #include <2geom/path-intersection.h>
@@ -20,8 +22,10 @@
 
 #include "desktop.h"
 #include "document.h"
+#include "helper/geom.h"
 #include "inkscape.h"
 #include "preferences.h"
+#include "snap-index.h"
 #include "text-editing.h"
 
 #include "object/sp-clippath.h"
@@ -44,6 +48,7 @@ Inkscape::ObjectSnapper::ObjectSnapper(SnapManager *sm, Geom::Coord const d)
     _candidates = new std::vector<SnapCandidateItem>;
     _points_to_snap_to = new std::vector<SnapCandidatePoint>;
     _paths_to_snap_to = new std::vector<SnapCandidatePath >;
+    _index = new SnapIndex;
 }
 
 Inkscape::ObjectSnapper::~ObjectSnapper()
@@ -56,6 +61,8 @@ Inkscape::ObjectSnapper::~ObjectSnapper()
 
     _clear_paths();
     delete _paths_to_snap_to;
+
+    delete _index;
 }
 
 Geom::Coord Inkscape::ObjectSnapper::getSnapperTolerance() const
@@ -162,6 +169,83 @@ void Inkscape::ObjectSnapper::_findCandidates(SPObject* parent,
 }
 
 
+void Inkscape::ObjectSnapper::_findIndexedCandidates(std::vector<SPItem const *> const *it,
+                                                     Geom::Rect const &bbox_to_snap) const
+{
+    SPDesktop const *dt = _snapmanager->getDesktop();
+    if (dt == nullptr) {
+        g_warning("desktop == NULL, so we cannot snap; please inform the developers of this bug");
+        return;
+    }
+
+    _candidates->clear();
+
+    Geom::Rect bbox_to_snap_incl = bbox_to_snap; // _incl means: will include the snapper tolerance
+    bbox_to_snap_incl.expandBy(getSnapperTolerance());
+
+    // Same choice of bounding box as in _findCandidates()
+    Preferences *prefs = Preferences::get();
+    int prefs_bbox = prefs->getBool("/tools/bounding_box", false);
+    SPItem::BBoxType bbox_type = (!prefs_bbox && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_BBOX_CATEGORY)) ?
+        SPItem::VISUAL_BBOX : SPItem::GEOMETRIC_BBOX;
+
+    std::vector<SPItem *> items;
+    _index->query(_snapmanager->getDocument(), bbox_type, bbox_to_snap_incl,
+                  _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_ROTATION_CENTER), items);
+
+    // The index returns the items in no particular order, so they are put in document order
+    // to choose the same ones as _findCandidates() when there are too many of them
+    items.erase(std::remove_if(items.begin(), items.end(),
+                               [&](SPItem *item) { return !_isSnappable(item, it); }),
+                items.end());
+    std::sort(items.begin(), items.end(), sp_object_compare_position_bool);
+    for (auto item : items) {
+        _candidates->push_back(SnapCandidateItem(item, false, Geom::identity()));
+        if (_candidates->size() > 200) { // This makes Inkscape crawl already
+            return;
+        }
+    }
+
+    // Clipping paths and masks are not in the index; they are searched like before
+    for (auto item : _index->clippedItems()) {
+        if (!_isSnappable(item, it)) {
+            continue;
+        }
+        SPObject *obj = item->clip_ref ? item->clip_ref->getObject() : nullptr;
+        if (obj && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH_CLIP)) {
+            _findCandidates(obj, it, false, bbox_to_snap, true, item->i2doc_affine());
+        }
+        obj = item->mask_ref ? item->mask_ref->getObject() : nullptr;
+        if (obj && _snapmanager->snapprefs.isTargetSnappable(SNAPTARGET_PATH_MASK)) {
+            _findCandidates(obj, it, false, bbox_to_snap, true, item->i2doc_affine());
+        }
+    }
+}
+
+/**
+ * Returns false if the item or one of its ancestors is hidden or on the ignore list.
+ */
+bool Inkscape::ObjectSnapper::_isSnappable(SPItem const *item, std::vector<SPItem const *> const *it) const
+{
+    SPDesktop const *dt = _snapmanager->getDesktop();
+    SPObject const *root = _snapmanager->getDocument()->getRoot();
+    for (SPObject const *o = item; o && o != root; o = o->parent) {
+        SPItem const *ancestor = dynamic_cast<SPItem const *>(o);
+        if (!ancestor) {
+            continue;
+        }
+        // Snapping to items in a locked layer is allowed
+        if (dt->itemIsHidden(ancestor)) {
+            return false;
+        }
+        if (it != nullptr && std::find(it->begin(), it->end(), ancestor) != it->end()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 void Inkscape::ObjectSnapper::_collectNodes(SnapSourceType const &t,
                                             bool const &first_point) const
 {
@@ -515,64 +599,59 @@ void Inkscape::ObjectSnapper::_snapPaths(IntermSnapResults &isr,
             bool const being_edited = node_tool_active && (*it_p).currently_being_edited;
             //if true then this pathvector it_pv is currently being edited in the node tool
 
-            for(Geom::PathVector::iterator it_pv = (it_p->path_vector)->begin(); it_pv != (it_p->path_vector)->end(); ++it_pv) {
-                // Find a nearest point for each curve within this path
-                // n curves will return n time values with 0 <= t <= 1
-                std::vector<double> anp = (*it_pv).nearestTimePerCurve(p_doc);
-
-                //std::cout << "#nearest points = " << anp.size() << " | p = " << p.getPoint() << std::endl;
-                // Now we will examine each of the nearest points, and determine whether it's within snapping range and if we should snap to it
-                std::vector<double>::const_iterator np = anp.begin();
-                unsigned int index = 0;
-                for (; np != anp.end(); ++np, index++) {
-                    Geom::Curve const *curve = &(it_pv->at(index));
-                    Geom::Point const sp_doc = curve->pointAt(*np);
-                    //dt->snapindicator->set_new_debugging_point(sp_doc*dt->doc2dt());
-                    bool c1 = true;
-                    bool c2 = true;
-                    if (being_edited) {
-                        /* If the path is being edited, then we should only snap though to stationary pieces of the path
-                         * and not to the pieces that are being dragged around. This way we avoid
-                         * self-snapping. For this we check whether the nodes at both ends of the current
-                         * piece are unselected; if they are then this piece must be stationary
-                         */
-                        g_assert(unselected_nodes != nullptr);
-                        Geom::Point start_pt = dt->doc2dt(curve->pointAt(0));
-                        Geom::Point end_pt = dt->doc2dt(curve->pointAt(1));
-                        c1 = isUnselectedNode(start_pt, unselected_nodes);
-                        c2 = isUnselectedNode(end_pt, unselected_nodes);
-                        /* Unfortunately, this might yield false positives for coincident nodes. Inkscape might therefore mistakenly
-                         * snap to path segments that are not stationary. There are at least two possible ways to overcome this:
-                         * - Linking the individual nodes of the SPPath we have here, to the nodes of the NodePath::SubPath class as being
-                         *   used in sp_nodepath_selected_nodes_move. This class has a member variable called "selected". For this the nodes
-                         *   should be in the exact same order for both classes, so we can index them
-                         * - Replacing the SPPath being used here by the NodePath::SubPath class; but how?
-                         */
-                    }
+            // Find the nearest point of each curve within snapping range; the curves out of range
+            // are culled by their bounding boxes, without searching them
+            std::vector<Geom::Coord> dists;
+            std::vector<Geom::PathVectorTime> const anp = pathv_nearest_times(*it_p->path_vector, p_doc, getSnapperTolerance(), 0, &dists);
+
+            // Now we will examine each of the nearest points, and determine whether we should snap to it
+            for (std::size_t i = 0; i < anp.size(); i++) {
+                unsigned int const index = anp[i].curve_index;
+                Geom::Curve const *curve = &((*it_p->path_vector)[anp[i].path_index].at(index));
+                Geom::Point const sp_doc = curve->pointAt(anp[i].t);
+                //dt->snapindicator->set_new_debugging_point(sp_doc*dt->doc2dt());
+                bool c1 = true;
+                bool c2 = true;
+                if (being_edited) {
+                    /* If the path is being edited, then we should only snap though to stationary pieces of the path
+                     * and not to the pieces that are being dragged around. This way we avoid
+                     * self-snapping. For this we check whether the nodes at both ends of the current
+                     * piece are unselected; if they are then this piece must be stationary
+                     */
+                    g_assert(unselected_nodes != nullptr);
+                    Geom::Point start_pt = dt->doc2dt(curve->pointAt(0));
+                    Geom::Point end_pt = dt->doc2dt(curve->pointAt(1));
+                    c1 = isUnselectedNode(start_pt, unselected_nodes);
+                    c2 = isUnselectedNode(end_pt, unselected_nodes);
+                    /* Unfortunately, this might yield false positives for coincident nodes. Inkscape might therefore mistakenly
+                     * snap to path segments that are not stationary. There are at least two possible ways to overcome this:
+                     * - Linking the individual nodes of the SPPath we have here, to the nodes of the NodePath::SubPath class as being
+                     *   used in sp_nodepath_selected_nodes_move. This class has a member variable called "selected". For this the nodes
+                     *   should be in the exact same order for both classes, so we can index them
+                     * - Replacing the SPPath being used here by the NodePath::SubPath class; but how?
+                     */
+                }
 
-                    Geom::Point const sp_dt = dt->doc2dt(sp_doc);
-                    if (!being_edited || (c1 && c2)) {
-                        Geom::Coord dist = Geom::distance(sp_doc, p_doc);
-                        // std::cout << "  dist -> " << dist << std::endl;
-                        if (dist < getSnapperTolerance()) {
-                            // Add the curve we have snapped to
-                            Geom::Point sp_tangent_dt = Geom::Point(0,0);
-                            if (p.getSourceType() == Inkscape::SNAPSOURCE_GUIDE_ORIGIN) {
-                                // We currently only use the tangent when snapping guides, so only in this case we will
-                                // actually calculate the tangent to avoid wasting CPU cycles
-                                Geom::Point sp_tangent_doc = curve->unitTangentAt(*np);
-                                sp_tangent_dt = dt->doc2dt(sp_tangent_doc) - dt->doc2dt(Geom::Point(0,0));
-                            }
-                            isr.curves.emplace_back(sp_dt, sp_tangent_dt, num_path, index, dist, getSnapperTolerance(), getSnapperAlwaysSnap(), false, curve, p.getSourceType(), p.getSourceNum(), it_p->target_type, it_p->target_bbox);
-                            if (snap_tang || snap_perp) {
-                                // For each curve that's within snapping range, we will now also search for tangential and perpendicular snaps
-                                _snapPathsTangPerp(snap_tang, snap_perp, isr, p, curve, dt);
-                            }
-                        }
+                Geom::Point const sp_dt = dt->doc2dt(sp_doc);
+                if (!being_edited || (c1 && c2)) {
+                    Geom::Coord const dist = dists[i];
+                    // std::cout << "  dist -> " << dist << std::endl;
+                    // Add the curve we have snapped to
+                    Geom::Point sp_tangent_dt = Geom::Point(0,0);
+                    if (p.getSourceType() == Inkscape::SNAPSOURCE_GUIDE_ORIGIN) {
+                        // We currently only use the tangent when snapping guides, so only in this case we will
+                        // actually calculate the tangent to avoid wasting CPU cycles
+                        Geom::Point sp_tangent_doc = curve->unitTangentAt(anp[i].t);
+                        sp_tangent_dt = dt->doc2dt(sp_tangent_doc) - dt->doc2dt(Geom::Point(0,0));
+                    }
+                    isr.curves.emplace_back(sp_dt, sp_tangent_dt, num_path + anp[i].path_index, index, dist, getSnapperTolerance(), getSnapperAlwaysSnap(), false, curve, p.getSourceType(), p.getSourceNum(), it_p->target_type, it_p->target_bbox);
+                    if (snap_tang || snap_perp) {
+                        // For each curve that's within snapping range, we will now also search for tangential and perpendicular snaps
+                        _snapPathsTangPerp(snap_tang, snap_perp, isr, p, curve, dt);
                     }
                 }
-                num_path++;
-            } // End of: for (Geom::PathVector::iterator ....)
+            }
+            num_path += it_p->path_vector->size();
         }
     }
 }
@@ -644,7 +723,7 @@ void Inkscape::ObjectSnapper::_snapPathsConstrained(IntermSnapResults &isr,
     for (std::vector<SnapCandidatePath >::const_iterator k = _paths_to_snap_to->begin(); k != _paths_to_snap_to->end(); ++k) {
         if (k->path_vector && _allowSourceToSnapToTarget(p.getSourceType(), (*k).target_type, strict_snapping)) {
             // Do the intersection math
-            std::vector<Geom::PVIntersection> inters = constraint_path.intersect(*(k->path_vector));
+            std::vector<Geom::PVIntersection> inters = pathv_intersections(constraint_path, *(k->path_vector));
 
             // Convert the collected intersections to snapped points
             for (std::vector<Geom::PVIntersection>::const_iterator i = inters.begin(); i != inters.end(); ++i) {
@@ -676,7 +755,7 @@ void Inkscape::ObjectSnapper::freeSnap(IntermSnapResults &isr,
     /* Get a list of all the SPItems that we will try to snap to */
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(p.getPoint(), p.getPoint());
-        _findCandidates(_snapmanager->getDocument()->getRoot(), it, p.getSourceNum() <= 0, local_bbox_to_snap, false, Geom::identity());
+        _findIndexedCandidates(it, local_bbox_to_snap);
     }
 
     _snapNodes(isr, p, unselected_nodes);
@@ -721,7 +800,7 @@ void Inkscape::ObjectSnapper::constrainedSnap( IntermSnapResults &isr,
     /* Get a list of all the SPItems that we will try to snap to */
     if (p.getSourceNum() <= 0) {
         Geom::Rect const local_bbox_to_snap = bbox_to_snap ? *bbox_to_snap : Geom::Rect(pp, pp);
-        _findCandidates(_snapmanager->getDocument()->getRoot(), it, p.getSourceNum() <= 0, local_bbox_to_snap, false, Geom::identity());
+        _findIndexedCandidates(it, local_bbox_to_snap);
     }
 
     // A constrained snap, is a snap in only one degree of freedom (specified by the constraint line).
@@ -26,6 +26,8 @@ namespace Inkscape
 /**
  * Snapping things to objects.
  */
+class SnapIndex;
+
 class ObjectSnapper : public Snapper
 {
 
@@ -63,6 +65,17 @@ private:
     std::vector<SnapCandidateItem> *_candidates;
     std::vector<SnapCandidatePoint> *_points_to_snap_to;
     std::vector<SnapCandidatePath > *_paths_to_snap_to;
+    SnapIndex *_index;
+
+    /**
+     * Find all items within snapping range, using the spatial index of the document.
+     * @param it List of items to ignore.
+     * @param bbox_to_snap Bounding box hulling the whole bunch of points, all from the same selection and having the same transformation.
+     */
+    void _findIndexedCandidates(std::vector<SPItem const *> const *it,
+                                Geom::Rect const &bbox_to_snap) const;
+
+    bool _isSnappable(SPItem const *item, std::vector<SPItem const *> const *it) const;
 
     /**
      * Find all items within snapping range.
@@ -17,8 +17,12 @@
 
 #include "sp-offset.h"
 
+#include <algorithm>
 #include <cstring>
+#include <memory>
+#include <numeric>
 #include <string>
+#include <unordered_map>
 
 #include <glibmm/i18n.h>
 
@@ -29,6 +33,7 @@
 
 #include "livarot/Path.h"
 #include "livarot/Shape.h"
+#include "livarot/path-description.h"
 
 #include "enums.h"
 #include "preferences.h"
@@ -82,10 +87,21 @@ static void sp_offset_source_modified (SPObject *iSource, guint flags, SPItem *i
 //but reverted because bug #1507049 seems has more priority.
 static bool   use_slow_but_correct_offset_method = false;
 
+/**
+ * Offsets of the separate regions of the source of an offset, as computed by the last
+ * SPOffset::set_shape(), so that the regions which did not change can be reused.
+ */
+struct SPOffsetRegionCache {
+    float rad = 0;
+    /// offsets by rad, by SVG description of the region of the source
+    std::unordered_map<std::string, std::unique_ptr<Path> > offsets;
+};
+
 SPOffset::SPOffset() : SPShape() {
     this->rad = 1.0;
     this->original = nullptr;
     this->originalPath = nullptr;
+    this->regionCache = new SPOffsetRegionCache;
     this->knotSet = false;
     this->sourceDirty=false;
     this->isUpdating=false;
@@ -101,6 +117,7 @@ SPOffset::SPOffset() : SPShape() {
 
 SPOffset::~SPOffset() {
     delete this->sourceRef;
+    delete this->regionCache;
 
     this->_modified_connection.disconnect();
     this->_delete_connection.disconnect();
@@ -335,6 +352,134 @@ gchar* SPOffset::description() const {
             _("outset") : _("inset"), fabs (this->rad));
 }
 
+/**
+ * Split the source of an offset into regions: groups of subpaths whose offsets by rad may touch
+ * each other. The offsets of different regions do not overlap, so each region can be offset on
+ * its own.
+ */
+static std::vector<std::unique_ptr<Path> > sp_offset_split_regions(Path *source, float rad)
+{
+    // subpaths, as ranges of commands
+    std::vector<std::pair<int, int> > subpaths;
+    for (int i = 0; i < int(source->descr_cmd.size()); i++) {
+        if (source->descr_cmd[i]->getType() == descr_moveto || subpaths.empty()) {
+            subpaths.emplace_back(i, i + 1);
+        } else {
+            subpaths.back().second = i + 1;
+        }
+    }
+
+    int const nb = subpaths.size();
+    std::vector<int> region(nb, 0);
+    Geom::PathVector *pv = source->MakePathVector();
+    if (int(pv->size()) == nb) {
+        // the outline stays within rad of the source, give or take the polyline approximation
+        double const margin = fabs(rad) + 1.0;
+        std::vector<Geom::OptRect> bounds(nb);
+        std::vector<int> order;
+        for (int i = 0; i < nb; i++) {
+            bounds[i] = (*pv)[i].boundsFast();
+            if (bounds[i]) {
+                bounds[i]->expandBy(margin);
+                order.push_back(i);
+            }
+        }
+        std::sort(order.begin(), order.end(), [&bounds](int a, int b) {
+            return bounds[a]->left() < bounds[b]->left();
+        });
+
+        // union-find of the subpaths whose bounds intersect, swept from left to right
+        std::vector<int> parent(nb);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto root = [&parent](int i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        };
+        std::vector<int> active;
+        for (int i : order) {
+            active.erase(std::remove_if(active.begin(), active.end(), [&](int a) {
+                return bounds[a]->right() < bounds[i]->left();
+            }), active.end());
+            for (int a : active) {
+                if (bounds[a]->intersects(*bounds[i])) {
+                    parent[root(a)] = root(i);
+                }
+            }
+            active.push_back(i);
+        }
+        for (int i = 0; i < nb; i++) {
+            region[i] = root(i);
+        }
+    }
+    delete pv;
+
+    // the subpaths keep their order within the regions
+    std::vector<std::unique_ptr<Path> > regions;
+    std::vector<int> index(nb, -1);
+    for (int i = 0; i < nb; i++) {
+        int &r = index[region[i]];
+        if (r < 0) {
+            r = regions.size();
+            regions.emplace_back(new Path);
+        }
+        for (int j = subpaths[i].first; j < subpaths[i].second; j++) {
+            regions[r]->descr_cmd.push_back(source->descr_cmd[j]->clone());
+        }
+    }
+    return regions;
+}
+
+/**
+ * Offset one region of the source by its outline.
+ */
+static Path *sp_offset_region(Path *source, float rad)
+{
+    Shape *theShape = new Shape;
+    Shape *theRes = new Shape;
+    Path *originaux[1];
+    Path *res = new Path;
+    res->SetBackData (false);
+
+    // and now: offset
+    float o_width;
+    if (rad >= 0)
+    {
+        o_width = rad;
+        source->OutsideOutline (res, o_width, join_round, butt_straight, 20.0);
+    }
+    else
+    {
+        o_width = -rad;
+        source->OutsideOutline (res, -o_width, join_round, butt_straight, 20.0);
+    }
+
+    if (o_width >= 1.0)
+    {
+        //      res->ConvertForOffset (1.0, orig, offset->rad);
+        res->ConvertWithBackData (1.0);
+    }
+    else
+    {
+        //      res->ConvertForOffset (o_width, orig, offset->rad);
+        res->ConvertWithBackData (o_width);
+    }
+    res->Fill (theShape, 0);
+    theRes->ConvertToShape (theShape, fill_positive);
+    originaux[0] = res;
+
+    Path *dest = new Path;
+    theRes->ConvertToForme (dest, 1, originaux);
+
+    delete theShape;
+    delete theRes;
+    delete res;
+
+    return dest;
+}
+
 void SPOffset::set_shape() {
     if ( this->originalPath == nullptr ) {
         // oops : no path?! (the offset object should do harakiri)
@@ -377,40 +522,35 @@ void SPOffset::set_shape() {
 
     if ( use_slow_but_correct_offset_method == false ) {
         // version par outline
-        Shape *theShape = new Shape;
-        Shape *theRes = new Shape;
-        Path *originaux[1];
-        Path *res = new Path;
-        res->SetBackData (false);
-
-        // and now: offset
-        float o_width;
-        if (this->rad >= 0)
-        {
-            o_width = this->rad;
-            orig->OutsideOutline (res, o_width, join_round, butt_straight, 20.0);
-        }
-        else
-        {
-            o_width = -this->rad;
-            orig->OutsideOutline (res, -o_width, join_round, butt_straight, 20.0);
-        }
-
-        if (o_width >= 1.0)
-        {
-            //      res->ConvertForOffset (1.0, orig, offset->rad);
-            res->ConvertWithBackData (1.0);
-        }
-        else
-        {
-            //      res->ConvertForOffset (o_width, orig, offset->rad);
-            res->ConvertWithBackData (o_width);
+        // The regions of the source are offset separately, and the offsets of the regions
+        // which did not change since the last time are reused: dragging a node of a complex
+        // source only sweeps the region around that node again.
+        SPOffsetRegionCache *cache = this->regionCache;
+        SPOffsetRegionCache updated;
+        updated.rad = this->rad;
+
+        std::vector<std::unique_ptr<Path> > regions = sp_offset_split_regions(orig, this->rad);
+        orig->Reset();
+        for (auto &region : regions) {
+            char *d = region->svg_dump_path();
+            std::string const key = d;
+            g_free(d);
+
+            std::unique_ptr<Path> &offset = updated.offsets[key];
+            if (!offset) {
+                auto previous = (cache->rad == this->rad) ? cache->offsets.find(key) : cache->offsets.end();
+                if (previous != cache->offsets.end()) {
+                    offset = std::move(previous->second);
+                    cache->offsets.erase(previous);
+                } else {
+                    offset.reset(sp_offset_region(region.get(), this->rad));
+                }
+            }
+            for (auto cmd : offset->descr_cmd) {
+                orig->descr_cmd.push_back(cmd->clone());
+            }
         }
-        res->Fill (theShape, 0);
-        theRes->ConvertToShape (theShape, fill_positive);
-        originaux[0] = res;
-
-        theRes->ConvertToForme (orig, 1, originaux);
+        *cache = std::move(updated);
 
         Geom::OptRect bbox = this->documentVisualBounds();
 
@@ -440,10 +580,6 @@ void SPOffset::set_shape() {
         //   orig->ConvertEvenLines (o_width);
         //   orig->Simplify (0.5 * o_width);
         //  }
-
-        delete theShape;
-        delete theRes;
-        delete res;
     } else {
         // version par makeoffset
         Shape *theShape = new Shape;
@@ -21,6 +21,7 @@
 #define SP_IS_OFFSET(obj) (dynamic_cast<const SPOffset*>((SPObject*)obj) != NULL)
 
 class SPUseReference;
+struct SPOffsetRegionCache;
 
 /**
  * SPOffset class.
@@ -58,6 +59,7 @@ public:
     void *originalPath; ///< will be a livarot Path, just don't declare it here to please the gcc linker FIXME what?
     char *original;     ///< SVG description of the source path
     float rad;          ///< offset radius
+    SPOffsetRegionCache *regionCache; ///< offsets of the parts of the source, kept from one set_shape() to the next
 
     /// for interactive setting of the radius
     bool knotSet;
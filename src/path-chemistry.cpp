@@ -15,7 +15,16 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
+#endif
+
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
 #include <cstring>
+#include <map>
 #include <string>
 
 #include <glibmm/i18n.h>
@@ -41,6 +50,7 @@
 #include "object/sp-text.h"
 #include "style.h"
 
+#include "svg/path-string.h"
 #include "svg/svg.h"
 
 #include "xml/repr.h"
@@ -357,8 +367,9 @@ void ObjectSet::toLPEItems()
     addList(selected);
 }
 
-bool
-sp_item_list_to_curves(const std::vector<SPItem*> &items, std::vector<SPItem*>& selected, std::vector<Inkscape::XML::Node*> &to_select, bool skip_all_lpeitems)
+static bool
+sp_item_list_to_curves(const std::vector<SPItem*> &items, std::vector<SPItem*>& selected, std::vector<Inkscape::XML::Node*> &to_select, bool skip_all_lpeitems,
+                       std::map<SPItem *, Inkscape::XML::Node *> &text_reprs)
 {
     bool did = false;
     for (auto item : items){
@@ -420,14 +431,21 @@ sp_item_list_to_curves(const std::vector<SPItem*> &items, std::vector<SPItem*>&
             std::vector<Inkscape::XML::Node*> item_to_select;
             std::vector<SPItem*> item_selected;
             
-            if (sp_item_list_to_curves(item_list, item_selected, item_to_select))
+            if (sp_item_list_to_curves(item_list, item_selected, item_to_select, false, text_reprs))
                 did = true;
 
 
             continue;
         }
 
-        Inkscape::XML::Node *repr = sp_selected_item_to_curved_repr(item, 0);
+        Inkscape::XML::Node *repr = nullptr;
+        auto text_repr = text_reprs.find(item);
+        if (text_repr != text_reprs.end()) {
+            repr = text_repr->second;
+            text_reprs.erase(text_repr);
+        } else {
+            repr = sp_selected_item_to_curved_repr(item, 0);
+        }
         if (!repr)
             continue;
 
@@ -460,85 +478,210 @@ sp_item_list_to_curves(const std::vector<SPItem*> &items, std::vector<SPItem*>&
     return did;
 }
 
-Inkscape::XML::Node *
-sp_selected_item_to_curved_repr(SPItem *item, guint32 /*text_grouping_policy*/)
+/// Find the texts that sp_item_list_to_curves() converts, including those in groups.
+static void
+sp_item_list_find_texts(const std::vector<SPItem*> &items, std::vector<SPItem*> &texts)
 {
-    if (!item)
-        return nullptr;
+    for (auto item : items) {
+        if (SPGroup *group = dynamic_cast<SPGroup *>(item)) {
+            sp_item_list_find_texts(sp_item_group_item_list(group), texts);
+        } else if (dynamic_cast<SPText *>(item) || dynamic_cast<SPFlowtext *>(item)) {
+            texts.push_back(item);
+        }
+    }
+}
 
-    Inkscape::XML::Document *xml_doc = item->getRepr()->document();
+bool
+sp_item_list_to_curves(const std::vector<SPItem*> &items, std::vector<SPItem*>& selected, std::vector<Inkscape::XML::Node*> &to_select, bool skip_all_lpeitems)
+{
+    // Convert all texts at once, so that their glyphs are written in parallel
+    std::vector<SPItem*> texts;
+    sp_item_list_find_texts(items, texts);
+    std::vector<Inkscape::XML::Node*> reprs = sp_text_items_to_curved_reprs(texts);
+    std::map<SPItem *, Inkscape::XML::Node *> text_reprs;
+    for (std::size_t i = 0; i < texts.size(); i++) {
+        text_reprs[texts[i]] = reprs[i];
+    }
 
-    if (dynamic_cast<SPText *>(item) || dynamic_cast<SPFlowtext *>(item)) {
-        // Special treatment for text: convert each glyph to separate path, then group the paths
-        Inkscape::XML::Node *g_repr = xml_doc->createElement("svg:g");
-
-        // Save original text for accessibility.
-        Glib::ustring original_text = sp_te_get_string_multiline( item,
-                                                                  te_get_layout(item)->begin(),
-                                                                  te_get_layout(item)->end() );
-        if( original_text.size() > 0 ) {
-            g_repr->setAttribute("aria-label", original_text.c_str() );
+    bool did = sp_item_list_to_curves(items, selected, to_select, skip_all_lpeitems, text_reprs);
+
+    // texts replaced while removing the path effects of their groups
+    for (auto &text_repr : text_reprs) {
+        if (text_repr.second) {
+            Inkscape::GC::release(text_repr.second);
         }
+    }
+    return did;
+}
 
-        g_repr->setAttribute("transform", item->getRepr()->attribute("transform"));
-
-        Inkscape::copy_object_properties(g_repr, item->getRepr());
-
-        /* Whole text's style */
-        Glib::ustring style_str =
-            item->style->write( SP_STYLE_FLAG_IFDIFF, SP_STYLE_SRC_UNSET, item->parent ? item->parent->style : nullptr); // TODO investigate possibility
-        g_repr->setAttribute("style", style_str.c_str());
-
-        Inkscape::Text::Layout::iterator iter = te_get_layout(item)->begin();
-        do {
-            Inkscape::Text::Layout::iterator iter_next = iter;
-            iter_next.nextGlyph(); // iter_next is one glyph ahead from iter
-            if (iter == iter_next)
-                break;
-
-            /* This glyph's style */
-            SPObject const *pos_obj = nullptr;
-            void *rawptr = nullptr;
-            te_get_layout(item)->getSourceOfCharacter(iter, &rawptr);
-            if (!rawptr || !SP_IS_OBJECT(rawptr)) // no source for glyph, abort
-                break;       
-            pos_obj = reinterpret_cast<SPObject *>(rawptr);
-            while (dynamic_cast<SPString const *>(pos_obj) && pos_obj->parent) {
-               pos_obj = pos_obj->parent;   // SPStrings don't have style
-            }
-            Glib::ustring style_str =
-                pos_obj->style->write( SP_STYLE_FLAG_IFDIFF, SP_STYLE_SRC_UNSET, pos_obj->parent ? pos_obj->parent->style : nullptr); // TODO investigate possibility
-
-            // get path from iter to iter_next:
-            SPCurve *curve = te_get_layout(item)->convertToCurves(iter, iter_next);
-            iter = iter_next; // shift to next glyph
-            if (!curve) { // error converting this glyph
-                continue;
-            }
-            if (curve->is_empty()) { // whitespace glyph?
-                curve->unref();
-                continue;
-            }
+namespace {
 
-            Inkscape::XML::Node *p_repr = xml_doc->createElement("svg:path");
+/// The glyphs of a text, collected on the main thread and written on worker threads.
+struct TextOutline {
+    struct Glyph {
+        Geom::PathVector pathv;
+        std::size_t style;
+        std::string d;
+    };
 
-            gchar *def_str = sp_svg_write_path(curve->get_pathvector());
-            p_repr->setAttribute("d", def_str);
-            g_free(def_str);
+    SPItem *item;
+    std::vector<Glib::ustring> styles;
+    std::vector<Glyph> glyphs;
+};
+
+void collect_glyphs(SPItem *item, TextOutline &outline)
+{
+    Inkscape::Text::Layout const *layout = te_get_layout(item);
+    // Consecutive glyphs mostly come from the same object
+    std::map<SPObject const *, std::size_t> style_of;
+
+    outline.item = item;
+    Inkscape::Text::Layout::iterator iter = layout->begin();
+    do {
+        Inkscape::Text::Layout::iterator iter_next = iter;
+        iter_next.nextGlyph(); // iter_next is one glyph ahead from iter
+        if (iter == iter_next)
+            break;
+
+        /* This glyph's style */
+        SPObject const *pos_obj = nullptr;
+        void *rawptr = nullptr;
+        layout->getSourceOfCharacter(iter, &rawptr);
+        if (!rawptr || !SP_IS_OBJECT(rawptr)) // no source for glyph, abort
+            break;
+        pos_obj = reinterpret_cast<SPObject *>(rawptr);
+        while (dynamic_cast<SPString const *>(pos_obj) && pos_obj->parent) {
+           pos_obj = pos_obj->parent;   // SPStrings don't have style
+        }
+        auto style = style_of.find(pos_obj);
+        if (style == style_of.end()) {
+            style = style_of.emplace(pos_obj, outline.styles.size()).first;
+            outline.styles.push_back(
+                pos_obj->style->write( SP_STYLE_FLAG_IFDIFF, SP_STYLE_SRC_UNSET, pos_obj->parent ? pos_obj->parent->style : nullptr)); // TODO investigate possibility
+        }
+
+        // get path from iter to iter_next:
+        SPCurve *curve = layout->convertToCurves(iter, iter_next);
+        iter = iter_next; // shift to next glyph
+        if (!curve) { // error converting this glyph
+            continue;
+        }
+        if (curve->is_empty()) { // whitespace glyph?
             curve->unref();
+            continue;
+        }
+
+        TextOutline::Glyph glyph;
+        glyph.pathv = curve->get_pathvector();
+        glyph.style = style->second;
+        outline.glyphs.push_back(std::move(glyph));
+        curve->unref();
 
-            p_repr->setAttribute("style", style_str.c_str());
+        if (iter == layout->end())
+            break;
 
-            g_repr->appendChild(p_repr);
+    } while (true);
+}
+
+void write_glyphs(std::vector<TextOutline> &outlines)
+{
+    std::vector<TextOutline::Glyph *> glyphs;
+    for (auto &outline : outlines) {
+        for (auto &glyph : outline.glyphs) {
+            glyphs.push_back(&glyph);
+        }
+    }
+
+    // The preferences are not thread-safe: they are read here, and the workers copy the format
+    Inkscape::SVG::PathString const format;
+
+    int const count = glyphs.size();
+    int threads = 1;
+#if HAVE_OPENMP
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    threads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
+#endif
+
+#if HAVE_OPENMP
+#pragma omp parallel for schedule(static) num_threads(threads) if(count > 64)
+#endif
+    for (int i = 0; i < count; i++) {
+        Inkscape::SVG::PathString str(format);
+        sp_svg_write_path(str, glyphs[i]->pathv);
+        glyphs[i]->d = str.string();
+        glyphs[i]->pathv.clear();
+    }
+}
 
-            Inkscape::GC::release(p_repr);
+Inkscape::XML::Node *build_text_repr(TextOutline const &outline)
+{
+    SPItem *item = outline.item;
+    Inkscape::XML::Document *xml_doc = item->getRepr()->document();
+    Inkscape::XML::Node *g_repr = xml_doc->createElement("svg:g");
+
+    // Save original text for accessibility.
+    Glib::ustring original_text = sp_te_get_string_multiline( item,
+                                                              te_get_layout(item)->begin(),
+                                                              te_get_layout(item)->end() );
+    if( original_text.size() > 0 ) {
+        g_repr->setAttribute("aria-label", original_text.c_str() );
+    }
+
+    g_repr->setAttribute("transform", item->getRepr()->attribute("transform"));
+
+    Inkscape::copy_object_properties(g_repr, item->getRepr());
 
-            if (iter == te_get_layout(item)->end())
-                break;
+    /* Whole text's style */
+    Glib::ustring style_str =
+        item->style->write( SP_STYLE_FLAG_IFDIFF, SP_STYLE_SRC_UNSET, item->parent ? item->parent->style : nullptr); // TODO investigate possibility
+    g_repr->setAttribute("style", style_str.c_str());
+
+    for (auto &glyph : outline.glyphs) {
+        Inkscape::XML::Node *p_repr = xml_doc->createElement("svg:path");
+        p_repr->setAttribute("d", glyph.d.c_str());
+        p_repr->setAttribute("style", outline.styles[glyph.style].c_str());
+        g_repr->appendChild(p_repr);
+        Inkscape::GC::release(p_repr);
+    }
 
-        } while (true);
+    return g_repr;
+}
 
-        return g_repr;
+}
+
+std::vector<Inkscape::XML::Node *>
+sp_text_items_to_curved_reprs(std::vector<SPItem *> const &items)
+{
+    // Layout and glyph outlines are not thread-safe, only writing the path data is parallel
+    std::vector<TextOutline> outlines(items.size());
+    for (std::size_t i = 0; i < items.size(); i++) {
+        outlines[i].item = nullptr;
+        if (dynamic_cast<SPText *>(items[i]) || dynamic_cast<SPFlowtext *>(items[i])) {
+            collect_glyphs(items[i], outlines[i]);
+        }
+    }
+
+    write_glyphs(outlines);
+
+    std::vector<Inkscape::XML::Node *> reprs;
+    reprs.reserve(items.size());
+    for (auto &outline : outlines) {
+        reprs.push_back(outline.item ? build_text_repr(outline) : nullptr);
+    }
+    return reprs;
+}
+
+Inkscape::XML::Node *
+sp_selected_item_to_curved_repr(SPItem *item, guint32 /*text_grouping_policy*/)
+{
+    if (!item)
+        return nullptr;
+
+    Inkscape::XML::Document *xml_doc = item->getRepr()->document();
+
+    if (dynamic_cast<SPText *>(item) || dynamic_cast<SPFlowtext *>(item)) {
+        // Special treatment for text: convert each glyph to separate path, then group the paths
+        return sp_text_items_to_curved_reprs(std::vector<SPItem *>(1, item))[0];
     }
     SPCurve *curve = nullptr;
     {
@@ -14,6 +14,8 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <vector>
+
 class SPDesktop;
 class SPItem;
 
@@ -35,6 +37,12 @@ typedef unsigned int guint32;
 //void sp_selected_path_to_curves (Inkscape::Selection *selection, SPDesktop *desktop, bool interactive = true);
 //void sp_selected_to_lpeitems(ObjectSet *selection);
 Inkscape::XML::Node *sp_selected_item_to_curved_repr(SPItem *item, guint32 text_grouping_policy);
+/**
+ * Make the groups of glyph paths of several texts, as sp_selected_item_to_curved_repr() does,
+ * writing the path data of all glyphs on worker threads.
+ * @return a new repr for each text in @a items, nullptr for other items.
+ */
+std::vector<Inkscape::XML::Node *> sp_text_items_to_curved_reprs(std::vector<SPItem *> const &items);
 //void sp_selected_path_reverse (SPDesktop *desktop);
 bool sp_item_list_to_curves(const std::vector<SPItem*> &items, std::vector<SPItem*> &selected, std::vector<Inkscape::XML::Node*> &to_select, bool skip_all_lpeitems = false);
 
@@ -475,8 +475,11 @@ void Preferences::mergeStyle(Glib::ustring const &pref_path, SPCSSAttr *style)
  */
 void Preferences::remove(Glib::ustring const &pref_path)
 {
-    auto it = cachedRawValue.find(pref_path.c_str());
-    if (it != cachedRawValue.end()) cachedRawValue.erase(it);
+    {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
+        auto it = cachedRawValue.find(pref_path.c_str());
+        if (it != cachedRawValue.end()) cachedRawValue.erase(it);
+    }
 
     Inkscape::XML::Node *node = _getNode(pref_path, false);
     if (node && node->parent()) {
@@ -713,6 +716,8 @@ Inkscape::XML::Node *Preferences::_getNode(Glib::ustring const &pref_key, bool c
 
 void Preferences::_getRawValue(Glib::ustring const &path, gchar const *&result)
 {
+    std::lock_guard<std::mutex> lock(_cache_mutex);
+
     // will return empty string if `path` was not in the cache yet
     auto& cacheref = cachedRawValue[path.c_str()];
 
@@ -762,6 +767,7 @@ void Preferences::_setRawValue(Glib::ustring const &path, Glib::ustring const &v
     node->setAttribute(attr_key.c_str(), value.c_str());
 
     if (_initialized) {
+        std::lock_guard<std::mutex> lock(_cache_mutex);
         cachedRawValue[path.c_str()] = RAWCACHE_CODE_VALUE + value;
     }
 }
@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/*
+ * Spatial index of the items to snap to.
+ *
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "document.h"
+#include "snap-index.h"
+
+#include "object/sp-item-group.h"
+#include "object/sp-mask.h"
+#include "object/sp-clippath.h"
+#include "object/sp-root.h"
+
+namespace {
+
+/// Number of cells along the longer side of the area covered by the items.
+double const GRID_RESOLUTION = 128;
+/// Items covering more cells than this are kept in a separate list.
+int const MAX_ITEM_CELLS = 64;
+/// Cell coordinates are clamped to this range.
+double const MAX_CELL_COORD = 1 << 30;
+
+}
+
+Inkscape::SnapIndex::SnapIndex()
+    : _document(nullptr)
+    , _root(nullptr)
+    , _bbox_type(SPItem::GEOMETRIC_BBOX)
+    , _rescan_root(false)
+    , _cell_size(0)
+    , _stamp(0)
+{
+}
+
+Inkscape::SnapIndex::~SnapIndex()
+{
+    clear();
+}
+
+void Inkscape::SnapIndex::clear()
+{
+    for (auto &i : _entries) {
+        i.second.modified_connection.disconnect();
+        i.second.release_connection.disconnect();
+    }
+    _root_modified_connection.disconnect();
+    _root_release_connection.disconnect();
+    _entries.clear();
+    _dirty.clear();
+    _rescan.clear();
+    _clipped.clear();
+    _cells.clear();
+    _large.clear();
+    _cell_size = 0;
+    _document = nullptr;
+    _root = nullptr;
+    _rescan_root = false;
+}
+
+void Inkscape::SnapIndex::query(SPDocument *document,
+                                SPItem::BBoxType bbox_type,
+                                Geom::Rect const &area,
+                                bool include_centers,
+                                std::vector<SPItem *> &items)
+{
+    if (document != _document || document->getRoot() != _root || bbox_type != _bbox_type ||
+        document->doc2dt() != _doc2dt) {
+        _rebuild(document, bbox_type);
+    }
+    _update();
+
+    // Items are stamped so that those found in several cells are only returned once
+    if (++_stamp == 0) {
+        for (auto &i : _entries) {
+            i.second.stamp = 0;
+        }
+        _stamp = 1;
+    }
+
+    auto consider = [&](Entry *e) {
+        if (e->stamp == _stamp) {
+            return;
+        }
+        e->stamp = _stamp;
+        if (area.intersects(*e->bbox) || (include_centers && area.contains(e->center))) {
+            items.push_back(e->item);
+        }
+    };
+
+    Geom::IntRect range = _cellRange(area);
+    if (Geom::Coord(range.width() + 1) * (range.height() + 1) > _cells.size()) {
+        // a large area, e.g. when always snapping: visiting the occupied cells is cheaper
+        for (auto &cell : _cells) {
+            for (auto e : cell.second) {
+                consider(e);
+            }
+        }
+    } else {
+        for (int x = range.left(); x <= range.right(); ++x) {
+            for (int y = range.top(); y <= range.bottom(); ++y) {
+                auto cell = _cells.find(_cellKey(x, y));
+                if (cell == _cells.end()) {
+                    continue;
+                }
+                for (auto e : cell->second) {
+                    consider(e);
+                }
+            }
+        }
+    }
+    for (auto e : _large) {
+        consider(e);
+    }
+}
+
+void Inkscape::SnapIndex::_rebuild(SPDocument *document, SPItem::BBoxType bbox_type)
+{
+    clear();
+    _document = document;
+    _root = document->getRoot();
+    _bbox_type = bbox_type;
+    _doc2dt = document->doc2dt();
+    if (_root) {
+        _root_modified_connection = _root->connectModified(sigc::mem_fun(*this, &SnapIndex::_rootModified));
+        _root_release_connection = _root->connectRelease(sigc::mem_fun(*this, &SnapIndex::_rootReleased));
+        _addChildren(_root);
+    }
+}
+
+void Inkscape::SnapIndex::_update()
+{
+    if (_rescan_root) {
+        _rescan_root = false;
+        _addChildren(_root);
+    }
+    // Adding children may mark more groups for rescanning
+    while (!_rescan.empty()) {
+        SPObject *object = _rescan.back();
+        _rescan.pop_back();
+        auto i = _entries.find(object);
+        if (i != _entries.end() && i->second.rescan) {
+            i->second.rescan = false;
+            _addChildren(object);
+        }
+    }
+
+    bool const laid_out = _cell_size > 0;
+    for (auto object : _dirty) {
+        auto i = _entries.find(object);
+        if (i == _entries.end() || !i->second.dirty) {
+            continue;
+        }
+        Entry &e = i->second;
+        e.dirty = false;
+        if (laid_out) {
+            _remove(e);
+        }
+        _measure(e);
+        if (laid_out) {
+            _insert(e);
+        }
+    }
+    _dirty.clear();
+
+    if (!laid_out) {
+        // Size the cells after the area covered by the items
+        Geom::OptRect covered;
+        for (auto &i : _entries) {
+            covered.unionWith(i.second.bbox);
+        }
+        _cell_size = covered ? std::max(covered->maxExtent() / GRID_RESOLUTION, 1e-3) : 1.0;
+        for (auto &i : _entries) {
+            _insert(i.second);
+        }
+    }
+}
+
+void Inkscape::SnapIndex::_addChildren(SPObject *parent)
+{
+    for (auto &child : parent->children) {
+        SPItem *item = dynamic_cast<SPItem *>(&child);
+        if (item && _entries.find(item) == _entries.end()) {
+            _addItem(item);
+        }
+    }
+}
+
+void Inkscape::SnapIndex::_addItem(SPItem *item)
+{
+    Entry &e = _entries[item];
+    e.item = item;
+    e.group = dynamic_cast<SPGroup *>(item) != nullptr;
+    e.in_grid = false;
+    e.large = false;
+    e.dirty = true;
+    e.rescan = false;
+    e.stamp = 0;
+    e.modified_connection = item->connectModified(sigc::mem_fun(*this, &SnapIndex::_itemModified));
+    e.release_connection = item->connectRelease(sigc::mem_fun(*this, &SnapIndex::_itemReleased));
+    _dirty.push_back(item);
+
+    if (e.group) {
+        _addChildren(item);
+    }
+}
+
+void Inkscape::SnapIndex::_measure(Entry &e)
+{
+    SPItem *item = e.item;
+    bool clipped = (item->clip_ref && item->clip_ref->getObject()) ||
+                   (item->mask_ref && item->mask_ref->getObject());
+    if (clipped) {
+        _clipped.insert(item);
+    } else {
+        _clipped.erase(item);
+    }
+
+    if (e.group) {
+        // groups are searched through their children
+        e.bbox = Geom::OptRect();
+        return;
+    }
+    e.bbox = item->desktopBounds(_bbox_type);
+    e.center = item->getCenter();
+}
+
+void Inkscape::SnapIndex::_insert(Entry &e)
+{
+    // Items without a bounding box cannot be snapped to
+    if (!e.bbox) {
+        return;
+    }
+
+    // The rotation center may lie outside of the bounding box
+    Geom::Rect covered = *e.bbox;
+    covered.expandTo(e.center);
+    e.cells = _cellRange(covered);
+    e.in_grid = true;
+    e.large = Geom::Coord(e.cells.width() + 1) * (e.cells.height() + 1) > MAX_ITEM_CELLS;
+    if (e.large) {
+        _large.push_back(&e);
+        return;
+    }
+    for (int x = e.cells.left(); x <= e.cells.right(); ++x) {
+        for (int y = e.cells.top(); y <= e.cells.bottom(); ++y) {
+            _cells[_cellKey(x, y)].push_back(&e);
+        }
+    }
+}
+
+void Inkscape::SnapIndex::_remove(Entry &e)
+{
+    if (!e.in_grid) {
+        return;
+    }
+    e.in_grid = false;
+    if (e.large) {
+        _large.erase(std::find(_large.begin(), _large.end(), &e));
+        return;
+    }
+    for (int x = e.cells.left(); x <= e.cells.right(); ++x) {
+        for (int y = e.cells.top(); y <= e.cells.bottom(); ++y) {
+            auto cell = _cells.find(_cellKey(x, y));
+            auto &list = cell->second;
+            list.erase(std::find(list.begin(), list.end(), &e));
+            if (list.empty()) {
+                _cells.erase(cell);
+            }
+        }
+    }
+}
+
+Geom::IntRect Inkscape::SnapIndex::_cellRange(Geom::Rect const &r) const
+{
+    auto cell = [this](Geom::Coord c) {
+        return int(std::max(-MAX_CELL_COORD, std::min(std::floor(c / _cell_size), MAX_CELL_COORD)));
+    };
+    // the cells are inclusive at both ends
+    return Geom::IntRect(cell(r.left()), cell(r.top()), cell(r.right()), cell(r.bottom()));
+}
+
+std::uint64_t Inkscape::SnapIndex::_cellKey(int x, int y)
+{
+    return (std::uint64_t(std::uint32_t(x)) << 32) | std::uint32_t(y);
+}
+
+void Inkscape::SnapIndex::_itemModified(SPObject *object, unsigned flags)
+{
+    auto i = _entries.find(object);
+    if (i == _entries.end()) {
+        return;
+    }
+    Entry &e = i->second;
+    if (!e.dirty) {
+        e.dirty = true;
+        _dirty.push_back(object);
+    }
+    // Groups are marked as modified when children are added to them
+    if (e.group && (flags & SP_OBJECT_MODIFIED_FLAG) && !e.rescan) {
+        e.rescan = true;
+        _rescan.push_back(object);
+    }
+}
+
+void Inkscape::SnapIndex::_itemReleased(SPObject *object)
+{
+    auto i = _entries.find(object);
+    if (i == _entries.end()) {
+        return;
+    }
+    Entry &e = i->second;
+    _remove(e);
+    e.modified_connection.disconnect();
+    e.release_connection.disconnect();
+    _clipped.erase(e.item);
+    _entries.erase(i);
+}
+
+void Inkscape::SnapIndex::_rootModified(SPObject * /*object*/, unsigned flags)
+{
+    if (flags & SP_OBJECT_MODIFIED_FLAG) {
+        _rescan_root = true;
+    }
+}
+
+void Inkscape::SnapIndex::_rootReleased(SPObject * /*object*/)
+{
+    // the whole document is going away
+    clear();
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
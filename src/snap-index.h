@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+#ifndef SEEN_SNAP_INDEX_H
+#define SEEN_SNAP_INDEX_H
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include <2geom/affine.h>
+#include <2geom/rect.h>
+#include <sigc++/connection.h>
+
+#include "object/sp-item.h"
+
+class SPDocument;
+class SPObject;
+
+namespace Inkscape
+{
+
+/**
+ * Spatial index of the items of a document, used by the object snapper to find the items
+ * within snapping range without walking the whole document for every snap.
+ *
+ * The desktop bounding boxes of the items which are not groups are kept in a uniform grid.
+ * The index follows the document through the modified and release signals of its items:
+ * items which were modified are only measured again when the index is next queried, and
+ * groups which were modified are searched for new children.
+ */
+class SnapIndex
+{
+public:
+    SnapIndex();
+    ~SnapIndex();
+
+    /**
+     * Find the items whose bounding box intersects the given area, or whose rotation
+     * center lies within it when include_centers is true. Groups are never returned.
+     * @param area Area in desktop coordinates.
+     */
+    void query(SPDocument *document,
+               SPItem::BBoxType bbox_type,
+               Geom::Rect const &area,
+               bool include_centers,
+               std::vector<SPItem *> &items);
+
+    /**
+     * Items (including groups) which are clipped or masked, as of the last query.
+     */
+    std::set<SPItem *> const &clippedItems() const { return _clipped; }
+
+    void clear();
+
+private:
+    struct Entry {
+        SPItem *item;
+        Geom::OptRect bbox;
+        Geom::Point center;
+        Geom::IntRect cells;
+        bool group;
+        bool in_grid;
+        bool large;
+        bool dirty;
+        bool rescan;
+        unsigned stamp;
+        sigc::connection modified_connection;
+        sigc::connection release_connection;
+    };
+
+    void _rebuild(SPDocument *document, SPItem::BBoxType bbox_type);
+    void _update();
+    void _addChildren(SPObject *parent);
+    void _addItem(SPItem *item);
+    void _measure(Entry &entry);
+    void _insert(Entry &entry);
+    void _remove(Entry &entry);
+    Geom::IntRect _cellRange(Geom::Rect const &r) const;
+    static std::uint64_t _cellKey(int x, int y);
+
+    void _itemModified(SPObject *object, unsigned flags);
+    void _itemReleased(SPObject *object);
+    void _rootModified(SPObject *object, unsigned flags);
+    void _rootReleased(SPObject *object);
+
+    SPDocument *_document;
+    SPObject *_root;
+    SPItem::BBoxType _bbox_type;
+    Geom::Affine _doc2dt;
+    sigc::connection _root_modified_connection;
+    sigc::connection _root_release_connection;
+    bool _rescan_root;
+
+    std::unordered_map<SPObject const *, Entry> _entries;
+    std::vector<SPObject *> _dirty;
+    std::vector<SPObject *> _rescan;
+    std::set<SPItem *> _clipped;
+
+    double _cell_size; ///< 0 until the grid has been laid out
+    std::unordered_map<std::uint64_t, std::vector<Entry *> > _cells;
+    std::vector<Entry *> _large; ///< items covering too many cells
+    unsigned _stamp;
+};
+
+} // end of namespace Inkscape
+
+#endif
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
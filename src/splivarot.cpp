@@ -16,9 +16,16 @@
  */
 
 #ifdef HAVE_CONFIG_H
+# include "config.h"  // only include where actually required!
 #endif
 
+#if HAVE_OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
 #include <cstring>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -35,6 +42,7 @@
 #include "layer-model.h"
 #include "message-stack.h"
 #include "path-chemistry.h"
+#include "preferences.h"
 #include "selection.h"
 #include "text-editing.h"
 #include "verbs.h"
@@ -42,9 +50,11 @@
 #include "display/sp-canvas.h"
 
 #include "helper/geom.h"
+#include "helper/geom-pathstroke.h"
 
 #include "livarot/Path.h"
 #include "livarot/Shape.h"
+#include "livarot/shape-arena.h"
 
 #include "object/sp-flowtext.h"
 #include "object/sp-image.h"
@@ -318,7 +328,164 @@ Geom::PathVector pathliv_to_pathvector(Path *pathliv){
 }
 
 
+/**
+ * Free the blocks kept by the calling thread if it is an OpenMP worker; called at the end of
+ * parallel regions. The free lists of the workers would otherwise stay around, up to the full
+ * budget of the arena each, while the thread which started the operation trims its own list
+ * when the whole operation is done.
+ */
+static void
+trim_worker_arena()
+{
+#if HAVE_OPENMP
+    if (omp_in_parallel() && omp_get_thread_num() != 0) {
+        ShapeArena::trim();
+    }
+#endif
+}
+
 // boolean operations on the desktop
+/**
+ * Union of the polygons of several paths; the back data refers to each path by its index.
+ *
+ * Operands whose bounding boxes overlap, directly or through other operands, form a group.
+ * The operands of a group are merged pairwise in a balanced tree, one level at a time, and
+ * the pairs of each level are merged on several threads. Groups never meet in a sweep:
+ * they cannot intersect, so their results are simply put together in the end.
+ *
+ * @return A new polygon, to be deleted by the caller.
+ */
+static Shape *
+sp_union_paths(std::vector<Path *> const &paths, std::vector<FillRule> const &winds)
+{
+    int const count = paths.size();
+    int threads = 1;
+#if HAVE_OPENMP
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    threads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
+#endif
+
+    std::vector<Shape *> shapes(count, nullptr);
+#if HAVE_OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+    {
+#if HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int i = 0; i < count; i++) {
+            Shape filled;
+            paths[i]->ConvertWithBackData(0.1);
+            paths[i]->Fill(&filled, i);
+            shapes[i] = new Shape;
+            shapes[i]->ConvertToShape(&filled, winds[i]);
+            shapes[i]->CalcBBox();
+        }
+        trim_worker_arena();
+    }
+
+    // Quantization of the input may leave some operands empty; they do not add anything.
+    std::vector<int> order;
+    for (int i = 0; i < count; i++) {
+        if (shapes[i]->numberOfEdges() > 0) {
+            order.push_back(i);
+        }
+    }
+    if (order.empty()) {
+        for (int i = 1; i < count; i++) {
+            delete shapes[i];
+        }
+        return shapes[0];
+    }
+
+    // Find the groups of overlapping operands, sweeping over their bounding boxes from left to right.
+    std::vector<int> group(count);
+    for (int i = 0; i < count; i++) {
+        group[i] = i;
+    }
+    auto find_group = [&group](int i) -> int {
+        while (group[i] != i) {
+            i = group[i] = group[group[i]];
+        }
+        return i;
+    };
+    std::sort(order.begin(), order.end(), [&shapes](int a, int b) {
+        return shapes[a]->leftX < shapes[b]->leftX;
+    });
+    for (unsigned a = 0; a < order.size(); a++) {
+        Shape const *sa = shapes[order[a]];
+        for (unsigned b = a + 1; b < order.size() && shapes[order[b]]->leftX <= sa->rightX; b++) {
+            Shape const *sb = shapes[order[b]];
+            if (sb->topY <= sa->bottomY && sa->topY <= sb->bottomY) {
+                group[find_group(order[b])] = find_group(order[a]);
+            }
+        }
+    }
+
+    // Keep the operands of each group in their original order.
+    std::sort(order.begin(), order.end());
+    std::vector<std::vector<Shape *> > groups;
+    std::vector<int> group_index(count, -1);
+    for (int i : order) {
+        int g = find_group(i);
+        if (group_index[g] < 0) {
+            group_index[g] = groups.size();
+            groups.emplace_back();
+        }
+        groups[group_index[g]].push_back(shapes[i]);
+    }
+    for (int i = 0; i < count; i++) {
+        if (shapes[i]->numberOfEdges() == 0) {
+            delete shapes[i];
+        }
+    }
+
+    while (true) {
+        std::vector<std::pair<int, int> > pairs;
+        for (unsigned g = 0; g < groups.size(); g++) {
+            for (unsigned k = 0; k + 1 < groups[g].size(); k += 2) {
+                pairs.emplace_back(g, k);
+            }
+        }
+        if (pairs.empty()) {
+            break;
+        }
+
+#if HAVE_OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+        {
+#if HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+            for (int p = 0; p < (int) pairs.size(); p++) {
+                std::vector<Shape *> &operands = groups[pairs[p].first];
+                Shape *&a = operands[pairs[p].second];
+                Shape *&b = operands[pairs[p].second + 1];
+                Shape *result = new Shape;
+                // les elements arrivent en ordre inverse dans la liste
+                result->Booleen(b, a, bool_op_union);
+                delete a;
+                delete b;
+                a = result;
+                b = nullptr;
+            }
+            trim_worker_arena();
+        }
+
+        for (auto &operands : groups) {
+            operands.erase(std::remove(operands.begin(), operands.end(), nullptr), operands.end());
+        }
+    }
+
+    Shape *result = groups[0][0];
+    for (unsigned g = 1; g < groups.size(); g++) {
+        result->Concat(groups[g][0]);
+        delete groups[g][0];
+    }
+    return result;
+}
+
 // take the source paths from the file, do the operation, delete the originals and add the results
 BoolOpErrors Inkscape::ObjectSet::pathBoolOp(bool_op bop, const bool skip_undo, const bool checked, const unsigned int verb, const Glib::ustring description)
 {
@@ -328,6 +495,8 @@ BoolOpErrors Inkscape::ObjectSet::pathBoolOp(bool_op bop, const bool skip_undo,
         desktop()->getCanvas()->_drawing_disabled = true;
         BoolOpErrors returnCode = ObjectSet::pathBoolOp(bop, true, true);
         desktop()->getCanvas()->_drawing_disabled = false;
+        // the arrays of large operations are not needed until the next one
+        ShapeArena::trim();
 
         switch(returnCode) {
         case ERR_TOO_LESS_PATHS_1:
@@ -481,7 +650,11 @@ BoolOpErrors Inkscape::ObjectSet::pathBoolOp(bool_op bop, const bool skip_undo,
     Path::cut_position  *toCut=nullptr;
     int                  nbToCut=0;
 
-    if ( bop == bool_op_inters || bop == bool_op_union || bop == bool_op_diff || bop == bool_op_symdiff ) {
+    if ( bop == bool_op_union ) {
+        delete theShape;
+        theShape = sp_union_paths(originaux, origWind);
+
+    } else if ( bop == bool_op_inters || bop == bool_op_diff || bop == bool_op_symdiff ) {
         // true boolean op
         // get the polygons of each path, with the winding rule specified, and apply the operation iteratively
         originaux[0]->ConvertWithBackData(0.1);
@@ -913,6 +1086,129 @@ void item_outline_add_marker( SPObject const *marker_object, Geom::Affine marker
     }
 }
 
+/**
+ * Outline of the stroke of a path, painted with the given style.
+ * The joins and caps are made by Inkscape::outline(), which keeps the curves of the path;
+ * dashes are cut by livarot first.
+ * @param pathv The path, in the coordinates of the style.
+ * @param scale Scale of the item, the dashes are scaled by it.
+ * @param min_width Thinner strokes are outlined at this width.
+ * @param clean If false, return the stroked subpaths as they are. They may overlap each other
+ *        and themselves, which is only good enough for a bounding box.
+ */
+static Geom::PathVector
+sp_stroke_outline(SPStyle *style, Geom::PathVector const &pathv, float scale, double min_width, bool clean)
+{
+    Geom::PathVector result;
+    if (pathv.empty()) {
+        return result;
+    }
+
+    double const width = std::max<double>(style->stroke_width.computed, min_width);
+    double const miter = style->stroke_miterlimit.value;
+
+    Inkscape::LineJoinType join;
+    switch (style->stroke_linejoin.computed) {
+        case SP_STROKE_LINEJOIN_MITER:
+            join = Inkscape::JOIN_MITER;
+            break;
+        case SP_STROKE_LINEJOIN_ROUND:
+            join = Inkscape::JOIN_ROUND;
+            break;
+        default:
+            join = Inkscape::JOIN_BEVEL;
+            break;
+    }
+    Inkscape::LineCapType cap;
+    switch (style->stroke_linecap.computed) {
+        case SP_STROKE_LINECAP_SQUARE:
+            cap = Inkscape::BUTT_SQUARE;
+            break;
+        case SP_STROKE_LINECAP_ROUND:
+            cap = Inkscape::BUTT_ROUND;
+            break;
+        default:
+            cap = Inkscape::BUTT_FLAT;
+            break;
+    }
+
+    // arcs are not offset exactly
+    Geom::PathVector centerline = pathv_to_linear_and_cubic_beziers(pathv);
+    if (!style->stroke_dasharray.values.empty()) {
+        double size = Geom::L2(Geom::bounds_fast(centerline)->dimensions());
+        Path dashed;
+        dashed.LoadPathVector(centerline);
+        dashed.ConvertWithBackData(0.005);
+        dashed.DashPolylineFromStyle(style, scale, 0);
+        dashed.Simplify(size * 0.00005);
+        Geom::PathVector *dashes = dashed.MakePathVector();
+        centerline = *dashes;
+        delete dashes;
+    }
+
+    return sp_pathvector_stroke_outline(centerline, width, miter, join, cap, clean);
+}
+
+/**
+ * Twice the area enclosed by a closed path, from the polygon through points along its curves;
+ * positive if the path turns clockwise on the canvas.
+ */
+static double
+closed_path_area(Geom::Path const &path)
+{
+    unsigned const samples = 8;
+    double area = 0;
+    Geom::Point prev = path.initialPoint();
+    for (auto const &curve : path) {
+        for (unsigned i = 1; i <= samples; i++) {
+            Geom::Point const next = curve.pointAt(double(i) / samples);
+            area += Geom::cross(prev, next);
+            prev = next;
+        }
+    }
+    return area;
+}
+
+Geom::PathVector
+sp_pathvector_stroke_outline(Geom::PathVector const &centerline, double width, double miter,
+                             Inkscape::LineJoinType join, Inkscape::LineCapType cap, bool clean)
+{
+    Geom::PathVector result;
+    for (auto const &path : centerline) {
+        // Closed subpaths are all turned the same way, so that the strokes of subpaths that run
+        // in opposite directions, like the contours of an "O", add up rather than cancel out
+        // where they overlap.
+        bool const reverse = path.closed() && closed_path_area(path) < 0;
+        Geom::PathVector stroked = Inkscape::outline(reverse ? path.reversed() : path, width, miter, join, cap);
+        result.insert(result.end(), stroked.begin(), stroked.end());
+    }
+    if (!clean || result.empty()) {
+        return result;
+    }
+
+    // Merge the overlapping parts
+    Path res;
+    res.LoadPathVector(result);
+    res.ConvertWithBackData(1.0);
+
+    Shape filled;
+    Shape merged;
+    res.Fill(&filled, 0);
+    merged.ConvertToShape(&filled, fill_nonZero);
+
+    Path merged_path;
+    Path *originaux[1] = { &res };
+    merged.ConvertToForme(&merged_path, 1, originaux);
+
+    result.clear();
+    if (merged_path.descr_cmd.size() > 1) {
+        Geom::PathVector *pv = merged_path.MakePathVector();
+        result = *pv;
+        delete pv;
+    }
+    return result;
+}
+
 /**
  *  Returns a pathvector that is the outline of the stroked item, with markers.
  *  item must be SPShape or SPText.
@@ -950,88 +1246,12 @@ Geom::PathVector* item_outline(SPItem const *item, bool bbox_only)
     Geom::Affine const transform(item->transform);
     float const scale = transform.descrim();
 
-    float o_width = i_style->stroke_width.computed;
-    if (o_width < Geom::EPSILON) {
-        // This may result in rounding errors for very small stroke widths (happens e.g. when user unit is large).
-        // See bug lp:1244861
-        o_width = Geom::EPSILON;
-    }
-    float o_miter = i_style->stroke_miterlimit.value * o_width;
+    // This may result in rounding errors for very small stroke widths (happens e.g. when user unit is large).
+    // See bug lp:1244861
+    Geom::PathVector outline = sp_stroke_outline(i_style, curve->get_pathvector(), scale, Geom::EPSILON, !bbox_only);
 
-    JoinType o_join;
-    ButtType o_butt;
-    {
-        switch (i_style->stroke_linejoin.computed) {
-            case SP_STROKE_LINEJOIN_MITER:
-                o_join = join_pointy;
-                break;
-            case SP_STROKE_LINEJOIN_ROUND:
-                o_join = join_round;
-                break;
-            default:
-                o_join = join_straight;
-                break;
-        }
-
-        switch (i_style->stroke_linecap.computed) {
-            case SP_STROKE_LINECAP_SQUARE:
-                o_butt = butt_square;
-                break;
-            case SP_STROKE_LINECAP_ROUND:
-                o_butt = butt_round;
-                break;
-            default:
-                o_butt = butt_straight;
-                break;
-        }
-    }
-
-    // Livarot's outline of arcs is broken. So convert the path to linear and cubics only, for which the outline is created correctly.
-    Geom::PathVector pathv = pathv_to_linear_and_cubic_beziers( curve->get_pathvector() );
-
-    Path *orig = new Path;
-    orig->LoadPathVector(pathv);
-
-    Path *res = new Path;
-    res->SetBackData(false);
-
-    if (!i_style->stroke_dasharray.values.empty()) {
-        double size = Geom::L2(Geom::bounds_fast(pathv)->dimensions());
-        orig->ConvertWithBackData(0.005);
-
-        orig->DashPolylineFromStyle(i_style, scale, 0);
-        orig->Simplify(size * 0.00005);
-    }
-    orig->Outline(res, 0.5 * o_width, o_join, o_butt, 0.5 * o_miter);
-
-    if (!bbox_only) {
-        orig->Coalesce(0.5 * o_width);
-        Shape *theShape = new Shape;
-        Shape *theRes = new Shape;
-
-        res->ConvertWithBackData(1.0);
-        res->Fill(theShape, 0);
-        theRes->ConvertToShape(theShape, fill_positive);
-
-        Path *originaux[1];
-        originaux[0] = res;
-        theRes->ConvertToForme(orig, 1, originaux);
-
-        delete theShape;
-        delete theRes;
-    }
-
-    if (orig->descr_cmd.size() <= 1) {
-        // ca a merd, ou bien le resultat est vide
-        delete res;
-        delete orig;
-        curve->unref();
-        return ret_pathv;
-    }
-
-
-    if (res->descr_cmd.size() > 1) { // if there's 0 or 1 node left, drop this path altogether
-        ret_pathv = bbox_only ? res->MakePathVector() : orig->MakePathVector();
+    if (!outline.empty()) {
+        ret_pathv = new Geom::PathVector(outline);
 
         if (SP_IS_SHAPE(item) && SP_SHAPE(item)->hasMarkers() && !bbox_only) {
             SPShape *shape = SP_SHAPE(item);
@@ -1109,18 +1329,18 @@ Geom::PathVector* item_outline(SPItem const *item, bool bbox_only)
                 }
             }
         }
-
-        curve->unref();
     }
 
-    delete res;
-    delete orig;
-
+    curve->unref();
     return ret_pathv;
 }
 
+/**
+ * Convert the stroke of an item (or of the items in a group) to a path.
+ * @param outlines Outlines of the strokes computed beforehand by sp_stroke_outlines(), if any.
+ */
 bool
-sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy)
+sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy, std::map<SPItem *, Geom::PathVector> const *outlines)
 {
     bool did = false;
     Inkscape::Selection *selection = desktop->getSelection();
@@ -1138,7 +1358,7 @@ sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy)
         }
         std::vector<SPItem*> const item_list = sp_item_group_item_list(group);
         for (auto subitem : item_list) {
-            sp_item_path_outline(subitem, desktop, legacy);
+            sp_item_path_outline(subitem, desktop, legacy, outlines);
         }
     } else {
         if (!SP_IS_SHAPE(item) && !SP_IS_TEXT(item))
@@ -1216,90 +1436,24 @@ sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy)
         Geom::Affine const transform(item->transform);
         float const scale = transform.descrim();
 
-        Path *orig = new Path;
-        Path *res = new Path;
         SPCurve *curvetemp = curve_for_item(item);
         if (curvetemp == nullptr) {
             curve->unref();
             return did;
         }
-        // Livarot's outline of arcs is broken. So convert the path to linear and cubics only, for which the outline is created correctly.
+        // The fill is written with the same segments as the stroke is outlined from
         Geom::PathVector pathv = pathv_to_linear_and_cubic_beziers( curvetemp->get_pathvector() );
         curvetemp->unref();
-        if ( !item->style->stroke.noneSet ) {
-            float o_width, o_miter;
-            JoinType o_join;
-            ButtType o_butt;
-
-            {
-                int jointype, captype;
-
-                jointype = i_style->stroke_linejoin.computed;
-                captype = i_style->stroke_linecap.computed;
-                o_width = i_style->stroke_width.computed;
-
-                switch (jointype) {
-                    case SP_STROKE_LINEJOIN_MITER:
-                        o_join = join_pointy;
-                        break;
-                    case SP_STROKE_LINEJOIN_ROUND:
-                        o_join = join_round;
-                        break;
-                    default:
-                        o_join = join_straight;
-                        break;
-                }
-
-                switch (captype) {
-                    case SP_STROKE_LINECAP_SQUARE:
-                        o_butt = butt_square;
-                        break;
-                    case SP_STROKE_LINECAP_ROUND:
-                        o_butt = butt_round;
-                        break;
-                    default:
-                        o_butt = butt_straight;
-                        break;
-                }
-
-                if (o_width < 0.032)
-                    o_width = 0.032;
-                o_miter = i_style->stroke_miterlimit.value * o_width;
-            }
-
-
-
-            orig->LoadPathVector(pathv);
-            res->SetBackData(false);
 
-            if (!i_style->stroke_dasharray.values.empty()) {
-                double size = Geom::L2(Geom::bounds_fast(pathv)->dimensions());
-                orig->ConvertWithBackData(0.005);
-
-                orig->DashPolylineFromStyle(i_style, scale, 0);
-                orig->Simplify(size * 0.00005);
+        Geom::PathVector stroke_pathv;
+        if ( !item->style->stroke.noneSet ) {
+            if (outlines && outlines->count(item)) {
+                stroke_pathv = outlines->at(item);
+            } else {
+                stroke_pathv = sp_stroke_outline(i_style, pathv, scale, 0.032, true);
             }
-            orig->Outline(res, 0.5 * o_width, o_join, o_butt, 0.5 * o_miter);
-            orig->Coalesce(0.5 * o_width);
-
-            Shape *theShape = new Shape;
-            Shape *theRes = new Shape;
-
-            res->ConvertWithBackData(1.0);
-            res->Fill(theShape, 0);
-            theRes->ConvertToShape(theShape, fill_positive);
-
-            Path *originaux[1];
-            originaux[0] = res;
-            theRes->ConvertToForme(orig, 1, originaux);
-
-            delete theShape;
-            delete theRes;
-
-            if (orig->descr_cmd.size() <= 1) {
-                // ca a merd, ou bien le resultat est vide
-                delete res;
-                delete orig;
+            if (stroke_pathv.empty()) {
+                // the result is empty
                 return did;
             }
         }
@@ -1308,7 +1462,7 @@ sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy)
         // remember parent
         Inkscape::XML::Node *parent = item->getRepr()->parent();
         
-        if (res->descr_cmd.size() > 1) { // if there's 0 or 1 node left, drop this path altogether
+        if (!stroke_pathv.empty()) {
 
             //The stroke
             Inkscape::XML::Node *stroke = nullptr;
@@ -1322,7 +1476,7 @@ sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy)
 
                 sp_repr_css_attr_unref(ncss);
 
-                gchar *str = orig->svg_dump_path();
+                gchar *str = sp_svg_write_path(stroke_pathv);
                 stroke->setAttribute("d", str);
                 g_free(str);
             }
@@ -1568,13 +1722,84 @@ sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy)
                 }
             }
         }
-
-        delete res;
-        delete orig;
     }
     return did;
 }
 
+static void
+sp_collect_stroked_items(SPItem *item, bool legacy, std::vector<SPItem *> &items)
+{
+    // path effects are removed before outlining, which changes the path
+    SPLPEItem *lpeitem = dynamic_cast<SPLPEItem *>(item);
+    if (lpeitem && lpeitem->hasPathEffectRecursive()) {
+        return;
+    }
+    if (SPGroup *group = dynamic_cast<SPGroup *>(item)) {
+        if (!legacy) {
+            for (auto subitem : sp_item_group_item_list(group)) {
+                sp_collect_stroked_items(subitem, legacy, items);
+            }
+        }
+    } else if ((SP_IS_SHAPE(item) || SP_IS_TEXT(item)) && item->style && !item->style->stroke.noneSet) {
+        items.push_back(item);
+    }
+}
+
+/**
+ * Compute the outlines of the strokes of the given items, and of the items in the given groups,
+ * on several threads.
+ */
+static std::map<SPItem *, Geom::PathVector>
+sp_stroke_outlines(std::vector<SPItem *> const &selected, bool legacy)
+{
+    std::vector<SPItem *> items;
+    for (auto item : selected) {
+        sp_collect_stroked_items(item, legacy, items);
+    }
+
+    // The paths are taken from the items here, as the document must not be used by several
+    // threads; outlining them only needs the paths and the styles.
+    std::vector<Geom::PathVector> paths;
+    std::vector<SPItem *> stroked;
+    for (auto item : items) {
+        SPCurve *curve = curve_for_item(item);
+        if (!curve) {
+            continue;
+        }
+        paths.push_back(curve->get_pathvector());
+        stroked.push_back(item);
+        curve->unref();
+    }
+
+    int const count = stroked.size();
+    int threads = 1;
+#if HAVE_OPENMP
+    Inkscape::Preferences *prefs = Inkscape::Preferences::get();
+    threads = prefs->getIntLimited("/options/threading/numthreads", omp_get_num_procs(), 1, 256);
+#endif
+
+    std::vector<Geom::PathVector> results(count);
+#if HAVE_OPENMP
+#pragma omp parallel num_threads(threads) if(count > 1)
+#endif
+    {
+#if HAVE_OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (int i = 0; i < count; i++) {
+            float const scale = stroked[i]->transform.descrim();
+            results[i] = sp_stroke_outline(stroked[i]->style, paths[i], scale, 0.032, true);
+        }
+        trim_worker_arena();
+    }
+
+    std::map<SPItem *, Geom::PathVector> outlines;
+    for (int i = 0; i < count; i++) {
+        outlines[stroked[i]] = std::move(results[i]);
+    }
+    return outlines;
+}
+
 void
 sp_selected_path_outline(SPDesktop *desktop, bool legacy)
 {
@@ -1589,9 +1814,11 @@ sp_selected_path_outline(SPDesktop *desktop, bool legacy)
     prefs->setBool("/options/transform/stroke", true);
     bool did = false;
     std::vector<SPItem*> il(selection->items().begin(), selection->items().end());
+    std::map<SPItem *, Geom::PathVector> const outlines = sp_stroke_outlines(il, legacy);
+    ShapeArena::trim();
     for (std::vector<SPItem*>::const_iterator l = il.begin(); l != il.end(); l++){
         SPItem *item = *l;
-        did = sp_item_path_outline(item, desktop, legacy);
+        did = sp_item_path_outline(item, desktop, legacy, &outlines);
     }
 
     prefs->setBool("/options/transform/stroke", scale_stroke);
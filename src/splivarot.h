@@ -10,8 +10,12 @@
 #ifndef SEEN_SP_LIVAROT_H
 #define SEEN_SP_LIVAROT_H
 
+#include <map>
+
 #include <2geom/forward.h>
 #include <2geom/path.h>
+#include <2geom/pathvector.h>
+#include "helper/geom-pathstroke.h"
 #include "livarot/Path.h"
 #include "object/object-set.h"  // bool_op
 
@@ -42,7 +46,8 @@ void sp_selected_path_create_updating_offset_object_zero (SPDesktop *desktop);
 // outline of a curve
 // uses the stroke-width
 void sp_selected_path_outline (SPDesktop *desktop, bool legacy = false);
-bool sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy);
+bool sp_item_path_outline(SPItem *item, SPDesktop *desktop, bool legacy,
+                          std::map<SPItem *, Geom::PathVector> const *outlines = nullptr);
 Geom::PathVector* item_outline(SPItem const *item, bool bbox_only = false);
 
 // simplifies a path (removes small segments and the like)
@@ -57,6 +62,10 @@ SPCurve *curve_for_item_before_LPE(SPItem *item);
 boost::optional<Path::cut_position> get_nearest_position_on_Path(Path *path, Geom::Point p, unsigned seg = 0);
 Geom::Point get_point_on_Path(Path *path, int piece, double t);
 Geom::PathVector sp_pathvector_boolop(Geom::PathVector const &pathva, Geom::PathVector const &pathvb, bool_op bop, FillRule fra, FillRule frb);
+// outline of the stroke of a path made of lines and cubic Beziers; if clean is false, the
+// stroked subpaths are returned as they are, overlapping each other
+Geom::PathVector sp_pathvector_stroke_outline(Geom::PathVector const &centerline, double width, double miter,
+                                              Inkscape::LineJoinType join, Inkscape::LineCapType cap, bool clean = true);
 
 #endif
 
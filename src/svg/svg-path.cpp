@@ -117,6 +117,12 @@ gchar * sp_svg_write_path(Geom::PathVector const &p) {
     return g_strdup(str.c_str());
 }
 
+void sp_svg_write_path(Inkscape::SVG::PathString &str, Geom::PathVector const &p) {
+    for(const auto & pit : p) {
+        sp_svg_write_path(str, pit);
+    }
+}
+
 gchar * sp_svg_write_path(Geom::Path const &p) {
     Inkscape::SVG::PathString str;
 
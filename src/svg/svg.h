@@ -20,6 +20,12 @@
 #include "svg/svg-length.h"
 #include <2geom/forward.h>
 
+namespace Inkscape {
+namespace SVG {
+class PathString;
+}
+}
+
 /* Generic */
 
 /*
@@ -66,6 +72,9 @@ double sp_svg_read_percentage( const char * str, double def );
 Geom::PathVector sp_svg_read_pathv( char const * str );
 char * sp_svg_write_path( Geom::PathVector const &p );
 char * sp_svg_write_path( Geom::Path const &p );
+/* Appends to a copy of a PathString made beforehand, so does not read the preferences
+ * and can be used from worker threads */
+void sp_svg_write_path( Inkscape::SVG::PathString &str, Geom::PathVector const &p );
 
 #endif // SEEN_SP_SVG_H
 
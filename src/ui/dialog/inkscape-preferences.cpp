@@ -1996,11 +1996,34 @@ void InkscapePreferences::initPageRendering()
     _rendering_cache_size.init("/options/renderingcache/size", 0.0, 4096.0, 1.0, 32.0, 64.0, true, false);
     _page_rendering.add_line( false, _("Rendering _cache size:"), _rendering_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory per document which can be used to store rendered parts of the drawing for later reuse; set to zero to disable caching"), false);
 
+    // zoom level tile cache
+    _rendering_tile_cache_size.init("/options/renderingcache/tiles", 0.0, 16384.0, 1.0, 32.0, 0.0, true, false);
+    _page_rendering.add_line( false, _("Zoom level cache size:"), _rendering_tile_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory per document which can be used to keep rendered tiles of recently displayed zoom levels, so that returning to them does not require rendering the drawing again; set to zero to disable"), false);
+
+    // filter primitive result cache
+    _rendering_filter_cache_size.init("/options/renderingcache/filters", 0.0, 4096.0, 1.0, 32.0, 0.0, true, false);
+    _page_rendering.add_line( false, _("Filter result cache size:"), _rendering_filter_cache_size, C_("mebibyte (2^20 bytes) abbreviation","MiB"), _("Set the amount of memory which can be used to store the results of individual filter primitives, so that unchanged parts of a filter are not rendered again; set to zero to disable"), false);
+
     // rendering tile multiplier
     _rendering_tile_multiplier.init("/options/rendering/tile-multiplier", 1.0, 512.0, 1.0, 16.0, 16.0, true, false);
     _page_rendering.add_line( false, _("Rendering tile multiplier:"), _rendering_tile_multiplier, "",
                               _("On modern hardware, increasing this value (default is 16) can help to get a better performance when there are large areas with filtered objects (this includes blur and blend modes) in your drawing. Decrease the value to make zooming and panning in relevant areas faster on low-end hardware in drawings with few or no filters."), false);
 
+    // multithreaded canvas rendering
+    _rendering_threaded.init(_("Render canvas with multiple threads"), "/options/rendering/threaded", false);
+    _page_rendering.add_line(false, "", _rendering_threaded, "",
+                             _("Split each part of the canvas being redrawn into bands and render them in parallel, using the number of threads set above. The rendering cache is not used in this mode."), false);
+
+    // background canvas rendering
+    _rendering_background.init(_("Render canvas in the background"), "/options/rendering/background", false);
+    _page_rendering.add_line(false, "", _rendering_background, "",
+                             _("Render the drawing on a separate thread while Inkscape keeps responding to input. Renderings that become outdated are abandoned."), false);
+
+    // progressive canvas rendering
+    _rendering_progressive.init(_("Preview while scrolling and zooming"), "/options/rendering/progressive", false);
+    _page_rendering.add_line(false, "", _rendering_progressive, "",
+                             _("While scrolling, zooming or dragging, render filters and blurs at the lowest quality, and render them again in full quality once the interaction ends."), false);
+
     // rendering xray radius
     _rendering_xray_radius.init("/options/rendering/xray-radius", 1.0, 1500.0, 1.0, 100.0, 100.0, true, false);
     _page_rendering.add_line(false, _("Rendering XRay radius:"), _rendering_xray_radius, "",
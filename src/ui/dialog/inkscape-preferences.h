@@ -310,7 +310,12 @@ protected:
     UI::Widget::PrefCombo       _switcher_style;
     UI::Widget::PrefCheckButton _rendering_image_outline;
     UI::Widget::PrefSpinButton  _rendering_cache_size;
+    UI::Widget::PrefSpinButton  _rendering_tile_cache_size;
+    UI::Widget::PrefSpinButton  _rendering_filter_cache_size;
     UI::Widget::PrefSpinButton  _rendering_tile_multiplier;
+    UI::Widget::PrefCheckButton _rendering_threaded;
+    UI::Widget::PrefCheckButton _rendering_background;
+    UI::Widget::PrefCheckButton _rendering_progressive;
     UI::Widget::PrefSpinButton _rendering_xray_radius;
     UI::Widget::PrefSpinButton  _filter_multi_threaded;
 
@@ -14,6 +14,7 @@
 #ifndef SEEN_XML_SP_REPR_ATTR_H
 #define SEEN_XML_SP_REPR_ATTR_H
 
+#include <cstddef>
 #include <glib.h>
 #include "inkgc/gc-managed.h"
 #include "util/share.h"
@@ -42,6 +43,29 @@ struct AttributeRecord : public Inkscape::GC::Managed<> {
     // accept default copy constructor and assignment operator
 };
 
+/**
+ * @brief Range over the attributes of a node, in document order
+ *
+ * Unlike Node::attributeList(), this does not allocate anything. The range refers to the
+ * node's own storage, so it is invalidated by any change to the node's attributes.
+ */
+class AttributeRange {
+public:
+    typedef AttributeRecord const *iterator;
+
+    AttributeRange() : _begin(nullptr), _end(nullptr) {}
+    AttributeRange(iterator begin, iterator end) : _begin(begin), _end(end) {}
+
+    iterator begin() const { return _begin; }
+    iterator end() const { return _end; }
+    bool empty() const { return _begin == _end; }
+    std::size_t size() const { return _end - _begin; }
+
+private:
+    iterator _begin;
+    iterator _end;
+};
+
 }
 }
 
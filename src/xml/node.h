@@ -16,11 +16,11 @@
 #include <glibmm/ustring.h>
 #include "gc-anchored.h"
 #include "util/list.h"
+#include "xml/attribute-record.h"
 
 namespace Inkscape {
 namespace XML {
 
-struct AttributeRecord;
 struct Document;
 class  Event;
 class  NodeObserver;
@@ -144,6 +144,7 @@ public:
      * @brief Get a list of the node's attributes
      *
      * The returned list is a functional programming style list rather than a standard one.
+     * It is built on every call; prefer attributes(), which is kept for existing callers only.
      *
      * @return A list of AttributeRecord structures describing the attributes
      * @todo This method should return std::map<Glib::Quark const, gchar const *>
@@ -151,6 +152,21 @@ public:
      */
     virtual Inkscape::Util::List<AttributeRecord const> attributeList() const=0;
 
+    /**
+     * @brief Get the node's attributes, in document order
+     *
+     * The range refers to the node's storage and is invalidated when an attribute of
+     * the node is set or removed, so don't change the node while iterating over it.
+     */
+    virtual AttributeRange attributes() const=0;
+
+    /**
+     * @brief Check whether this node has any attributes
+     *
+     * Same as testing whether attributes() is empty.
+     */
+    virtual bool hasAttributes() const=0;
+
     /**
      * @brief Check whether this node has any attribute that matches a string
      *
@@ -11,12 +11,15 @@
  * Released under GNU GPL v2+, read the file 'COPYING' for more information.
  */
 
+#include <algorithm>
 #include <cstring>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 #include <libxml/parser.h>
 
+#include "inkgc/gc-alloc.h"
 #include "xml/repr.h"
 #include "xml/attribute-record.h"
 #include "xml/rebase-hrefs.h"
@@ -58,7 +61,7 @@ static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
 static void sp_repr_write_stream_element(Node *repr, Writer &out,
                                          gint indent_level, bool add_whitespace,
                                          Glib::QueryQuark elide_prefix,
-                                         List<AttributeRecord const> attributes,
+                                         Inkscape::XML::AttributeRange attributes,
                                          int inlineattrs, int indent,
                                          gchar const *old_href_abs_base,
                                          gchar const *new_href_abs_base);
@@ -829,10 +832,8 @@ void add_ns_map_entry(NSMap &ns_map, Glib::QueryQuark prefix) {
 void populate_ns_map(NSMap &ns_map, Node &repr) {
     if ( repr.type() == Inkscape::XML::ELEMENT_NODE ) {
         add_ns_map_entry(ns_map, qname_prefix(repr.code()));
-        for ( List<AttributeRecord const> iter=repr.attributeList() ;
-              iter ; ++iter )
-        {
-            Glib::QueryQuark prefix=qname_prefix(iter->key);
+        for (auto const &attr : repr.attributes()) {
+            Glib::QueryQuark prefix=qname_prefix(attr.key);
             if (prefix.id()) {
                 add_ns_map_entry(ns_map, prefix);
             }
@@ -876,7 +877,8 @@ static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
         elide_prefix = g_quark_from_string(sp_xml_ns_uri_prefix(default_ns, nullptr));
     }
 
-    List<AttributeRecord const> attributes=repr->attributeList();
+    // the namespace declarations come first, the last declared one leading
+    std::vector<AttributeRecord, Inkscape::GC::Alloc<AttributeRecord, Inkscape::GC::AUTO>> attributes;
     for (auto & iter : ns_map) 
     {
         Glib::QueryQuark prefix=iter.first;
@@ -885,13 +887,13 @@ static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
         if (prefix.id()) {
             if ( prefix != xml_prefix ) {
                 if ( elide_prefix == prefix ) {
-                    attributes = cons(AttributeRecord(g_quark_from_static_string("xmlns"), ns_uri), attributes);
+                    attributes.push_back(AttributeRecord(g_quark_from_static_string("xmlns"), ns_uri));
                 }
 
                 Glib::ustring attr_name="xmlns:";
                 attr_name.append(g_quark_to_string(prefix));
                 GQuark key = g_quark_from_string(attr_name.c_str());
-                attributes = cons(AttributeRecord(key, ns_uri), attributes);
+                attributes.push_back(AttributeRecord(key, ns_uri));
             }
         } else {
             // if there are non-namespaced elements, we can't globally
@@ -899,8 +901,13 @@ static void sp_repr_write_stream_root_element(Node *repr, Writer &out,
             elide_prefix = GQuark(0);
         }
     }
+    std::reverse(attributes.begin(), attributes.end());
+    Inkscape::XML::AttributeRange const own = repr->attributes();
+    attributes.insert(attributes.end(), own.begin(), own.end());
 
-    return sp_repr_write_stream_element(repr, out, 0, add_whitespace, elide_prefix, attributes,
+    return sp_repr_write_stream_element(repr, out, 0, add_whitespace, elide_prefix,
+                                        Inkscape::XML::AttributeRange(attributes.data(),
+                                                                      attributes.data() + attributes.size()),
                                         inlineattrs, indent, old_href_base, new_href_base);
 }
 
@@ -931,7 +938,7 @@ void sp_repr_write_stream( Node *repr, Writer &out, gint indent_level,
         case Inkscape::XML::ELEMENT_NODE: {
             sp_repr_write_stream_element( repr, out, indent_level,
                                           add_whitespace, elide_prefix,
-                                          repr->attributeList(),
+                                          repr->attributes(),
                                           inlineattrs, indent,
                                           old_href_base, new_href_base);
             break;
@@ -950,7 +957,7 @@ void sp_repr_write_stream( Node *repr, Writer &out, gint indent_level,
 void sp_repr_write_stream_element( Node * repr, Writer & out,
                                    gint indent_level, bool add_whitespace,
                                    Glib::QueryQuark elide_prefix,
-                                   List<AttributeRecord const> attributes, 
+                                   Inkscape::XML::AttributeRange attributes,
                                    int inlineattrs, int indent,
                                    gchar const *old_href_base,
                                    gchar const *new_href_base )
@@ -997,10 +1004,16 @@ void sp_repr_write_stream_element( Node * repr, Writer & out,
         }
     }
 
-    for ( List<AttributeRecord const> iter = rebase_href_attrs(old_href_base, new_href_base,
-                                                               attributes);
-          iter ; ++iter )
-    {
+    // only rebasing the hrefs needs the attributes as a list
+    List<AttributeRecord const> rebased;
+    if (old_href_base != new_href_base) {
+        for (auto iter = attributes.end(); iter != attributes.begin(); ) {
+            --iter;
+            rebased = cons(*iter, rebased);
+        }
+        rebased = rebase_href_attrs(old_href_base, new_href_base, rebased);
+    }
+    auto write_attribute = [&](AttributeRecord const &attr) {
         if (!inlineattrs) {
             out.writeChar('\n');
             if (indent) {
@@ -1011,9 +1024,18 @@ void sp_repr_write_stream_element( Node * repr, Writer & out,
                 }
             }
         }
-        out.printf(" %s=\"", g_quark_to_string(iter->key));
-        repr_quote_write(out, iter->value);
+        out.printf(" %s=\"", g_quark_to_string(attr.key));
+        repr_quote_write(out, attr.value);
         out.writeChar('"');
+    };
+    if (old_href_base != new_href_base) {
+        for (List<AttributeRecord const> iter = rebased; iter; ++iter) {
+            write_attribute(*iter);
+        }
+    } else {
+        for (auto const &attr : attributes) {
+            write_attribute(attr);
+        }
     }
 
     loose = TRUE;
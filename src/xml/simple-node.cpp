@@ -36,6 +36,9 @@ namespace XML {
 
 namespace {
 
+/// Nodes with this many attributes look them up through a hash index.
+std::size_t const ATTRIBUTE_INDEX_THRESHOLD = 16;
+
 std::shared_ptr<std::string> stringify_node(Node const &node) {
     gchar *string;
     switch (node.type()) {
@@ -167,8 +170,6 @@ using Util::share_unsafe;
 using Util::List;
 using Util::MutableList;
 using Util::cons;
-using Util::rest;
-using Util::set_rest;
 
 SimpleNode::SimpleNode(int code, Document *document)
 : Node(), _name(code), _attributes(), _child_count(0),
@@ -186,7 +187,8 @@ SimpleNode::SimpleNode(int code, Document *document)
 SimpleNode::SimpleNode(SimpleNode const &node, Document *document)
 : Node(),
   _cached_position(node._cached_position),
-  _name(node._name), _attributes(), _content(node._content),
+  _name(node._name), _attributes(node._attributes), _attribute_index(node._attribute_index),
+  _content(node._content),
   _child_count(node._child_count),
   _cached_positions_valid(node._cached_positions_valid)
 {
@@ -213,12 +215,6 @@ SimpleNode::SimpleNode(SimpleNode const &node, Document *document)
         child_copy->release(); // release to avoid a leak
     }
 
-    for ( List<AttributeRecord const> iter = node._attributes ;
-          iter ; ++iter )
-    {
-        _attributes = cons(*iter, _attributes);
-    }
-
     _observers.add(_subtree_observers);
 }
 
@@ -233,17 +229,57 @@ gchar const *SimpleNode::content() const {
 gchar const *SimpleNode::attribute(gchar const *name) const {
     g_return_val_if_fail(name != nullptr, NULL);
 
-    GQuark const key = g_quark_from_string(name);
+    std::ptrdiff_t const position = _attributePosition(g_quark_from_string(name));
+    if (position < 0) {
+        return nullptr;
+    }
+    return _attributes[position].value;
+}
 
-    for ( List<AttributeRecord const> iter = _attributes ;
-          iter ; ++iter )
-    {
-        if ( iter->key == key ) {
-            return iter->value;
+List<AttributeRecord const> SimpleNode::attributeList() const {
+    MutableList<AttributeRecord> list;
+    for (auto iter = _attributes.rbegin() ; iter != _attributes.rend() ; ++iter) {
+        list = cons(*iter, list);
+    }
+    return list;
+}
+
+std::ptrdiff_t SimpleNode::_attributePosition(GQuark key) const {
+    if (!_attribute_index.empty()) {
+        auto found = _attribute_index.find(key);
+        return found == _attribute_index.end() ? -1 : found->second;
+    }
+    // few attributes: scanning the keys is faster than hashing
+    for (std::size_t i = 0 ; i < _attributes.size() ; i++) {
+        if ( _attributes[i].key == key ) {
+            return i;
         }
     }
+    return -1;
+}
 
-    return nullptr;
+void SimpleNode::_appendAttribute(GQuark key, ptr_shared value) {
+    _attributes.push_back(AttributeRecord(key, value));
+    if (_attributes.size() == ATTRIBUTE_INDEX_THRESHOLD) {
+        for (std::size_t i = 0 ; i < _attributes.size() ; i++) {
+            _attribute_index[_attributes[i].key] = i;
+        }
+    } else if (_attributes.size() > ATTRIBUTE_INDEX_THRESHOLD) {
+        _attribute_index[key] = _attributes.size() - 1;
+    }
+}
+
+void SimpleNode::_removeAttribute(std::size_t position) {
+    GQuark const key = _attributes[position].key;
+    _attributes.erase(_attributes.begin() + position);
+    if (_attributes.size() < ATTRIBUTE_INDEX_THRESHOLD) {
+        _attribute_index.clear();
+    } else {
+        _attribute_index.erase(key);
+        for (std::size_t i = position ; i < _attributes.size() ; i++) {
+            _attribute_index[_attributes[i].key] = i;
+        }
+    }
 }
 
 unsigned SimpleNode::position() const {
@@ -276,10 +312,8 @@ Node *SimpleNode::nthChild(unsigned index) {
 bool SimpleNode::matchAttributeName(gchar const *partial_name) const {
     g_return_val_if_fail(partial_name != nullptr, false);
 
-    for ( List<AttributeRecord const> iter = _attributes ;
-          iter ; ++iter )
-    {
-        gchar const *name = g_quark_to_string(iter->key);
+    for (auto const &iter : _attributes) {
+        gchar const *name = g_quark_to_string(iter.key);
         if (std::strstr(name, partial_name)) {
             return true;
         }
@@ -367,40 +401,24 @@ SimpleNode::setAttribute(gchar const *name, gchar const *value, bool const /*is_
 
     GQuark const key = g_quark_from_string(name);
 
-    MutableList<AttributeRecord> ref;
-    MutableList<AttributeRecord> existing;
-    for ( existing = _attributes ; existing ; ++existing ) {
-        if ( existing->key == key ) {
-            break;
-        }
-        ref = existing;
-    }
+    std::ptrdiff_t const existing = _attributePosition(key);
     Debug::EventTracker<> tracker;
 
-    ptr_shared old_value=( existing ? existing->value : ptr_shared() );
+    ptr_shared old_value=( existing >= 0 ? _attributes[existing].value : ptr_shared() );
 
     ptr_shared new_value=ptr_shared();
     if (cleaned_value) {
         new_value = share_string(cleaned_value);
         tracker.set<DebugSetAttribute>(*this, key, new_value);
-        if (!existing) {
-            if (ref) {
-                set_rest(ref, MutableList<AttributeRecord>(AttributeRecord(key, new_value)));
-            } else {
-                _attributes = MutableList<AttributeRecord>(AttributeRecord(key, new_value));
-            }
+        if (existing < 0) {
+            _appendAttribute(key, new_value);
         } else {
-            existing->value = new_value;
+            _attributes[existing].value = new_value;
         }
     } else {
         tracker.set<DebugClearAttribute>(*this, key);
-        if (existing) {
-            if (ref) {
-                set_rest(ref, rest(existing));
-            } else {
-                _attributes = rest(existing);
-            }
-            set_rest(existing, MutableList<AttributeRecord>());
+        if (existing >= 0) {
+            _removeAttribute(existing);
         }
     }
 
@@ -620,10 +638,8 @@ const NodeEventVector OBSERVER_EVENT_VECTOR = {
 
 void SimpleNode::synthesizeEvents(NodeEventVector const *vector, void *data) {
     if (vector->attr_changed) {
-        for ( List<AttributeRecord const> iter = _attributes ;
-              iter ; ++iter )
-        {
-            vector->attr_changed(this, g_quark_to_string(iter->key), nullptr, iter->value, false, data);
+        for (auto const &iter : _attributes) {
+            vector->attr_changed(this, g_quark_to_string(iter.key), nullptr, iter.value, false, data);
         }
     }
     if (vector->child_added) {
@@ -720,16 +736,10 @@ bool SimpleNode::equal(Node const *other, bool recursive) {
     if(content() && other->content() && strcmp(content(), other->content()) != 0){
         return false;
     }
-    for (List<AttributeRecord const> orig_attr = attributeList(); orig_attr; ++orig_attr) {
-        for (List<AttributeRecord const> other_attr = other->attributeList(); other_attr; ++other_attr) {
-            const gchar * key_orig = g_quark_to_string(orig_attr->key);
-            const gchar * key_other = g_quark_to_string(other_attr->key);
-            if (!strcmp(key_orig, key_other) && 
-                !strcmp(orig_attr->value, other_attr->value)) 
-            {
-                other_length++;
-                break;
-            }
+    for (auto const &orig_attr : _attributes) {
+        gchar const *other_value = other->attribute(g_quark_to_string(orig_attr.key));
+        if (other_value && !strcmp(orig_attr.value, other_value)) {
+            other_length++;
         }
         orig_length++;
     }
@@ -792,10 +802,8 @@ void SimpleNode::mergeFrom(Node const *src, gchar const *key, bool extension, bo
         }
     }
 
-    for ( List<AttributeRecord const> iter = src->attributeList() ;
-          iter ; ++iter )
-    {
-        setAttribute(g_quark_to_string(iter->key), iter->value);
+    for (auto const &attr : src->attributes()) {
+        setAttribute(g_quark_to_string(attr.key), attr.value);
     }
 }
 
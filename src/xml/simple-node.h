@@ -16,8 +16,12 @@
 #define SEEN_INKSCAPE_XML_SIMPLE_NODE_H
 
 #include <cassert>
+#include <cstddef>
 #include <iostream>
+#include <unordered_map>
+#include <vector>
 
+#include "inkgc/gc-alloc.h"
 #include "xml/node.h"
 #include "xml/attribute-record.h"
 #include "xml/composite-node-observer.h"
@@ -92,9 +96,12 @@ public:
     bool equal(Node const *other, bool recursive) override;
     void mergeFrom(Node const *src, char const *key, bool extension = false, bool clean = false) override;
 
-    Inkscape::Util::List<AttributeRecord const> attributeList() const override {
-        return _attributes;
+    Inkscape::Util::List<AttributeRecord const> attributeList() const override;
+    AttributeRange attributes() const override
+    {
+        return AttributeRange(_attributes.data(), _attributes.data() + _attributes.size());
     }
+    bool hasAttributes() const override { return !_attributes.empty(); }
 
     void synthesizeEvents(NodeEventVector const *vector, void *data) override;
     void synthesizeEvents(NodeObserver &observer) override;
@@ -131,9 +138,19 @@ protected:
 private:
     void operator=(Node const &); // no assign
 
+    typedef std::vector<AttributeRecord, Inkscape::GC::Alloc<AttributeRecord, Inkscape::GC::AUTO>>
+        AttributeVector;
+    typedef std::unordered_map<GQuark, std::size_t, std::hash<GQuark>, std::equal_to<GQuark>,
+                               Inkscape::GC::Alloc<std::pair<GQuark const, std::size_t>, Inkscape::GC::AUTO>>
+        AttributeIndex;
+
     void _setParent(SimpleNode *parent);
     unsigned _childPosition(SimpleNode const &child) const;
 
+    std::ptrdiff_t _attributePosition(GQuark key) const;
+    void _appendAttribute(GQuark key, Inkscape::Util::ptr_shared value);
+    void _removeAttribute(std::size_t position);
+
     SimpleNode *_parent;
     SimpleNode *_next;
     SimpleNode *_prev;
@@ -142,7 +159,10 @@ private:
 
     int _name;
 
-    Inkscape::Util::MutableList<AttributeRecord> _attributes;
+    /// The attributes, in document order.
+    AttributeVector _attributes;
+    /// Position of each attribute in _attributes, only kept for nodes with many attributes.
+    AttributeIndex _attribute_index;
 
     Inkscape::Util::ptr_shared _content;
 
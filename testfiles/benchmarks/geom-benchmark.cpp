@@ -0,0 +1,436 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/**
+ * @file
+ * Benchmarks of the geometry kernels of 2geom and livarot.
+ *
+ * Every kernel is run on two corpora:
+ * - synthetic paths, made by a seeded generator so that they are the same on every run and
+ *   every machine, in sizes from a few to a few thousand segments;
+ * - the paths of the example drawings in share/examples.
+ *
+ * The boolean operations run both cold, with the polyline cache and the shape arena of
+ * livarot emptied before each iteration, and warm, reusing them as repeated operations do.
+ *
+ * Run them with 'make benchmark', which writes the results in JSON to geom-benchmark.json in
+ * the build directory. geom-benchmark takes the usual Google Benchmark options, e.g.
+ * --benchmark_filter=Boolop to run some of the benchmarks only.
+ */
+/*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ *
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <glib.h>
+#include <2geom/bezier-curve.h>
+#include <2geom/pathvector.h>
+
+#include "helper/geom.h"
+#include "helper/geom-pathstroke.h"
+#include "livarot/Path.h"
+#include "livarot/Shape.h"
+#include "livarot/polyline-cache.h"
+#include "livarot/shape-arena.h"
+#include "splivarot.h"
+#include "svg/svg.h"
+
+namespace {
+
+/// Example drawings making up the real-world corpus, relative to INKSCAPE_BENCHMARK_CORPUS.
+char const *const CORPUS_FILES[] = {
+    "animated-clock.svg",
+    "eastern-motive-P4G.svg",
+    "live-path-effects-gears.svg",
+    "live-path-effects-pathalongpath.svg",
+    "markers.svg",
+    "rope-3D.svg",
+    "tesselation-P3.svg",
+};
+
+/// Seed of the synthetic paths; changing it changes the results.
+unsigned const SEED = 20200101;
+
+/**
+ * Random number in [min, max). The distributions of the standard library may differ between
+ * implementations, while std::mt19937 does not.
+ */
+double uniform(std::mt19937 &gen, double min, double max)
+{
+    return min + (max - min) * (gen() / 4294967296.0);
+}
+
+/**
+ * A closed path of n cubic segments around a circle. The nodes are at random distances from the
+ * center, and the segments bulge alternately in and out.
+ */
+Geom::Path wavy_circle(int n, unsigned seed, Geom::Point const &center, double radius)
+{
+    std::mt19937 gen(seed);
+    std::vector<Geom::Point> nodes;
+    for (int i = 0; i < n; i++) {
+        double const a = 2 * M_PI * i / n;
+        nodes.push_back(center + radius * uniform(gen, 0.7, 1.3) * Geom::Point(std::cos(a), std::sin(a)));
+    }
+
+    Geom::Path path(nodes[0]);
+    for (int i = 0; i < n; i++) {
+        Geom::Point const &p0 = nodes[i];
+        Geom::Point const &p3 = nodes[(i + 1) % n];
+        Geom::Point const d = (p3 - p0) / 3;
+        Geom::Point const bulge = Geom::rot90(d) * ((i % 2) ? 0.5 : -0.5);
+        path.appendNew<Geom::CubicBezier>(p0 + d + bulge, p3 - d + bulge, p3);
+    }
+    path.close();
+    return path;
+}
+
+Geom::PathVector synthetic(int n, unsigned seed, Geom::Point const &center = Geom::Point(0, 0))
+{
+    return Geom::PathVector(wavy_circle(n, seed, center, 100));
+}
+
+struct Corpus {
+    std::vector<std::string> data;       ///< the path data of the drawings
+    std::vector<Geom::PathVector> paths; ///< the same, parsed, without the empty ones
+};
+
+Corpus const &real_world()
+{
+    static Corpus const corpus = [] {
+        Corpus c;
+        for (auto file : CORPUS_FILES) {
+            std::ifstream in(std::string(INKSCAPE_BENCHMARK_CORPUS) + "/" + file);
+            std::string const text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            // d attributes, which are preceded by white space unlike e.g. inkscape:original-d
+            for (auto pos = text.find("d=\""); pos != std::string::npos; pos = text.find("d=\"", pos + 3)) {
+                auto const end = text.find('"', pos + 3);
+                if (pos == 0 || !g_ascii_isspace(text[pos - 1]) || end == std::string::npos) {
+                    continue;
+                }
+                c.data.push_back(text.substr(pos + 3, end - pos - 3));
+            }
+        }
+        for (auto const &d : c.data) {
+            Geom::PathVector pv = sp_svg_read_pathv(d.c_str());
+            if (!pv.empty()) {
+                c.paths.push_back(pv);
+            }
+        }
+        return c;
+    }();
+    return corpus;
+}
+
+std::size_t count_curves(std::vector<Geom::PathVector> const &paths)
+{
+    std::size_t count = 0;
+    for (auto const &pv : paths) {
+        count += pv.curveCount();
+    }
+    return count;
+}
+
+/// Fill a livarot polygon with the polyline of a path, as the boolean operations do.
+void fill_polygon(Geom::PathVector const &pv, Shape &polygon)
+{
+    Path path;
+    path.LoadPathVector(pv);
+    path.ConvertWithBackData(1.0);
+    path.Fill(&polygon, 0);
+}
+
+/* sp_svg_read_pathv */
+
+void BM_ReadPathv_Synthetic(benchmark::State &state)
+{
+    char *d = sp_svg_write_path(synthetic(state.range(0), SEED));
+    std::string const data = d;
+    g_free(d);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sp_svg_read_pathv(data.c_str()));
+    }
+    state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_ReadPathv_Synthetic)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_ReadPathv_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    std::size_t bytes = 0;
+    for (auto const &d : corpus.data) {
+        bytes += d.size();
+    }
+    for (auto _ : state) {
+        for (auto const &d : corpus.data) {
+            benchmark::DoNotOptimize(sp_svg_read_pathv(d.c_str()));
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+}
+BENCHMARK(BM_ReadPathv_RealWorld);
+
+/* bounds_exact */
+
+void BM_BoundsExact_Synthetic(benchmark::State &state)
+{
+    Geom::PathVector const pv = synthetic(state.range(0), SEED);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Geom::bounds_exact(pv));
+    }
+    state.SetItemsProcessed(state.iterations() * pv.curveCount());
+}
+BENCHMARK(BM_BoundsExact_Synthetic)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_BoundsExact_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    for (auto _ : state) {
+        for (auto const &pv : corpus.paths) {
+            benchmark::DoNotOptimize(Geom::bounds_exact(pv));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count_curves(corpus.paths));
+}
+BENCHMARK(BM_BoundsExact_RealWorld);
+
+/* Geom::Path::nearestTime */
+
+void BM_NearestTime_Synthetic(benchmark::State &state)
+{
+    Geom::Path const path = synthetic(state.range(0), SEED)[0];
+    std::mt19937 gen(SEED);
+    std::vector<Geom::Point> points;
+    for (int i = 0; i < 64; i++) {
+        double const x = uniform(gen, -150, 150);
+        points.emplace_back(x, uniform(gen, -150, 150));
+    }
+    for (auto _ : state) {
+        for (auto const &p : points) {
+            benchmark::DoNotOptimize(path.nearestTime(p));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * points.size());
+}
+BENCHMARK(BM_NearestTime_Synthetic)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_NearestTime_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    // one point near each path, at a fixed offset from a corner of its bounding box
+    std::vector<Geom::Point> points;
+    for (auto const &pv : corpus.paths) {
+        Geom::OptRect const bounds = pv.boundsFast();
+        points.push_back(bounds ? bounds->corner(0) + Geom::Point(3, 5) : Geom::Point(0, 0));
+    }
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < corpus.paths.size(); i++) {
+            for (auto const &path : corpus.paths[i]) {
+                benchmark::DoNotOptimize(path.nearestTime(points[i]));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * corpus.paths.size());
+}
+BENCHMARK(BM_NearestTime_RealWorld);
+
+/* Geom::PathVector::intersect */
+
+void BM_Intersect_Synthetic(benchmark::State &state)
+{
+    Geom::PathVector const a = synthetic(state.range(0), SEED);
+    Geom::PathVector const b = synthetic(state.range(0), SEED + 1, Geom::Point(30, 20));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a.intersect(b));
+    }
+    state.SetItemsProcessed(state.iterations() * (a.curveCount() + b.curveCount()));
+}
+BENCHMARK(BM_Intersect_Synthetic)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_Intersect_RealWorld(benchmark::State &state)
+{
+    // each path of the corpus against the next one, which is often drawn over it
+    Corpus const &corpus = real_world();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i + 1 < corpus.paths.size(); i++) {
+            benchmark::DoNotOptimize(corpus.paths[i].intersect(corpus.paths[i + 1]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count_curves(corpus.paths));
+}
+BENCHMARK(BM_Intersect_RealWorld);
+
+/* pathv_intersections */
+
+void BM_PathvIntersections_Synthetic(benchmark::State &state)
+{
+    Geom::PathVector const a = synthetic(state.range(0), SEED);
+    Geom::PathVector const b = synthetic(state.range(0), SEED + 1, Geom::Point(30, 20));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(pathv_intersections(a, b));
+    }
+    state.SetItemsProcessed(state.iterations() * (a.curveCount() + b.curveCount()));
+}
+BENCHMARK(BM_PathvIntersections_Synthetic)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_PathvIntersections_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    for (auto _ : state) {
+        for (std::size_t i = 0; i + 1 < corpus.paths.size(); i++) {
+            benchmark::DoNotOptimize(pathv_intersections(corpus.paths[i], corpus.paths[i + 1]));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count_curves(corpus.paths));
+}
+BENCHMARK(BM_PathvIntersections_RealWorld);
+
+/* Shape::ConvertToShape */
+
+void BM_ConvertToShape_Synthetic(benchmark::State &state)
+{
+    Geom::PathVector pv = synthetic(state.range(0), SEED);
+    // two overlapping paths, so that the sweep has intersections to find
+    pv.push_back(wavy_circle(state.range(0), SEED + 1, Geom::Point(30, 20), 100));
+    Shape polygon;
+    fill_polygon(pv, polygon);
+    for (auto _ : state) {
+        Shape result;
+        result.ConvertToShape(&polygon, fill_nonZero);
+        benchmark::DoNotOptimize(result.numberOfEdges());
+    }
+    state.SetItemsProcessed(state.iterations() * polygon.numberOfEdges());
+}
+BENCHMARK(BM_ConvertToShape_Synthetic)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_ConvertToShape_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    std::vector<std::unique_ptr<Shape> > polygons;
+    int edges = 0;
+    for (auto const &pv : corpus.paths) {
+        polygons.emplace_back(new Shape);
+        fill_polygon(pv, *polygons.back());
+        edges += polygons.back()->numberOfEdges();
+    }
+    for (auto _ : state) {
+        for (auto &polygon : polygons) {
+            Shape result;
+            result.ConvertToShape(polygon.get(), fill_nonZero);
+            benchmark::DoNotOptimize(result.numberOfEdges());
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * edges);
+}
+BENCHMARK(BM_ConvertToShape_RealWorld);
+
+/* sp_pathvector_boolop */
+
+/// Whether the caches of livarot are emptied before each iteration.
+enum Caches { COLD, WARM };
+
+/// Empty the polyline cache and the memory kept by the shape arena, without timing it.
+void reset_caches(benchmark::State &state)
+{
+    state.PauseTiming();
+    PolylineCache::clear();
+    ShapeArena::trim();
+    state.ResumeTiming();
+}
+
+template <bool_op OP, Caches CACHES>
+void BM_Boolop_Synthetic(benchmark::State &state)
+{
+    Geom::PathVector const a = synthetic(state.range(0), SEED);
+    Geom::PathVector const b = synthetic(state.range(0), SEED + 1, Geom::Point(30, 20));
+    for (auto _ : state) {
+        if (CACHES == COLD) {
+            reset_caches(state);
+        }
+        benchmark::DoNotOptimize(sp_pathvector_boolop(a, b, OP, fill_nonZero, fill_nonZero));
+    }
+    state.SetItemsProcessed(state.iterations() * (a.curveCount() + b.curveCount()));
+}
+BENCHMARK_TEMPLATE2(BM_Boolop_Synthetic, bool_op_union, COLD)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE2(BM_Boolop_Synthetic, bool_op_union, WARM)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE2(BM_Boolop_Synthetic, bool_op_inters, COLD)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE2(BM_Boolop_Synthetic, bool_op_inters, WARM)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE2(BM_Boolop_Synthetic, bool_op_diff, COLD)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE2(BM_Boolop_Synthetic, bool_op_diff, WARM)->RangeMultiplier(8)->Range(8, 4096);
+
+template <bool_op OP, Caches CACHES>
+void BM_Boolop_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    for (auto _ : state) {
+        if (CACHES == COLD) {
+            reset_caches(state);
+        }
+        for (std::size_t i = 0; i + 1 < corpus.paths.size(); i++) {
+            benchmark::DoNotOptimize(sp_pathvector_boolop(corpus.paths[i], corpus.paths[i + 1], OP,
+                                                          fill_nonZero, fill_nonZero));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count_curves(corpus.paths));
+}
+BENCHMARK_TEMPLATE2(BM_Boolop_RealWorld, bool_op_union, COLD);
+BENCHMARK_TEMPLATE2(BM_Boolop_RealWorld, bool_op_union, WARM);
+BENCHMARK_TEMPLATE2(BM_Boolop_RealWorld, bool_op_inters, COLD);
+BENCHMARK_TEMPLATE2(BM_Boolop_RealWorld, bool_op_inters, WARM);
+BENCHMARK_TEMPLATE2(BM_Boolop_RealWorld, bool_op_diff, COLD);
+BENCHMARK_TEMPLATE2(BM_Boolop_RealWorld, bool_op_diff, WARM);
+
+/* Inkscape::outline */
+
+template <Inkscape::LineJoinType JOIN>
+void BM_Outline_Synthetic(benchmark::State &state)
+{
+    Geom::Path const path = synthetic(state.range(0), SEED)[0];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Inkscape::outline(path, 4.0, 4.0, JOIN, Inkscape::BUTT_FLAT));
+    }
+    state.SetItemsProcessed(state.iterations() * path.size());
+}
+BENCHMARK_TEMPLATE(BM_Outline_Synthetic, Inkscape::JOIN_BEVEL)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_Outline_Synthetic, Inkscape::JOIN_ROUND)->RangeMultiplier(8)->Range(8, 4096);
+BENCHMARK_TEMPLATE(BM_Outline_Synthetic, Inkscape::JOIN_MITER)->RangeMultiplier(8)->Range(8, 4096);
+
+void BM_Outline_RealWorld(benchmark::State &state)
+{
+    Corpus const &corpus = real_world();
+    for (auto _ : state) {
+        for (auto const &pv : corpus.paths) {
+            for (auto const &path : pv) {
+                benchmark::DoNotOptimize(Inkscape::outline(path, 2.0, 4.0, Inkscape::JOIN_ROUND,
+                                                           Inkscape::BUTT_ROUND));
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * count_curves(corpus.paths));
+}
+BENCHMARK(BM_Outline_RealWorld);
+
+} // namespace
+
+BENCHMARK_MAIN();
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
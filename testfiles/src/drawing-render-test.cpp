@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the threaded rendering of drawings.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include <cairo.h>
+
+#include <gtest/gtest.h>
+#include <doc-per-case-test.h>
+
+#include "display/drawing-context.h"
+#include "display/drawing-surface.h"
+#include "display/drawing.h"
+#include "object/sp-root.h"
+
+namespace {
+
+int const SIZE = 200;
+
+class DrawingRenderTest : public DocPerCaseTest {
+protected:
+    void SetUp() override
+    {
+        // a pattern made of several items, so that its children are rendered as a drawing
+        std::string const svg = "<svg xmlns='http://www.w3.org/2000/svg' width='200' height='200'>"
+                                "<defs><pattern id='p' patternUnits='userSpaceOnUse' width='13' height='11'>"
+                                "<rect width='7' height='5' fill='#c03010'/>"
+                                "<circle cx='9' cy='7' r='3.5' fill='#1040d0' opacity='0.6'/>"
+                                "</pattern></defs>"
+                                "<rect x='3' y='2' width='190' height='193' fill='url(#p)' stroke='url(#p)' stroke-width='6'/>"
+                                "<circle cx='100' cy='100' r='60' fill='url(#p)' opacity='0.5'/>"
+                                "</svg>";
+        doc = SPDocument::createNewDocFromMem(svg.c_str(), static_cast<int>(svg.size()), false);
+        ASSERT_NE(doc, nullptr);
+        doc->ensureUpToDate();
+        dkey = SPItem::display_key_new(1);
+        drawing.setRoot(doc->getRoot()->invoke_show(drawing, dkey, SP_ITEM_SHOW_DISPLAY));
+        drawing.update();
+    }
+
+    void TearDown() override
+    {
+        if (doc) {
+            doc->getRoot()->invoke_hide(dkey);
+            doc->doUnref();
+        }
+    }
+
+    /// Renders the whole drawing, on @a threads threads.
+    cairo_surface_t *render(int threads)
+    {
+        Geom::IntRect const area(0, 0, SIZE, SIZE);
+        Inkscape::DrawingSurface surface(area);
+        {
+            Inkscape::DrawingContext dc(surface);
+            if (threads > 1) {
+                drawing.renderThreaded(dc, area, threads);
+            } else {
+                drawing.render(dc, area);
+            }
+        }
+        cairo_surface_t *result = surface.raw();
+        cairo_surface_reference(result);
+        cairo_surface_flush(result);
+        return result;
+    }
+
+    SPDocument *doc = nullptr;
+    Inkscape::Drawing drawing;
+    unsigned dkey = 0;
+};
+
+/// Largest difference between the channels of two images of the same size.
+int max_difference(cairo_surface_t *a, cairo_surface_t *b)
+{
+    int const width = cairo_image_surface_get_width(a);
+    int const height = cairo_image_surface_get_height(a);
+    int const stride = cairo_image_surface_get_stride(a);
+    unsigned char const *pa = cairo_image_surface_get_data(a);
+    unsigned char const *pb = cairo_image_surface_get_data(b);
+    int result = 0;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < 4 * width; ++x) {
+            result = std::max(result, std::abs(pa[y * stride + x] - pb[y * stride + x]));
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_F(DrawingRenderTest, ThreadedPatternFillMatchesSingleThread)
+{
+    // render the bands first, while the patterns have not been prepared yet
+    cairo_surface_t *threaded = render(4);
+    cairo_surface_t *single = render(1);
+    cairo_surface_t *threaded_again = render(4);
+
+    ASSERT_EQ(cairo_image_surface_get_width(threaded), cairo_image_surface_get_width(single));
+    ASSERT_EQ(cairo_image_surface_get_height(threaded), cairo_image_surface_get_height(single));
+    EXPECT_LE(max_difference(threaded, single), 1);
+    EXPECT_LE(max_difference(threaded_again, single), 1);
+
+    // something was rendered at all
+    cairo_surface_t *blank = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    EXPECT_GT(max_difference(single, blank), 100);
+
+    cairo_surface_destroy(blank);
+    cairo_surface_destroy(threaded);
+    cairo_surface_destroy(single);
+    cairo_surface_destroy(threaded_again);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
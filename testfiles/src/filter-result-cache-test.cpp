@@ -0,0 +1,211 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the cache of filter primitive results.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstdint>
+
+#include <cairo.h>
+
+#include "gtest/gtest.h"
+
+#include "display/nr-filter-result-cache.h"
+
+using Inkscape::Filters::Filter;
+using Inkscape::Filters::FilterResultCache;
+
+namespace {
+
+int const SIZE = 16;
+size_t const SURFACE_BYTES = 4 * SIZE * SIZE;
+
+/// Image filled with a single color, given as premultiplied ARGB.
+cairo_surface_t *create_surface(uint32_t argb)
+{
+    cairo_surface_t *s = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+    cairo_surface_flush(s);
+    unsigned char *data = cairo_image_surface_get_data(s);
+    int stride = cairo_image_surface_get_stride(s);
+    for (int y = 0; y < SIZE; ++y) {
+        uint32_t *row = reinterpret_cast<uint32_t *>(data + y * stride);
+        for (int x = 0; x < SIZE; ++x) {
+            row[x] = argb;
+        }
+    }
+    cairo_surface_mark_dirty(s);
+    return s;
+}
+
+FilterResultCache::Key make_key(uint64_t value)
+{
+    FilterResultCache::Key key;
+    key.add(value);
+    return key;
+}
+
+uint32_t first_pixel(cairo_surface_t *s)
+{
+    cairo_surface_flush(s);
+    return *reinterpret_cast<uint32_t *>(cairo_image_surface_get_data(s));
+}
+
+class FilterResultCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        // the cache is shared by the whole process; start from an empty one
+        cache.setBudget(0);
+    }
+
+    void TearDown() override
+    {
+        cache.setBudget(0);
+    }
+
+    /// Stores an image of the given color.
+    void store(Filter const *filter, uint64_t key, uint32_t argb)
+    {
+        cairo_surface_t *s = create_surface(argb);
+        cache.store(filter, make_key(key), s);
+        cairo_surface_destroy(s);
+    }
+
+    /// Color of the stored image, or 0 if there is none.
+    uint32_t lookup(Filter const *filter, uint64_t key)
+    {
+        return lookup(filter, make_key(key));
+    }
+
+    uint32_t lookup(Filter const *filter, FilterResultCache::Key const &key)
+    {
+        cairo_surface_t *s = cache.lookup(filter, key);
+        if (!s) {
+            return 0;
+        }
+        uint32_t result = first_pixel(s);
+        cairo_surface_destroy(s);
+        return result;
+    }
+
+    FilterResultCache &cache = FilterResultCache::get();
+    int filter_a = 0;
+    int filter_b = 0;
+    // only used as keys
+    Filter const *a = reinterpret_cast<Filter const *>(&filter_a);
+    Filter const *b = reinterpret_cast<Filter const *>(&filter_b);
+};
+
+} // namespace
+
+TEST_F(FilterResultCacheTest, DisabledWithoutBudget)
+{
+    EXPECT_FALSE(cache.enabled());
+    store(a, 1, 0xff102030);
+    EXPECT_EQ(lookup(a, 1), 0u);
+}
+
+TEST_F(FilterResultCacheTest, HitsAndMisses)
+{
+    cache.setBudget(4 * SURFACE_BYTES);
+    ASSERT_TRUE(cache.enabled());
+
+    store(a, 1, 0xff102030);
+    store(b, 1, 0xff405060);
+    EXPECT_EQ(lookup(a, 1), 0xff102030u);
+    EXPECT_EQ(lookup(b, 1), 0xff405060u);
+    EXPECT_EQ(lookup(a, 2), 0u);
+
+    // a new result for the same key replaces the old one
+    store(a, 1, 0xff708090);
+    EXPECT_EQ(lookup(a, 1), 0xff708090u);
+
+    // the stored image is a copy, which does not change with the returned one
+    cairo_surface_t *s = cache.lookup(a, make_key(1));
+    ASSERT_NE(s, nullptr);
+    cairo_t *ct = cairo_create(s);
+    cairo_set_source_rgba(ct, 0, 0, 0, 0);
+    cairo_set_operator(ct, CAIRO_OPERATOR_SOURCE);
+    cairo_paint(ct);
+    cairo_destroy(ct);
+    cairo_surface_destroy(s);
+    EXPECT_EQ(lookup(a, 1), 0xff708090u);
+
+    // dropping a filter discards all its results, and only them
+    store(a, 2, 0xff112233);
+    cache.drop(a);
+    EXPECT_EQ(lookup(a, 1), 0u);
+    EXPECT_EQ(lookup(a, 2), 0u);
+    EXPECT_EQ(lookup(b, 1), 0xff405060u);
+}
+
+TEST_F(FilterResultCacheTest, CollidingHashesMiss)
+{
+    cache.setBudget(4 * SURFACE_BYTES);
+
+    FilterResultCache::Key key = make_key(1);
+    key.add(2);
+    cairo_surface_t *s = create_surface(0xff102030);
+    cache.store(a, key, s);
+    cairo_surface_destroy(s);
+    EXPECT_EQ(lookup(a, key), 0xff102030u);
+
+    // another key, pretending to have the same hash
+    FilterResultCache::Key other = make_key(2);
+    other.add(1);
+    other.hash = key.hash;
+    EXPECT_EQ(lookup(a, other), 0u);
+    EXPECT_EQ(lookup(a, key), 0xff102030u);
+
+    // the same values in another order are another key
+    FilterResultCache::Key swapped = make_key(2);
+    swapped.add(1);
+    EXPECT_NE(swapped, key);
+    EXPECT_EQ(lookup(a, swapped), 0u);
+}
+
+TEST_F(FilterResultCacheTest, EvictsLeastRecentlyUsed)
+{
+    cache.setBudget(3 * SURFACE_BYTES);
+
+    store(a, 1, 0xff000001);
+    store(a, 2, 0xff000002);
+    store(a, 3, 0xff000003);
+    // using the first result makes the second one the oldest
+    EXPECT_EQ(lookup(a, 1), 0xff000001u);
+
+    store(a, 4, 0xff000004);
+    EXPECT_EQ(lookup(a, 2), 0u);
+    EXPECT_EQ(lookup(a, 1), 0xff000001u);
+    EXPECT_EQ(lookup(a, 3), 0xff000003u);
+    EXPECT_EQ(lookup(a, 4), 0xff000004u);
+
+    // images larger than the budget are not stored at all
+    cache.setBudget(SURFACE_BYTES - 1);
+    EXPECT_EQ(lookup(a, 4), 0u);
+    store(a, 5, 0xff000005);
+    EXPECT_EQ(lookup(a, 5), 0u);
+
+    // lowering the budget evicts the oldest results first
+    cache.setBudget(2 * SURFACE_BYTES);
+    store(a, 6, 0xff000006);
+    store(a, 7, 0xff000007);
+    cache.setBudget(SURFACE_BYTES);
+    EXPECT_EQ(lookup(a, 6), 0u);
+    EXPECT_EQ(lookup(a, 7), 0xff000007u);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
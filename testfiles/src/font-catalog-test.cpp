@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the on-disk catalog of fonts.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <string>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "gtest/gtest.h"
+
+#include "libnrtype/font-catalog.h"
+
+using Inkscape::FontCatalog;
+
+namespace {
+
+FontCatalog::Face make_face(char const *file, gint64 mtime, char const *family, char const *style,
+                            char const *display_style)
+{
+    FontCatalog::Face face;
+    face.file = file;
+    face.mtime = mtime;
+    face.family = family;
+    face.style = style;
+    face.display_style = display_style;
+    return face;
+}
+
+class FontCatalogTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        dir = g_dir_make_tmp("font-catalog-test-XXXXXX", nullptr);
+        ASSERT_NE(dir, nullptr);
+        filename = std::string(dir) + G_DIR_SEPARATOR_S + "font-catalog";
+    }
+
+    void TearDown() override
+    {
+        g_unlink(filename.c_str());
+        g_rmdir(dir);
+        g_free(dir);
+    }
+
+    void write(std::string const &contents)
+    {
+        ASSERT_TRUE(g_file_set_contents(filename.c_str(), contents.data(), contents.size(), nullptr));
+    }
+
+    gchar *dir = nullptr;
+    std::string filename;
+};
+
+} // namespace
+
+TEST_F(FontCatalogTest, RoundTrip)
+{
+    FontCatalog catalog;
+    catalog.faces.push_back(make_face("/usr/share/fonts/a.ttf", 1577836800, "Alpha", "Bold", "Bold"));
+    // separators and escapes in the fields must not break the lines apart
+    catalog.faces.push_back(make_face("/home/user/fonts/tab\tand\nnewline.otf", 42, "Tab\tFamily",
+                                      "Back\\slash", "Line\nBreak"));
+    catalog.faces.push_back(make_face("/usr/share/fonts/\xc3\xa9t\xc3\xa9.ttf", 0, "\xc3\x89t\xc3\xa9",
+                                      "Normal", "R\xc3\xa9gulier"));
+    ASSERT_TRUE(catalog.save(filename));
+
+    FontCatalog loaded;
+    ASSERT_TRUE(loaded.load(filename));
+    ASSERT_EQ(loaded.faces.size(), catalog.faces.size());
+    // loading sorts the faces by file, the way scan() does
+    for (auto const &face : catalog.faces) {
+        bool found = false;
+        for (auto const &other : loaded.faces) {
+            found = found || face == other;
+        }
+        EXPECT_TRUE(found) << face.file;
+    }
+
+    // saving the loaded catalog gives the same catalog again
+    ASSERT_TRUE(loaded.save(filename));
+    FontCatalog reloaded;
+    ASSERT_TRUE(reloaded.load(filename));
+    EXPECT_EQ(reloaded, loaded);
+}
+
+TEST_F(FontCatalogTest, RejectsOtherVersions)
+{
+    FontCatalog catalog;
+    catalog.faces.push_back(make_face("/usr/share/fonts/a.ttf", 1, "Alpha", "Normal", "Regular"));
+    ASSERT_TRUE(catalog.save(filename));
+
+    gchar *contents = nullptr;
+    ASSERT_TRUE(g_file_get_contents(filename.c_str(), &contents, nullptr, nullptr));
+    std::string saved = contents;
+    g_free(contents);
+    std::string::size_type eol = saved.find('\n');
+    ASSERT_NE(eol, std::string::npos);
+
+    FontCatalog loaded;
+    write("# Inkscape font catalog 0" + saved.substr(eol));
+    EXPECT_FALSE(loaded.load(filename));
+    EXPECT_TRUE(loaded.faces.empty());
+
+    write(saved.substr(eol + 1));
+    EXPECT_FALSE(loaded.load(filename));
+    EXPECT_TRUE(loaded.faces.empty());
+
+    // a line with a missing field rejects the whole catalog
+    write(saved + "/usr/share/fonts/b.ttf\t1\tBeta\tNormal\n");
+    EXPECT_FALSE(loaded.load(filename));
+    EXPECT_TRUE(loaded.faces.empty());
+
+    write(saved);
+    EXPECT_TRUE(loaded.load(filename));
+    EXPECT_EQ(loaded, catalog);
+
+    g_unlink(filename.c_str());
+    EXPECT_FALSE(loaded.load(filename));
+    EXPECT_TRUE(loaded.faces.empty());
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
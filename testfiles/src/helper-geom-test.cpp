@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the geometry helpers.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <algorithm>
+#include <map>
+
+#include "gtest/gtest.h"
+
+#include <2geom/pathvector.h>
+
+#include "helper/geom.h"
+#include "svg/svg.h"
+
+namespace {
+
+Geom::PathVector test_paths()
+{
+    // many curves, so that they are searched on several threads when available
+    Geom::PathVector pathv;
+    for (int i = 0; i < 20; i++) {
+        Geom::Path path(Geom::Point(i * 10, 0));
+        path.appendNew<Geom::CubicBezier>(Geom::Point(i * 10 + 30, -20), Geom::Point(i * 10 - 20, 40),
+                                          Geom::Point(i * 10 + 5, 30));
+        path.appendNew<Geom::LineSegment>(Geom::Point(i * 10 + 8, 60));
+        path.appendNew<Geom::QuadraticBezier>(Geom::Point(i * 10 + 40, 80), Geom::Point(i * 10, 100));
+        path.close();
+        pathv.push_back(path);
+    }
+    pathv.push_back(sp_svg_read_pathv("M 0,0 A 80,40 30 1 1 200,50")[0]);
+    return pathv;
+}
+
+} // namespace
+
+TEST(HelperGeomTest, NearestTimesMatchPerCurveSearch)
+{
+    Geom::PathVector const pathv = test_paths();
+    Geom::Coord const max_dist = 12;
+
+    for (int x = -20; x <= 220; x += 17) {
+        for (int y = -30; y <= 120; y += 13) {
+            Geom::Point const pt(x, y);
+
+            // the nearest point of each curve in range, searched one curve at a time
+            std::map<std::pair<std::size_t, std::size_t>, Geom::Coord> expected;
+            for (std::size_t i = 0; i < pathv.size(); i++) {
+                for (std::size_t j = 0; j < pathv[i].size_default(); j++) {
+                    Geom::Curve const &curve = pathv[i][j];
+                    Geom::Coord const d = Geom::distance(curve.pointAt(curve.nearestTime(pt)), pt);
+                    if (d < max_dist) {
+                        expected[std::make_pair(i, j)] = d;
+                    }
+                }
+            }
+
+            std::vector<Geom::Coord> dists;
+            std::vector<Geom::PathVectorTime> times = pathv_nearest_times(pathv, pt, max_dist, 0, &dists);
+            ASSERT_EQ(times.size(), expected.size());
+            ASSERT_EQ(dists.size(), times.size());
+            for (std::size_t k = 0; k < times.size(); k++) {
+                auto e = expected.find(std::make_pair(times[k].path_index, times[k].curve_index));
+                ASSERT_NE(e, expected.end());
+                EXPECT_DOUBLE_EQ(dists[k], e->second);
+                EXPECT_DOUBLE_EQ(dists[k], Geom::distance(pathv.pointAt(times[k]), pt));
+                if (k > 0) {
+                    EXPECT_LE(dists[k - 1], dists[k]);
+                }
+            }
+
+            // the closest one is the nearest point of the whole path vector
+            Geom::Coord nearest_dist;
+            auto nearest = pathv.nearestTime(pt, &nearest_dist);
+            if (nearest && nearest_dist < max_dist) {
+                ASSERT_FALSE(times.empty());
+                EXPECT_NEAR(dists[0], nearest_dist, 1e-9);
+            }
+
+            // a limited count returns the first ones
+            std::vector<Geom::Coord> first_dists;
+            std::vector<Geom::PathVectorTime> first = pathv_nearest_times(pathv, pt, max_dist, 2, &first_dists);
+            ASSERT_EQ(first.size(), std::min<std::size_t>(2, times.size()));
+            for (std::size_t k = 0; k < first.size(); k++) {
+                EXPECT_EQ(first[k], times[k]);
+                EXPECT_EQ(first_dists[k], dists[k]);
+            }
+        }
+    }
+}
+
+TEST(HelperGeomTest, IntersectionsMatchPathVectorIntersect)
+{
+    Geom::PathVector const a = test_paths();
+    Geom::PathVector const b = test_paths() * Geom::Rotate(0.2) * Geom::Translate(7, 3);
+
+    std::vector<Geom::PVIntersection> expected = a.intersect(b);
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    ASSERT_FALSE(expected.empty());
+
+    std::vector<Geom::PVIntersection> const found = pathv_intersections(a, b);
+    ASSERT_EQ(found.size(), expected.size());
+    for (std::size_t k = 0; k < found.size(); k++) {
+        EXPECT_EQ(found[k].first, expected[k].first);
+        EXPECT_EQ(found[k].second, expected[k].second);
+        EXPECT_TRUE(Geom::are_near(found[k].point(), expected[k].point(), 1e-6));
+    }
+
+    // paths which do not meet
+    EXPECT_TRUE(pathv_intersections(a, a * Geom::Translate(1000, 0)).empty());
+    EXPECT_TRUE(pathv_intersections(a, Geom::PathVector()).empty());
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the memory of livarot shapes and paths.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "livarot/shape-arena.h"
+
+namespace {
+
+class ShapeArenaTest : public ::testing::Test {
+protected:
+    // the free lists belong to the thread; start from empty ones
+    void SetUp() override { ShapeArena::trim(); }
+    void TearDown() override { ShapeArena::trim(); }
+};
+
+} // namespace
+
+TEST_F(ShapeArenaTest, ReusesBlocksOfTheSameSizeClass)
+{
+    void *block = ShapeArena::allocate(100);
+    ASSERT_NE(block, nullptr);
+    // the whole size class can be used
+    std::memset(block, 0x55, 128);
+    ShapeArena::deallocate(block, 100);
+    EXPECT_EQ(ShapeArena::keptBytes(), 128u);
+
+    // another size class does not get the block
+    void *larger = ShapeArena::allocate(200);
+    EXPECT_NE(larger, block);
+    EXPECT_EQ(ShapeArena::keptBytes(), 128u);
+
+    void *again = ShapeArena::allocate(120);
+    EXPECT_EQ(again, block);
+    EXPECT_EQ(ShapeArena::keptBytes(), 0u);
+
+    ShapeArena::deallocate(again, 120);
+    ShapeArena::deallocate(larger, 200);
+    EXPECT_EQ(ShapeArena::keptBytes(), 128u + 256u);
+
+    // small sizes share the smallest class
+    void *small = ShapeArena::allocate(1);
+    void *small2 = ShapeArena::allocate(64);
+    EXPECT_NE(small, small2);
+    ShapeArena::deallocate(small, 1);
+    ShapeArena::deallocate(small2, 64);
+    EXPECT_EQ(ShapeArena::keptBytes(), 128u + 256u + 2 * 64u);
+
+    ShapeArena::trim();
+    EXPECT_EQ(ShapeArena::keptBytes(), 0u);
+}
+
+TEST_F(ShapeArenaTest, KeepsALimitedNumberOfBlocksPerClass)
+{
+    std::vector<void *> blocks;
+    for (int i = 0; i < 40; i++) {
+        blocks.push_back(ShapeArena::allocate(1000));
+    }
+    for (auto block : blocks) {
+        ShapeArena::deallocate(block, 1000);
+    }
+    size_t const kept = ShapeArena::keptBytes();
+    EXPECT_GT(kept, 0u);
+    EXPECT_LT(kept, 40 * 1024u);
+    EXPECT_EQ(kept % 1024, 0u);
+
+    // the kept blocks are handed out again, each one once
+    std::set<void *> const allocated(blocks.begin(), blocks.end());
+    std::set<void *> reused;
+    for (size_t i = 0; i < kept / 1024; i++) {
+        void *block = ShapeArena::allocate(1000);
+        EXPECT_EQ(allocated.count(block), 1u);
+        EXPECT_TRUE(reused.insert(block).second);
+    }
+    EXPECT_EQ(ShapeArena::keptBytes(), 0u);
+    for (auto block : reused) {
+        ShapeArena::deallocate(block, 1000);
+    }
+}
+
+TEST_F(ShapeArenaTest, LargeBlocksAreNotKept)
+{
+    size_t const size = 64 << 20;
+    void *block = ShapeArena::allocate(size);
+    ASSERT_NE(block, nullptr);
+    ShapeArena::deallocate(block, size);
+    EXPECT_EQ(ShapeArena::keptBytes(), 0u);
+}
+
+TEST_F(ShapeArenaTest, ReallocateKeepsTheContents)
+{
+    int *data = static_cast<int *>(ShapeArena::allocate(10 * sizeof(int)));
+    for (int i = 0; i < 10; i++) {
+        data[i] = i;
+    }
+
+    // growing within the size class keeps the block
+    int *same = static_cast<int *>(ShapeArena::reallocate(data, 10 * sizeof(int), 16 * sizeof(int)));
+    EXPECT_EQ(same, data);
+
+    int *grown = static_cast<int *>(ShapeArena::reallocate(same, 16 * sizeof(int), 100 * sizeof(int)));
+    ASSERT_NE(grown, nullptr);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_EQ(grown[i], i);
+    }
+    // the old block went back to its free list
+    EXPECT_EQ(ShapeArena::keptBytes(), 64u);
+
+    int *shrunk = static_cast<int *>(ShapeArena::reallocate(grown, 100 * sizeof(int), 5 * sizeof(int)));
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(shrunk[i], i);
+    }
+    ShapeArena::deallocate(shrunk, 5 * sizeof(int));
+
+    // standard containers use the same blocks
+    ShapeArena::Vector<int> v(16, 7);
+    EXPECT_EQ(v.data(), shrunk);
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
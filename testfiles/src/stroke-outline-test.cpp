@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the outlines of strokes.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include "gtest/gtest.h"
+
+#include <2geom/pathvector.h>
+
+#include "splivarot.h"
+
+namespace {
+
+/// Square around the origin, turning one way or the other.
+Geom::Path square(double r, bool reversed)
+{
+    Geom::Path path(Geom::Point(-r, -r));
+    path.appendNew<Geom::LineSegment>(Geom::Point(r, -r));
+    path.appendNew<Geom::LineSegment>(Geom::Point(r, r));
+    path.appendNew<Geom::LineSegment>(Geom::Point(-r, r));
+    path.close();
+    return reversed ? path.reversed() : path;
+}
+
+/// Circle around the origin, made of cubic Beziers.
+Geom::Path circle(double r, bool reversed)
+{
+    double const k = 0.5523 * r;
+    Geom::Path path(Geom::Point(r, 0));
+    path.appendNew<Geom::CubicBezier>(Geom::Point(r, k), Geom::Point(k, r), Geom::Point(0, r));
+    path.appendNew<Geom::CubicBezier>(Geom::Point(-k, r), Geom::Point(-r, k), Geom::Point(-r, 0));
+    path.appendNew<Geom::CubicBezier>(Geom::Point(-r, -k), Geom::Point(-k, -r), Geom::Point(0, -r));
+    path.appendNew<Geom::CubicBezier>(Geom::Point(k, -r), Geom::Point(r, -k), Geom::Point(r, 0));
+    path.close();
+    return reversed ? path.reversed() : path;
+}
+
+bool covers(Geom::PathVector const &pathv, Geom::Point const &pt)
+{
+    int winding = 0;
+    for (auto const &path : pathv) {
+        winding += path.winding(pt);
+    }
+    return winding != 0;
+}
+
+void check_overlapping_strokes(Geom::Path const &outer, Geom::Path const &inner)
+{
+    // strokes 15 wide around contours 10 apart overlap between 42.5 and 47.5
+    Geom::PathVector centerline;
+    centerline.push_back(outer);
+    centerline.push_back(inner);
+    Geom::PathVector const outline =
+        sp_pathvector_stroke_outline(centerline, 15, 4, Inkscape::JOIN_MITER, Inkscape::BUTT_FLAT);
+
+    for (double x : {33.0, 40.0, 45.0, 50.0, 57.0}) {
+        EXPECT_TRUE(covers(outline, Geom::Point(x, 0))) << "at " << x;
+        EXPECT_TRUE(covers(outline, Geom::Point(0, -x))) << "at " << -x;
+    }
+    EXPECT_FALSE(covers(outline, Geom::Point(0, 0)));
+    EXPECT_FALSE(covers(outline, Geom::Point(25, 0)));
+    EXPECT_FALSE(covers(outline, Geom::Point(60, 0)));
+}
+
+} // namespace
+
+TEST(StrokeOutlineTest, OverlappingContoursInOppositeDirections)
+{
+    check_overlapping_strokes(square(50, false), square(40, true));
+    check_overlapping_strokes(square(50, true), square(40, false));
+    check_overlapping_strokes(circle(50, false), circle(40, true));
+    check_overlapping_strokes(circle(50, true), circle(40, false));
+}
+
+TEST(StrokeOutlineTest, OverlappingContoursInTheSameDirection)
+{
+    check_overlapping_strokes(square(50, false), square(40, false));
+    check_overlapping_strokes(circle(50, true), circle(40, true));
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
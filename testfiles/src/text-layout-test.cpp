@@ -0,0 +1,118 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the relayout of edited texts.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <doc-per-case-test.h>
+
+#include "object/sp-text.h"
+#include "xml/node.h"
+
+namespace {
+
+class TextLayoutTest : public DocPerCaseTest {
+protected:
+    /// Document with a text made of one line per paragraph.
+    static SPDocument *createDocument(std::vector<std::string> const &paragraphs)
+    {
+        std::string svg = "<svg xmlns='http://www.w3.org/2000/svg'"
+                          " xmlns:sodipodi='http://sodipodi.sourceforge.net/DTD/sodipodi-0.dtd'>"
+                          "<text id='text' x='10' y='20' style='font-family:sans-serif;font-size:12px;line-height:1.25'>";
+        for (unsigned i = 0; i < paragraphs.size(); i++) {
+            svg += "<tspan id='line" + std::to_string(i) + "' sodipodi:role='line' x='10'>" + paragraphs[i] + "</tspan>";
+        }
+        svg += "</text></svg>";
+        return SPDocument::createNewDocFromMem(svg.c_str(), static_cast<int>(svg.size()), false);
+    }
+
+    /// Anchor points of all the characters of the text in @a doc.
+    static std::vector<Geom::Point> characterPositions(SPDocument *doc)
+    {
+        std::vector<Geom::Point> positions;
+        auto text = dynamic_cast<SPText *>(doc->getObjectById("text"));
+        if (text) {
+            Inkscape::Text::Layout const &layout = text->layout;
+            for (auto it = layout.begin(); it != layout.end(); it.nextCharacter()) {
+                positions.push_back(layout.characterAnchorPoint(it));
+            }
+        }
+        return positions;
+    }
+};
+
+} // namespace
+
+TEST_F(TextLayoutTest, EditedParagraphMatchesColdLayout)
+{
+    std::vector<std::string> paragraphs = {
+        "The first paragraph stays as it is.",
+        "The second one is edited.",
+        "The third one stays too, with some more words.",
+    };
+
+    SPDocument *doc = createDocument(paragraphs);
+    ASSERT_NE(doc, nullptr);
+    doc->ensureUpToDate();
+    auto text = dynamic_cast<SPText *>(doc->getObjectById("text"));
+    ASSERT_NE(text, nullptr);
+    std::vector<Geom::Point> const before = characterPositions(doc);
+    ASSERT_FALSE(before.empty());
+
+    // the other paragraphs reuse their shaping, and the first one its lines, from the previous layout
+    paragraphs[1] = "The second one is edited, and much longer now: WAVE AVAVA fi fl.";
+    SPObject *line = doc->getObjectById("line1");
+    ASSERT_NE(line, nullptr);
+    ASSERT_NE(line->getRepr()->firstChild(), nullptr);
+    line->getRepr()->firstChild()->setContent(paragraphs[1].c_str());
+    text->rebuildLayout();
+    Inkscape::Text::Layout::CalculationStats stats = text->layout.lastCalculationStats();
+    EXPECT_EQ(stats.itemized_paragraphs, 1u);
+    EXPECT_GT(stats.shaped_spans, 0u);
+    // the lines of the first paragraph are kept
+    EXPECT_EQ(stats.broken_paragraphs, 2u);
+
+    doc->ensureUpToDate();
+    text->rebuildLayout();
+    std::vector<Geom::Point> const edited = characterPositions(doc);
+
+    // nothing changed, only the last paragraph is broken into lines again
+    stats = text->layout.lastCalculationStats();
+    EXPECT_EQ(stats.itemized_paragraphs, 0u);
+    EXPECT_EQ(stats.shaped_spans, 0u);
+    EXPECT_EQ(stats.broken_paragraphs, 1u);
+
+    SPDocument *cold_doc = createDocument(paragraphs);
+    ASSERT_NE(cold_doc, nullptr);
+    cold_doc->ensureUpToDate();
+    std::vector<Geom::Point> const cold = characterPositions(cold_doc);
+
+    EXPECT_GT(edited.size(), before.size());
+    ASSERT_EQ(edited.size(), cold.size());
+    for (unsigned i = 0; i < cold.size(); i++) {
+        EXPECT_NEAR(edited[i][Geom::X], cold[i][Geom::X], 1e-6) << "character " << i;
+        EXPECT_NEAR(edited[i][Geom::Y], cold[i][Geom::Y], 1e-6) << "character " << i;
+    }
+
+    cold_doc->doUnref();
+    doc->doUnref();
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: GPL-2.0-or-later
+/** @file
+ * Unit tests for the attributes of XML nodes.
+ *//*
+ * Authors: see git history
+ *
+ * Copyright (C) 2020 Authors
+ * Released under GNU GPL v2+, read the file 'COPYING' for more information.
+ */
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "xml/repr.h"
+
+using Inkscape::Util::List;
+using Inkscape::XML::AttributeRecord;
+
+namespace {
+
+class XmlNodeTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        doc = sp_repr_document_new("svg:svg");
+        node = doc->createElement("svg:g");
+    }
+
+    void TearDown() override
+    {
+        Inkscape::GC::release(node);
+        Inkscape::GC::release(doc);
+    }
+
+    std::vector<std::string> keys(Inkscape::XML::Node const *n) const
+    {
+        std::vector<std::string> result;
+        for (auto const &attr : n->attributes()) {
+            result.emplace_back(g_quark_to_string(attr.key));
+        }
+        return result;
+    }
+
+    /// Set attributes a0, a1, ... with the values v0, v1, ...
+    void fill(unsigned count)
+    {
+        for (unsigned i = 0; i < count; i++) {
+            node->setAttribute(("a" + std::to_string(i)).c_str(), ("v" + std::to_string(i)).c_str());
+        }
+    }
+
+    Inkscape::XML::Document *doc;
+    Inkscape::XML::Node *node;
+};
+
+} // namespace
+
+TEST_F(XmlNodeTest, FewAttributes)
+{
+    fill(3);
+    EXPECT_STREQ(node->attribute("a1"), "v1");
+    EXPECT_EQ(node->attribute("b"), nullptr);
+
+    node->setAttribute("a1", "changed");
+    EXPECT_STREQ(node->attribute("a1"), "changed");
+    EXPECT_EQ(keys(node), std::vector<std::string>({"a0", "a1", "a2"}));
+
+    node->setAttribute("a0", nullptr);
+    EXPECT_EQ(node->attribute("a0"), nullptr);
+    EXPECT_EQ(keys(node), std::vector<std::string>({"a1", "a2"}));
+}
+
+TEST_F(XmlNodeTest, ManyAttributes)
+{
+    unsigned const count = 40;
+    fill(count);
+    for (unsigned i = 0; i < count; i++) {
+        EXPECT_STREQ(node->attribute(("a" + std::to_string(i)).c_str()), ("v" + std::to_string(i)).c_str());
+    }
+
+    // removing attributes keeps the others in order and findable
+    for (unsigned i = 0; i < count; i += 2) {
+        node->setAttribute(("a" + std::to_string(i)).c_str(), nullptr);
+    }
+    std::vector<std::string> expected;
+    for (unsigned i = 1; i < count; i += 2) {
+        expected.push_back("a" + std::to_string(i));
+        EXPECT_STREQ(node->attribute(expected.back().c_str()), ("v" + std::to_string(i)).c_str());
+        EXPECT_EQ(node->attribute(("a" + std::to_string(i - 1)).c_str()), nullptr);
+    }
+    EXPECT_EQ(keys(node), expected);
+
+    // down to few attributes again
+    for (unsigned i = 1; i < count - 2; i += 2) {
+        node->setAttribute(("a" + std::to_string(i)).c_str(), nullptr);
+    }
+    EXPECT_EQ(keys(node), std::vector<std::string>({"a" + std::to_string(count - 1)}));
+    EXPECT_STREQ(node->attribute(("a" + std::to_string(count - 1)).c_str()), ("v" + std::to_string(count - 1)).c_str());
+}
+
+TEST_F(XmlNodeTest, HasAttributes)
+{
+    EXPECT_FALSE(node->hasAttributes());
+    fill(2);
+    EXPECT_TRUE(node->hasAttributes());
+    node->setAttribute("a0", nullptr);
+    EXPECT_TRUE(node->hasAttributes());
+    node->setAttribute("a1", nullptr);
+    EXPECT_FALSE(node->hasAttributes());
+}
+
+TEST_F(XmlNodeTest, DuplicateKeepsOrder)
+{
+    fill(20);
+    Inkscape::XML::Node *copy = node->duplicate(doc);
+    EXPECT_EQ(keys(copy), keys(node));
+    EXPECT_STREQ(copy->attribute("a19"), "v19");
+    EXPECT_TRUE(copy->equal(node, false));
+
+    // the copy has its own attributes
+    copy->setAttribute("a5", nullptr);
+    EXPECT_STREQ(node->attribute("a5"), "v5");
+    EXPECT_STREQ(copy->attribute("a6"), "v6");
+    Inkscape::GC::release(copy);
+}
+
+TEST_F(XmlNodeTest, AttributeListMatchesAttributes)
+{
+    EXPECT_TRUE(node->attributes().empty());
+    EXPECT_FALSE(node->attributeList());
+
+    fill(20);
+    node->setAttribute("a3", nullptr);
+    Inkscape::XML::AttributeRange const attributes = node->attributes();
+    EXPECT_EQ(attributes.size(), 19u);
+
+    auto attr = attributes.begin();
+    for (List<AttributeRecord const> iter = node->attributeList(); iter; ++iter, ++attr) {
+        ASSERT_NE(attr, attributes.end());
+        EXPECT_EQ(iter->key, attr->key);
+        EXPECT_EQ(iter->value, attr->value);
+    }
+    EXPECT_EQ(attr, attributes.end());
+}
+
+/*
+  Local Variables:
+  mode:c++
+  c-file-style:"stroustrup"
+  c-file-offsets:((innamespace . 0)(inline-open . 0)(case-label . +))
+  indent-tabs-mode:nil
+  fill-column:99
+  End:
+*/
+// vim: filetype=cpp:expandtab:shiftwidth=4:tabstop=8:softtabstop=4:fileencoding=utf-8:textwidth=99 :